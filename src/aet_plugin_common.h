@@ -299,6 +299,27 @@ namespace AetPlugin::StreamUtil
 		return (streamType == AEGP_LayerStream_SCALE || streamType == AEGP_LayerStream_OPACITY) ? 100.0f : 1.0f;
 	}
 
+	// NOTE: Maximum absolute error in Aet units (pixels, degrees and factors) allowed when removing redundant key frames, well below what is visible on screen
+	constexpr f32 GetAetKeyFrameReductionTolerance(AEGP_LayerStream streamType)
+	{
+		switch (streamType)
+		{
+		case AEGP_LayerStream_ANCHORPOINT:
+		case AEGP_LayerStream_POSITION:
+		case AEGP_LayerStream_ROTATE_X:
+		case AEGP_LayerStream_ROTATE_Y:
+		case AEGP_LayerStream_ROTATE_Z:
+		case AEGP_LayerStream_ORIENTATION:
+			return 0.01f;
+		case AEGP_LayerStream_SCALE:
+			return 0.0001f;
+		case AEGP_LayerStream_OPACITY:
+			return 0.001f;
+		default:
+			return 0.0f;
+		}
+	}
+
 	struct CombinedAetLayerVideo2D3D
 	{
 		CombinedAetLayerVideo2D3D(Aet::LayerVideo& layerVideo)
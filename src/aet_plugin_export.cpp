@@ -1,6 +1,7 @@
 #include "aet_plugin_export.h"
 #include "core_io.h"
 #include "comfy/texture_util.h"
+#include "comfy/aet_fcurve_util.h"
 #include <future>
 
 #define LogLine(format, ...)		do { if (logLevel != LogLevelFlags_None)	{ fprintf(logStream, "%s(): "			format "\n", __FUNCTION__, __VA_ARGS__); } } while (false)
@@ -47,7 +48,7 @@ namespace AetPlugin
 
 	static ivec2 GetAetSetResolution(const Aet::AetSet& set)
 	{
-		return !set.Scenes.empty() ? set.Scenes.front()->Resolution : ivec2(0, 0);
+		return (set.GetSceneCount() > 0) ? set.GetScene(0).Resolution : ivec2(0, 0);
 	}
 
 	void AetExporter::SetLog(FILE* log, LogLevelFlags level)
@@ -69,11 +70,12 @@ namespace AetPlugin
 		return setName;
 	}
 
-	std::pair<std::unique_ptr<Aet::AetSet>, std::unique_ptr<SprSetSrcInfo>> AetExporter::ExportAetSet(std::string_view workingDirectory, b8 parseSprIDComments)
+	std::pair<std::unique_ptr<Aet::AetSet>, std::unique_ptr<SprSetSrcInfo>> AetExporter::ExportAetSet(std::string_view workingDirectory, b8 parseSprIDComments, b8 reduceKeyFrames)
 	{
 		LogLine("--- Log Start ---");
 
 		settings.ParseSprIDComments = parseSprIDComments;
+		settings.ReduceKeyFrames = reduceKeyFrames;
 
 		this->workingDirectory.ImportDirectory = workingDirectory;
 		LogInfoLine("Working Directory: '%s'", this->workingDirectory.ImportDirectory.c_str());
@@ -178,19 +180,16 @@ namespace AetPlugin
 		if (workingSet.IDOverride.SprSetID != SprSetID::Invalid)
 			setEntry.SprSetID = workingSet.IDOverride.SprSetID;
 
-		setEntry.SceneEntries.reserve(set.Scenes.size());
-		i16 sceneIndex = 0;
-		for (const auto& scene : set.Scenes)
+		setEntry.SceneEntries.reserve(set.GetSceneCount());
+		for (i16 sceneIndex = 0; sceneIndex < static_cast<i16>(set.GetSceneCount()); sceneIndex++)
 		{
 			auto& sceneEntry = setEntry.SceneEntries.emplace_back();
-			sceneEntry.Name = setEntry.Name + "_" + ASCII::ToUpperCopy(scene->Name);
+			sceneEntry.Name = setEntry.Name + "_" + ASCII::ToUpperCopy(set.GetScene(sceneIndex).Name);
 			sceneEntry.ID = MurmurHashID<AetSceneID>(sceneEntry.Name);
 			sceneEntry.Index = sceneIndex;
 
 			if (sceneIndex < workingSet.IDOverride.SceneIDs.size() && workingSet.IDOverride.SceneIDs[sceneIndex] != AetSceneID::Invalid)
 				sceneEntry.ID = workingSet.IDOverride.SceneIDs[sceneIndex];
-
-			sceneIndex++;
 		}
 
 		return aetDB;
@@ -214,10 +213,11 @@ namespace AetPlugin
 		const auto sprPrefix = ASCII::ToUpperCopy(std::string(ASCII::TrimPrefixInsensitive(set.Name, AetPrefix))) + "_";
 
 		i16 sprIndex = 0;
-		for (const auto& scene : set.Scenes)
+		for (size_t i = 0; i < set.GetSceneCount(); i++)
 		{
-			setEntry.SprEntries.reserve(setEntry.SprEntries.size() + scene->Videos.size());
-			for (const auto& video : scene->Videos)
+			const auto& scene = set.GetScene(i);
+			setEntry.SprEntries.reserve(setEntry.SprEntries.size() + scene.Videos.size());
+			for (const auto& video : scene.Videos)
 			{
 				for (const auto& source : video->Sources)
 				{
@@ -426,8 +426,9 @@ namespace AetPlugin
 
 	void AetExporter::SetupWorkingSceneData(AEItemData* sceneComp)
 	{
-		workingScene.Scene = workingSet.Set->Scenes.emplace_back(std::make_shared<Aet::Scene>()).get();
+		workingScene.Scene = &workingSet.Set->AddScene(std::make_shared<Aet::Scene>());
 		workingScene.AESceneComp = sceneComp;
+		workingScene.FCurveFitJobs.clear();
 	}
 
 	void AetExporter::ExportScene()
@@ -460,6 +461,10 @@ namespace AetPlugin
 		scene.Audios;
 
 		ExportAllCompositions();
+
+		Aet::FitFCurvesToSamples(workingScene.FCurveFitJobs);
+		workingScene.FCurveFitJobs.clear();
+
 		FixInvalidSceneData();
 	}
 
@@ -668,11 +673,50 @@ namespace AetPlugin
 
 	void AetExporter::ExportLayerVideoStream(Aet::Layer& layer, Aet::LayerVideo& layerVideo, AetExDataTag& layerExtraData)
 	{
+		auto exportSampledStream = [&](AEGP_LayerStream streamType, Aet::FCurve* curveX, Aet::FCurve* curveY, Aet::FCurve* curveZ)
+		{
+			const auto& aeSamples = GetAEStreamSamples(layer, layerExtraData, streamType);
+
+			auto exportCurve = [&](Aet::FCurve* curve, size_t component)
+			{
+				if (curve == nullptr)
+					return;
+
+				if (!settings.ReduceKeyFrames)
+				{
+					for (const auto& aeSample : aeSamples)
+						curve->Keys.emplace_back(aeSample.Time, aeSample.Value[component]);
+					TrySetLinearFCurveTangents(*curve);
+					return;
+				}
+
+				auto& fitJob = workingScene.FCurveFitJobs.emplace_back();
+				fitJob.Samples.reserve(aeSamples.size());
+				for (const auto& aeSample : aeSamples)
+					fitJob.Samples.push_back(aeSample.Value[component]);
+				fitJob.StartFrame = aeSamples.front().Time;
+				fitJob.Step = 1.0f;
+				fitJob.MaxError = StreamUtil::GetAetKeyFrameReductionTolerance(streamType);
+				fitJob.OutFCurve = curve;
+			};
+
+			exportCurve(curveX, 0);
+			exportCurve(curveY, 1);
+			exportCurve(curveZ, 2);
+		};
+
 		auto exportStream = [&](AEGP_LayerStream streamType, Aet::FCurve* curveX, Aet::FCurve* curveY, Aet::FCurve* curveZ)
 		{
 			if (curveX == nullptr && curveY == nullptr && curveZ == nullptr)
 				return;
 
+			// NOTE: Expressions aren't stored as key frames so their result has to be sampled instead
+			if (IsAEStreamExpressionDriven(layerExtraData, streamType))
+			{
+				exportSampledStream(streamType, curveX, curveY, curveZ);
+				return;
+			}
+
 			const auto& aeKeyFrames = GetAEKeyFrames(layer, layerExtraData, streamType);
 
 			if (curveX != nullptr)
@@ -680,6 +724,7 @@ namespace AetPlugin
 				for (const auto& aeKeyFrame : aeKeyFrames)
 					curveX->Keys.emplace_back(aeKeyFrame.Time, aeKeyFrame.Value.x);
 				TrySetLinearFCurveTangents(*curveX);
+				TryReduceFCurveKeyFrames(*curveX, streamType);
 			}
 
 			if (curveY != nullptr)
@@ -687,6 +732,7 @@ namespace AetPlugin
 				for (const auto& aeKeyFrame : aeKeyFrames)
 					curveY->Keys.emplace_back(aeKeyFrame.Time, aeKeyFrame.Value.y);
 				TrySetLinearFCurveTangents(*curveY);
+				TryReduceFCurveKeyFrames(*curveY, streamType);
 			}
 
 			if (curveZ != nullptr)
@@ -694,6 +740,7 @@ namespace AetPlugin
 				for (const auto& aeKeyFrame : aeKeyFrames)
 					curveZ->Keys.emplace_back(aeKeyFrame.Time, aeKeyFrame.Value.z);
 				TrySetLinearFCurveTangents(*curveZ);
+				TryReduceFCurveKeyFrames(*curveZ, streamType);
 			}
 		};
 
@@ -739,6 +786,14 @@ namespace AetPlugin
 		}
 	}
 
+	void AetExporter::TryReduceFCurveKeyFrames(Aet::FCurve& fcurve, AEGP_LayerStream streamType)
+	{
+		if (!settings.ReduceKeyFrames)
+			return;
+
+		Aet::ReduceFCurveKeyFrames(fcurve, StreamUtil::GetAetKeyFrameReductionTolerance(streamType));
+	}
+
 	const std::vector<AetExporter::AEKeyFrame>& AetExporter::GetAEKeyFrames(const Aet::Layer& layer, const AetExDataTag& layerExtraData, AEGP_LayerStream streamType)
 	{
 		const f32 scaleFactor = 1.0f / StreamUtil::GetAetToAEStreamFactor(streamType);
@@ -789,6 +844,44 @@ namespace AetPlugin
 		return aeKeyFramesCache;
 	}
 
+	b8 AetExporter::IsAEStreamExpressionDriven(const AetExDataTag& layerExtraData, AEGP_LayerStream streamType)
+	{
+		AEGP_StreamRefH streamRef;
+		suites.StreamSuite4->AEGP_GetNewLayerStream(Global.PluginID, layerExtraData.AE_Layer, streamType, &streamRef);
+
+		A_Boolean expressionEnabled = false;
+		suites.StreamSuite4->AEGP_GetExpressionState(Global.PluginID, streamRef, &expressionEnabled);
+		suites.StreamSuite4->AEGP_DisposeStream(streamRef);
+
+		return expressionEnabled;
+	}
+
+	const std::vector<AetExporter::AEKeyFrame>& AetExporter::GetAEStreamSamples(const Aet::Layer& layer, const AetExDataTag& layerExtraData, AEGP_LayerStream streamType)
+	{
+		const f32 scaleFactor = 1.0f / StreamUtil::GetAetToAEStreamFactor(streamType);
+		aeKeyFramesCache.clear();
+
+		// NOTE: One sample per parent composition frame covering the entire layer duration, each taken at the layer time that parent frame maps to
+		const i32 frameCount = static_cast<i32>(Ceil(layer.EndFrame - layer.StartFrame)) + 1;
+		for (i32 i = 0; i < Max(frameCount, 1); i++)
+		{
+			const frame_t parentFrame = layer.StartFrame + static_cast<frame_t>(i);
+			const auto layerTime = AEUtil::FrameToAETime(layer.StartOffset + (parentFrame - layer.StartFrame) * layer.TimeScale, workingScene.Scene->FrameRate);
+
+			AEGP_StreamVal2 streamVal2;
+			AEGP_StreamType outStreamType;
+			suites.StreamSuite4->AEGP_GetLayerStreamValue(layerExtraData.AE_Layer, streamType, AEGP_LTimeMode_LayerTime, &layerTime, false, &streamVal2, &outStreamType);
+
+			// HACK: Same as for the static value in GetAEKeyFrames()
+			if (streamType == AEGP_LayerStream_SCALE)
+				streamVal2.three_d.z = 100.0f;
+
+			const vec3 value = vec3(static_cast<f32>(streamVal2.three_d.x), static_cast<f32>(streamVal2.three_d.y), static_cast<f32>(streamVal2.three_d.z)) * scaleFactor;
+			aeKeyFramesCache.push_back({ parentFrame, value });
+		}
+		return aeKeyFramesCache;
+	}
+
 	void AetExporter::ExportLayerAudio(Aet::Layer& layer, AetExDataTag& layerExtraData)
 	{
 		layer.LayerAudio = std::make_shared<Aet::LayerAudio>();
@@ -6,6 +6,7 @@
 #include "comfy/file_format_aet_set.h"
 #include "comfy/file_format_spr_set.h"
 #include "comfy/file_format_farc.h"
+#include "comfy/aet_fcurve_util.h"
 #include <unordered_map>
 #include <unordered_set>
 
@@ -29,7 +30,7 @@ namespace AetPlugin
 		void SetLog(FILE* log, LogLevelFlags level);
 
 		std::string GetAetSetNameFromProjectName() const;
-		std::pair<std::unique_ptr<Aet::AetSet>, std::unique_ptr<SprSetSrcInfo>> ExportAetSet(std::string_view workingDirectory, b8 parseSprIDComments);
+		std::pair<std::unique_ptr<Aet::AetSet>, std::unique_ptr<SprSetSrcInfo>> ExportAetSet(std::string_view workingDirectory, b8 parseSprIDComments, b8 reduceKeyFrames);
 
 		struct SprSetExportOptions { b8 PowerOfTwo, EnableCompression, EncodeYCbCr; };
 		std::unique_ptr<SprSet> CreateSprSetFromSprSetSrcInfo(const SprSetSrcInfo& sprSetSrcInfo, const Aet::AetSet& aetSet, const SprSetExportOptions& options);
@@ -65,8 +66,11 @@ namespace AetPlugin
 		void ExportLayerTransferMode(Aet::Layer& layer, Aet::LayerTransferMode& transferMode, AetExDataTag& layerExtraData);
 		void ExportLayerVideoStream(Aet::Layer& layer, Aet::LayerVideo& layerVideo, AetExDataTag& layerExtraData);
 		void TrySetLinearFCurveTangents(Aet::FCurve& property);
+		void TryReduceFCurveKeyFrames(Aet::FCurve& property, AEGP_LayerStream streamType);
 
 		const std::vector<AEKeyFrame>& GetAEKeyFrames(const Aet::Layer& layer, const AetExDataTag& layerExtraData, AEGP_LayerStream streamType);
+		b8 IsAEStreamExpressionDriven(const AetExDataTag& layerExtraData, AEGP_LayerStream streamType);
+		const std::vector<AEKeyFrame>& GetAEStreamSamples(const Aet::Layer& layer, const AetExDataTag& layerExtraData, AEGP_LayerStream streamType);
 
 		void ExportLayerAudio(Aet::Layer& layer, AetExDataTag& layerExtraData);
 
@@ -101,6 +105,7 @@ namespace AetPlugin
 		struct SettingsData
 		{
 			b8 ParseSprIDComments;
+			b8 ReduceKeyFrames;
 		} settings = {};
 
 		struct AEItemData
@@ -167,6 +172,8 @@ namespace AetPlugin
 		{
 			Aet::Scene* Scene;
 			AEItemData* AESceneComp;
+			// NOTE: Sampled curves of all layers are only fitted once the entire scene has been exported, so that they can all be processed in a single parallel pass
+			std::vector<Aet::FCurveFitJob> FCurveFitJobs;
 		} workingScene = {};
 
 		struct AEKeyFrame { frame_t Time; vec3 Value; };
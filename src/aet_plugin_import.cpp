@@ -285,10 +285,9 @@ namespace AetPlugin
 		GetProjectHandles();
 		CreateProjectFolders();
 
-		size_t sceneIndex = 0;
-		for (const auto& scene : workingSet.Set->Scenes)
+		for (size_t sceneIndex = 0; sceneIndex < workingSet.Set->GetSceneCount(); sceneIndex++)
 		{
-			SetupWorkingSceneData(*scene, sceneIndex++);
+			SetupWorkingSceneData(workingSet.Set->GetScene(sceneIndex), sceneIndex);
 			CreateSceneFolders();
 
 			ImportAllFootage();
@@ -1000,6 +999,7 @@ namespace AetPlugin
 	static const KeyFrameType* FindKeyFrameAt(frame_t frame, const Aet::FCurve* fcurve) { return (fcurve != nullptr) ? FindKeyFrameAt(frame, fcurve->Keys) : nullptr; }
 
 	static f32 TrySampleFCurveAt(const Aet::FCurve* fcurve, frame_t frame) { return (fcurve != nullptr) ? fcurve->SampleAt(frame) : 0.0f; }
+	static f32 TrySampleFCurveAt(const Aet::FCurve* fcurve, frame_t frame, Aet::FCurveCursor& cursor) { return (fcurve != nullptr) ? fcurve->SampleAt(frame, cursor) : 0.0f; }
 
 	void AetImporter::ImportLayerVideoStream(const Aet::Layer& layer, const Aet::LayerVideo& layerVideo)
 	{
@@ -1050,6 +1050,8 @@ namespace AetPlugin
 			return;
 		}
 
+		// NOTE: The keys of each curve are sorted by frame so the other curves are always sampled in increasing order
+		Aet::FCurveCursor cursorX, cursorY, cursorZ;
 		for (const auto& xKeyFrame : curveX->Keys)
 		{
 			const auto matchingYKeyFrame = FindKeyFrameAt<Aet::KeyFrame>(xKeyFrame.Frame, curveY);
@@ -1057,34 +1059,36 @@ namespace AetPlugin
 			const vec3 value =
 			{
 				xKeyFrame.Value,
-				(matchingYKeyFrame != nullptr) ? matchingYKeyFrame->Value : TrySampleFCurveAt(curveY, xKeyFrame.Frame),
-				(matchingZKeyFrame != nullptr) ? matchingZKeyFrame->Value : TrySampleFCurveAt(curveZ, xKeyFrame.Frame),
+				(matchingYKeyFrame != nullptr) ? matchingYKeyFrame->Value : TrySampleFCurveAt(curveY, xKeyFrame.Frame, cursorY),
+				(matchingZKeyFrame != nullptr) ? matchingZKeyFrame->Value : TrySampleFCurveAt(curveZ, xKeyFrame.Frame, cursorZ),
 			};
 			outCombined.push_back({ xKeyFrame.Frame, value, xKeyFrame.Tangent });
 		}
 
 		if (curveY != nullptr)
 		{
+			cursorX = cursorZ = {};
 			for (const auto& yKeyFrame : curveY->Keys)
 			{
 				if (auto existingKeyFrame = FindKeyFrameAt<KeyFrameVec3>(yKeyFrame.Frame, outCombined); existingKeyFrame != nullptr)
 					continue;
 
-				const f32 xValue = TrySampleFCurveAt(curveX, yKeyFrame.Frame);
-				const f32 zValue = TrySampleFCurveAt(curveZ, yKeyFrame.Frame);
+				const f32 xValue = TrySampleFCurveAt(curveX, yKeyFrame.Frame, cursorX);
+				const f32 zValue = TrySampleFCurveAt(curveZ, yKeyFrame.Frame, cursorZ);
 				outCombined.push_back({ yKeyFrame.Frame, vec3(xValue, yKeyFrame.Value, zValue), yKeyFrame.Tangent });
 			}
 		}
 
 		if (curveZ != nullptr)
 		{
+			cursorX = cursorY = {};
 			for (const auto& zKeyFrame : curveZ->Keys)
 			{
 				if (auto existingKeyFrame = FindKeyFrameAt<KeyFrameVec3>(zKeyFrame.Frame, outCombined); existingKeyFrame != nullptr)
 					continue;
 
-				const f32 xValue = TrySampleFCurveAt(curveX, zKeyFrame.Frame);
-				const f32 yValue = TrySampleFCurveAt(curveY, zKeyFrame.Frame);
+				const f32 xValue = TrySampleFCurveAt(curveX, zKeyFrame.Frame, cursorX);
+				const f32 yValue = TrySampleFCurveAt(curveY, zKeyFrame.Frame, cursorY);
 				outCombined.push_back({ zKeyFrame.Frame, vec3(xValue, yValue, zKeyFrame.Value), zKeyFrame.Tangent });
 			}
 		}
@@ -36,7 +36,7 @@ namespace AetPlugin
 		const auto aetSetPathOrFArc = UTF8::Narrow(AEUtil::WCast(filePath));
 		const auto[aetSet, aetDB] = AetImporter::TryLoadAetSetAndDB(aetSetPathOrFArc);
 
-		if (aetSet == nullptr || aetSet->Scenes.empty())
+		if (aetSet == nullptr || aetSet->GetSceneCount() == 0)
 			return A_Err_GENERIC;
 
 		const auto[sprSet, sprDB] = AetImporter::TryLoadSprSetAndDB(aetSetPathOrFArc);
@@ -125,8 +125,15 @@ namespace AetPlugin
 		b8 Sprite_CompressTextures = true;
 		b8 Sprite_EncodeYCbCr = true;
 		b8 SpriteFArc_Compress = true;
+		b8 Animation_ReduceKeyFrames = true;
+		b8 Format_Sections = false;
+		b8 Format_AetSet64Bit = false;
 		b8 Debug_WriteLog = false;
 		b8 Misc_ExportAetSet = true;
+
+		// NOTE: Only the AetSet layout is naturally aligned for 64-bit pointers, so the sprite and database files always use 32-bit sections
+		inline StreamFormat GetAetSetFormat() const { return !Format_Sections ? StreamFormat::Classic : Format_AetSet64Bit ? StreamFormat::Section64Bit : StreamFormat::Section32Bit; }
+		inline StreamFormat GetDataFormat() const { return !Format_Sections ? StreamFormat::Classic : StreamFormat::Section32Bit; }
 	};
 
 	static ExportOptions RetrieveLastUsedExportOptions(const SuitesData& suites)
@@ -189,6 +196,15 @@ namespace AetPlugin
 			{ Shell::FileDialogItemType::Checkbox, "Compress Content", &options.SpriteFArc_Compress },
 			{ Shell::FileDialogItemType::VisualGroupEnd, "---" },
 
+			{ Shell::FileDialogItemType::VisualGroupStart, "Animation" },
+			{ Shell::FileDialogItemType::Checkbox, "Reduce Key Frames", &options.Animation_ReduceKeyFrames },
+			{ Shell::FileDialogItemType::VisualGroupEnd, "---" },
+
+			{ Shell::FileDialogItemType::VisualGroupStart, "Format" },
+			{ Shell::FileDialogItemType::Checkbox, "Section Format", &options.Format_Sections },
+			{ Shell::FileDialogItemType::Checkbox, "64-bit Aet Set", &options.Format_AetSet64Bit },
+			{ Shell::FileDialogItemType::VisualGroupEnd, "---" },
+
 			{ Shell::FileDialogItemType::VisualGroupStart, "Debug" },
 			{ Shell::FileDialogItemType::Checkbox, "Write Log File", &options.Debug_WriteLog },
 			{ Shell::FileDialogItemType::VisualGroupEnd, "---" },
@@ -276,12 +292,12 @@ namespace AetPlugin
 
 		exporter.SetLog(log.Stream, log.Level);
 
-		const auto[aetSet, sprSetSrcInfo] = exporter.ExportAetSet(outputDirectory, true);
+		const auto[aetSet, sprSetSrcInfo] = exporter.ExportAetSet(outputDirectory, true, fileDialog.Options.Animation_ReduceKeyFrames);
 
 		if (aetSet == nullptr)
 			return A_Err_GENERIC;
 
-		const auto aetSaveFuture = SaveFileAsync(fileDialog.OutputPath, (fileDialog.Options.Misc_ExportAetSet) ? aetSet.get() : nullptr);
+		const auto aetSaveFuture = SaveFileAsync(fileDialog.OutputPath, (fileDialog.Options.Misc_ExportAetSet) ? aetSet.get() : nullptr, fileDialog.Options.GetAetSetFormat());
 
 		const auto sprSet = TryExportSprSetFromAetSet(exporter, fileDialog.Options, sprSetSrcInfo.get(), *aetSet);
 		const auto sprSaveFuture = std::async(std::launch::async, [&]
@@ -290,7 +306,7 @@ namespace AetPlugin
 				return;
 
 			FArcPacker farcPacker {};
-			farcPacker.AddFile(sprSetName + ".bin", *sprSet);
+			farcPacker.AddFile(sprSetName + ".bin", *sprSet, fileDialog.Options.GetDataFormat());
 			farcPacker.CreateFlushFArc(Path::Combine(outputDirectory, sprSetName + ".farc"), fileDialog.Options.SpriteFArc_Compress);
 		});
 
@@ -311,8 +327,8 @@ namespace AetPlugin
 
 		const std::future<b8> dbSaveFutures[] =
 		{
-			SaveFileAsync(sprDBPath, sprDB.get()),
-			SaveFileAsync(aetDBPath, aetDB.get()),
+			SaveFileAsync(sprDBPath, sprDB.get(), fileDialog.Options.GetDataFormat()),
+			SaveFileAsync(aetDBPath, aetDB.get(), fileDialog.Options.GetDataFormat()),
 		};
 
 		return A_Err_NONE;
@@ -0,0 +1,473 @@
+#include "aet_diff.h"
+#include "core_parallel.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Comfy::Aet
+{
+	namespace
+	{
+		constexpr u32 Unmatched = 0xFFFFFFFF;
+
+		struct ListMatch
+		{
+			// NOTE: Index of the matching object in the other list or Unmatched
+			std::vector<u32> AToB, BToA;
+			// NOTE: For each object of B, whether it changed position relative to the other matched objects
+			std::vector<b8> MovedB;
+		};
+
+		// NOTE: Marks all matched objects of B outside the longest run that kept its relative order, which is the smallest set of objects that has to be moved
+		void FindMovedObjects(ListMatch& match)
+		{
+			match.MovedB.assign(match.BToA.size(), false);
+
+			std::vector<u32> sequence;
+			sequence.reserve(match.AToB.size());
+			for (const u32 indexB : match.AToB)
+			{
+				if (indexB != Unmatched)
+					sequence.push_back(indexB);
+			}
+
+			if (std::is_sorted(sequence.begin(), sequence.end()))
+				return;
+
+			// NOTE: Patience sorting, tails holds the sequence position ending the shortest known run of each length
+			std::vector<u32> tails, previous(sequence.size(), Unmatched);
+			for (u32 i = 0; i < static_cast<u32>(sequence.size()); i++)
+			{
+				const auto tail = std::lower_bound(tails.begin(), tails.end(), sequence[i], [&](u32 tailIndex, u32 value) { return sequence[tailIndex] < value; });
+				if (tail != tails.begin())
+					previous[i] = *(tail - 1);
+
+				if (tail == tails.end())
+					tails.push_back(i);
+				else
+					*tail = i;
+			}
+
+			for (const u32 indexB : sequence)
+				match.MovedB[indexB] = true;
+			for (u32 i = tails.empty() ? Unmatched : tails.back(); i != Unmatched; i = previous[i])
+				match.MovedB[sequence[i]] = false;
+		}
+
+		// NOTE: Objects sharing the same key are matched in order of occurrence
+		template <typename KeyFuncA, typename KeyFuncB>
+		ListMatch MatchByKey(size_t countA, size_t countB, KeyFuncA getKeyA, KeyFuncB getKeyB)
+		{
+			ListMatch match;
+			match.AToB.assign(countA, Unmatched);
+			match.BToA.assign(countB, Unmatched);
+
+			// NOTE: Most lists are either unchanged or only changed towards the end so the common prefix doesn't have to be hashed
+			u32 prefixCount = 0;
+			while (prefixCount < countA && prefixCount < countB && getKeyA(prefixCount) == getKeyB(prefixCount))
+			{
+				match.AToB[prefixCount] = match.BToA[prefixCount] = prefixCount;
+				prefixCount++;
+			}
+
+			if (prefixCount < countA && prefixCount < countB)
+			{
+				// NOTE: First unmatched B index per key with all further ones chained in order
+				std::unordered_map<std::string_view, u32> firstIndicesB;
+				std::vector<u32> nextIndicesB(countB, Unmatched);
+				firstIndicesB.reserve(countB - prefixCount);
+
+				for (u32 indexB = static_cast<u32>(countB); indexB-- > prefixCount;)
+				{
+					auto [it, inserted] = firstIndicesB.try_emplace(getKeyB(indexB), indexB);
+					if (!inserted)
+					{
+						nextIndicesB[indexB] = it->second;
+						it->second = indexB;
+					}
+				}
+
+				for (u32 indexA = prefixCount; indexA < static_cast<u32>(countA); indexA++)
+				{
+					const auto found = firstIndicesB.find(getKeyA(indexA));
+					if (found == firstIndicesB.end() || found->second == Unmatched)
+						continue;
+
+					const u32 indexB = found->second;
+					found->second = nextIndicesB[indexB];
+					match.AToB[indexA] = indexB;
+					match.BToA[indexB] = indexA;
+				}
+			}
+
+			FindMovedObjects(match);
+			return match;
+		}
+
+		b8 AreFCurvesEqual(const FCurve& a, const FCurve& b)
+		{
+			return (a.Keys.size() == b.Keys.size()) && (a.Keys.empty() || std::memcmp(a.Keys.data(), b.Keys.data(), a.Keys.size() * sizeof(KeyFrame)) == 0);
+		}
+
+		b8 AreFCurvesEqual(const FCurve3D& a, const FCurve3D& b)
+		{
+			return AreFCurvesEqual(a.X, b.X) && AreFCurvesEqual(a.Y, b.Y) && AreFCurvesEqual(a.Z, b.Z);
+		}
+
+		b8 AreCamerasEqual(const Camera* a, const Camera* b)
+		{
+			if (a == nullptr || b == nullptr)
+				return (a == b);
+
+			return AreFCurvesEqual(a->Eye, b->Eye) && AreFCurvesEqual(a->Position, b->Position) && AreFCurvesEqual(a->Direction, b->Direction)
+				&& AreFCurvesEqual(a->Rotation, b->Rotation) && AreFCurvesEqual(a->Zoom, b->Zoom);
+		}
+
+		b8 AreTransforms3DEqual(const LayerVideo3D* a, const LayerVideo3D* b)
+		{
+			if (a == nullptr || b == nullptr)
+				return (a == b);
+
+			for (size_t i = 0; i < LayerVideo3D::CurveCount; i++)
+			{
+				if (!AreFCurvesEqual((*a)[i], (*b)[i]))
+					return false;
+			}
+			return true;
+		}
+
+		b8 AreLayerAudiosEqual(const LayerAudio* a, const LayerAudio* b)
+		{
+			if (a == nullptr || b == nullptr)
+				return (a == b);
+
+			return AreFCurvesEqual(a->VolumeL, b->VolumeL) && AreFCurvesEqual(a->VolumeR, b->VolumeR) && AreFCurvesEqual(a->PanL, b->PanL) && AreFCurvesEqual(a->PanR, b->PanR);
+		}
+
+		b8 AreMarkersEqual(const std::vector<std::shared_ptr<Marker>>& a, const std::vector<std::shared_ptr<Marker>>& b)
+		{
+			if (a.size() != b.size())
+				return false;
+
+			for (size_t i = 0; i < a.size(); i++)
+			{
+				if (a[i]->Frame != b[i]->Frame || a[i]->Name != b[i]->Name)
+					return false;
+			}
+			return true;
+		}
+
+		b8 AreTransferModesEqual(const LayerTransferMode& a, const LayerTransferMode& b)
+		{
+			return (a.BlendMode == b.BlendMode) && (a.TrackMatte == b.TrackMatte)
+				&& (a.Flags.PreserveAlpha == b.Flags.PreserveAlpha) && (a.Flags.RandomizeDissolve == b.Flags.RandomizeDissolve);
+		}
+
+		std::string GetVideoKey(const Video& video)
+		{
+			if (video.Sources.empty())
+			{
+				char buffer[64];
+				sprintf_s(buffer, "Solid 0x%06X %dx%d", video.Color, video.Size.x, video.Size.y);
+				return buffer;
+			}
+
+			std::string key = video.Sources.front().Name;
+			for (size_t i = 1; i < video.Sources.size(); i++)
+				key.append("|").append(video.Sources[i].Name);
+			return key;
+		}
+
+		std::string_view GetCompositionName(const Composition& comp)
+		{
+			return comp.GivenName.empty() ? UnusedCompositionName : std::string_view(comp.GivenName);
+		}
+
+		std::string JoinPath(std::string_view parent, std::string_view name)
+		{
+			std::string path;
+			path.reserve(parent.size() + name.size() + 1);
+			path.append(parent).append("/").append(name);
+			return path;
+		}
+
+		struct SceneDiffer
+		{
+			const Scene& SceneA;
+			const Scene& SceneB;
+			std::vector<DiffChange>& OutChanges;
+
+			// NOTE: Matched video, audio, composition and layer pointers of A to those of B, used to compare references
+			std::unordered_map<const void*, const void*> MatchedObjects;
+
+			void Diff(DiffPropertyFlags sceneProperties)
+			{
+				if (SceneA.StartFrame != SceneB.StartFrame || SceneA.EndFrame != SceneB.EndFrame || SceneA.FrameRate != SceneB.FrameRate
+					|| SceneA.BackgroundColor != SceneB.BackgroundColor || SceneA.Resolution.x != SceneB.Resolution.x || SceneA.Resolution.y != SceneB.Resolution.y)
+					sceneProperties |= DiffPropertyFlags_Values;
+
+				if (!AreCamerasEqual(SceneA.Camera.get(), SceneB.Camera.get()))
+					sceneProperties |= DiffPropertyFlags_Camera;
+
+				size_t objectCountA = SceneA.Videos.size() + SceneA.Audios.size() + SceneA.Compositions.size() + 1;
+				SceneA.ForEachComp([&](const auto& comp) { objectCountA += (comp != nullptr) ? comp->Layers.size() : 0; });
+				MatchedObjects.reserve(objectCountA);
+
+				if (sceneProperties != 0)
+					AddChange(DiffChangeType::Modified, DiffObjectType::Scene, SceneB.Name, DiffObjectRef { &SceneA }, DiffObjectRef { &SceneB }, sceneProperties);
+
+				DiffVideos();
+				DiffAudios();
+				DiffCompositions();
+			}
+
+		private:
+			void AddChange(DiffChangeType type, DiffObjectType objectType, std::string path, const DiffObjectRef& a, const DiffObjectRef& b, DiffPropertyFlags properties = 0, Transform2DFieldFlags transformFields = 0)
+			{
+				DiffChange& change = OutChanges.emplace_back();
+				change.Type = type;
+				change.ObjectType = objectType;
+				change.ModifiedProperties = properties;
+				change.ModifiedTransformFields = transformFields;
+				change.Path = std::move(path);
+				change.A = a;
+				change.B = b;
+			}
+
+			template <typename T, typename RefFunc, typename PathFunc, typename CompareFunc>
+			void AddListChanges(DiffObjectType objectType, const std::vector<std::shared_ptr<T>>& listA, const std::vector<std::shared_ptr<T>>& listB, const ListMatch& match, RefFunc getRef, PathFunc getPath, CompareFunc compare)
+			{
+				for (size_t i = 0; i < listA.size(); i++)
+				{
+					if (match.AToB[i] == Unmatched)
+						AddChange(DiffChangeType::Removed, objectType, getPath(*listA[i]), getRef(SceneA, listA[i].get()), getRef(SceneB, static_cast<const T*>(nullptr)));
+				}
+
+				for (size_t i = 0; i < listB.size(); i++)
+				{
+					if (match.BToA[i] == Unmatched)
+						AddChange(DiffChangeType::Added, objectType, getPath(*listB[i]), getRef(SceneA, static_cast<const T*>(nullptr)), getRef(SceneB, listB[i].get()));
+				}
+
+				for (size_t i = 0; i < listB.size(); i++)
+				{
+					if (match.BToA[i] == Unmatched)
+						continue;
+
+					const T& a = *listA[match.BToA[i]];
+					const T& b = *listB[i];
+
+					Transform2DFieldFlags transformFields = 0;
+					DiffPropertyFlags properties = compare(a, b, transformFields);
+					if (match.MovedB[i])
+						properties |= DiffPropertyFlags_Order;
+
+					if (properties != 0)
+						AddChange(DiffChangeType::Modified, objectType, getPath(b), getRef(SceneA, &a), getRef(SceneB, &b), properties, transformFields);
+				}
+			}
+
+			template <typename T>
+			void AddMatchedObjects(const std::vector<std::shared_ptr<T>>& listA, const std::vector<std::shared_ptr<T>>& listB, const ListMatch& match)
+			{
+				for (size_t i = 0; i < listA.size(); i++)
+				{
+					if (match.AToB[i] != Unmatched)
+						MatchedObjects[listA[i].get()] = listB[match.AToB[i]].get();
+				}
+			}
+
+			b8 IsMatchedReference(const void* a, const void* b) const
+			{
+				if (a == nullptr || b == nullptr)
+					return (a == b);
+
+				const auto found = MatchedObjects.find(a);
+				return (found != MatchedObjects.end() && found->second == b);
+			}
+
+			void DiffVideos()
+			{
+				std::vector<std::string> keysA, keysB;
+				keysA.reserve(SceneA.Videos.size());
+				keysB.reserve(SceneB.Videos.size());
+				for (const auto& video : SceneA.Videos) keysA.push_back(GetVideoKey(*video));
+				for (const auto& video : SceneB.Videos) keysB.push_back(GetVideoKey(*video));
+
+				const ListMatch match = MatchByKey(keysA.size(), keysB.size(), [&](u32 i) { return std::string_view(keysA[i]); }, [&](u32 i) { return std::string_view(keysB[i]); });
+				AddMatchedObjects(SceneA.Videos, SceneB.Videos, match);
+
+				AddListChanges(DiffObjectType::Video, SceneA.Videos, SceneB.Videos, match,
+					[](const Scene& scene, const Video* video) { return DiffObjectRef { &scene, nullptr, nullptr, video }; },
+					[&](const Video& video) { return JoinPath(JoinPath(SceneB.Name, "Video"), GetVideoKey(video)); },
+					[](const Video& a, const Video& b, Transform2DFieldFlags&)
+				{
+					DiffPropertyFlags properties = 0;
+					if (a.Color != b.Color || a.Size.x != b.Size.x || a.Size.y != b.Size.y || a.FilesPerFrame != b.FilesPerFrame)
+						properties |= DiffPropertyFlags_Values;
+
+					const b8 sourcesEqual = (a.Sources.size() == b.Sources.size()) && std::equal(a.Sources.begin(), a.Sources.end(), b.Sources.begin(),
+						[](const VideoSource& sourceA, const VideoSource& sourceB) { return sourceA.ID == sourceB.ID && sourceA.Name == sourceB.Name; });
+					if (!sourcesEqual)
+						properties |= DiffPropertyFlags_Sources;
+
+					return properties;
+				});
+			}
+
+			void DiffAudios()
+			{
+				std::vector<std::string> keysA, keysB;
+				keysA.reserve(SceneA.Audios.size());
+				keysB.reserve(SceneB.Audios.size());
+				for (const auto& audio : SceneA.Audios) keysA.push_back(std::to_string(audio->SoundID));
+				for (const auto& audio : SceneB.Audios) keysB.push_back(std::to_string(audio->SoundID));
+
+				const ListMatch match = MatchByKey(keysA.size(), keysB.size(), [&](u32 i) { return std::string_view(keysA[i]); }, [&](u32 i) { return std::string_view(keysB[i]); });
+				AddMatchedObjects(SceneA.Audios, SceneB.Audios, match);
+
+				AddListChanges(DiffObjectType::Audio, SceneA.Audios, SceneB.Audios, match,
+					[](const Scene& scene, const Audio* audio) { return DiffObjectRef { &scene, nullptr, nullptr, nullptr, audio }; },
+					[&](const Audio& audio) { return JoinPath(JoinPath(SceneB.Name, "Audio"), std::to_string(audio.SoundID)); },
+					[](const Audio&, const Audio&, Transform2DFieldFlags&) { return DiffPropertyFlags {}; });
+			}
+
+			void DiffCompositions()
+			{
+				const auto& compsA = SceneA.Compositions;
+				const auto& compsB = SceneB.Compositions;
+
+				const ListMatch match = MatchByKey(compsA.size(), compsB.size(), [&](u32 i) { return GetCompositionName(*compsA[i]); }, [&](u32 i) { return GetCompositionName(*compsB[i]); });
+				AddMatchedObjects(compsA, compsB, match);
+
+				if (SceneA.RootComposition != nullptr && SceneB.RootComposition != nullptr)
+					MatchedObjects[SceneA.RootComposition.get()] = SceneB.RootComposition.get();
+
+				AddListChanges(DiffObjectType::Composition, compsA, compsB, match,
+					[](const Scene& scene, const Composition* comp) { return DiffObjectRef { &scene, comp }; },
+					[&](const Composition& comp) { return JoinPath(SceneB.Name, GetCompositionName(comp)); },
+					[](const Composition&, const Composition&, Transform2DFieldFlags&) { return DiffPropertyFlags {}; });
+
+				// NOTE: All compositions have to be matched before any layer so that composition item references can be resolved
+				if (SceneA.RootComposition != nullptr && SceneB.RootComposition != nullptr)
+					DiffLayers(*SceneA.RootComposition, *SceneB.RootComposition);
+
+				for (size_t i = 0; i < compsB.size(); i++)
+				{
+					if (match.BToA[i] != Unmatched)
+						DiffLayers(*compsA[match.BToA[i]], *compsB[i]);
+				}
+			}
+
+			void DiffLayers(const Composition& compA, const Composition& compB)
+			{
+				const auto& layersA = compA.Layers;
+				const auto& layersB = compB.Layers;
+
+				const ListMatch match = MatchByKey(layersA.size(), layersB.size(), [&](u32 i) { return std::string_view(layersA[i]->Name); }, [&](u32 i) { return std::string_view(layersB[i]->Name); });
+				AddMatchedObjects(layersA, layersB, match);
+
+				const std::string compPath = JoinPath(SceneB.Name, GetCompositionName(compB));
+				AddListChanges(DiffObjectType::Layer, layersA, layersB, match,
+					[&](const Scene& scene, const Layer* layer) { return DiffObjectRef { &scene, (&scene == &SceneA) ? &compA : &compB, layer }; },
+					[&](const Layer& layer) { return JoinPath(compPath, layer.Name); },
+					[&](const Layer& a, const Layer& b, Transform2DFieldFlags& outTransformFields) { return CompareLayers(a, b, outTransformFields); });
+			}
+
+			DiffPropertyFlags CompareLayers(const Layer& a, const Layer& b, Transform2DFieldFlags& outTransformFields) const
+			{
+				DiffPropertyFlags properties = 0;
+				if (a.StartFrame != b.StartFrame || a.EndFrame != b.EndFrame || a.StartOffset != b.StartOffset || a.TimeScale != b.TimeScale
+					|| std::memcmp(&a.Flags, &b.Flags, sizeof(LayerFlags)) != 0 || a.Quality != b.Quality || a.ItemType != b.ItemType)
+					properties |= DiffPropertyFlags_Values;
+
+				if (!IsMatchedReference(a.Ref.Video.get(), b.Ref.Video.get()) || !IsMatchedReference(a.Ref.Audio.get(), b.Ref.Audio.get()) || !IsMatchedReference(a.Ref.Composition.get(), b.Ref.Composition.get()))
+					properties |= DiffPropertyFlags_Item;
+
+				if (!IsMatchedReference(a.Ref.ParentLayer.get(), b.Ref.ParentLayer.get()))
+					properties |= DiffPropertyFlags_RefParent;
+
+				if (!AreMarkersEqual(a.Markers, b.Markers))
+					properties |= DiffPropertyFlags_Markers;
+
+				const LayerVideo* videoA = a.LayerVideo.get();
+				const LayerVideo* videoB = b.LayerVideo.get();
+				if (videoA == nullptr || videoB == nullptr)
+				{
+					if (videoA != videoB)
+						properties |= DiffPropertyFlags_TransferMode | DiffPropertyFlags_Transform | DiffPropertyFlags_Transform3D;
+				}
+				else
+				{
+					if (!AreTransferModesEqual(videoA->TransferMode, videoB->TransferMode))
+						properties |= DiffPropertyFlags_TransferMode;
+
+					for (Transform2DField field = 0; field < Transform2DField_Count; field++)
+					{
+						if (!AreFCurvesEqual(videoA->Transform[field], videoB->Transform[field]))
+							outTransformFields |= (1 << field);
+					}
+
+					if (outTransformFields != 0)
+						properties |= DiffPropertyFlags_Transform;
+
+					if (!AreTransforms3DEqual(videoA->Transform3D.get(), videoB->Transform3D.get()))
+						properties |= DiffPropertyFlags_Transform3D;
+				}
+
+				if (!AreLayerAudiosEqual(a.LayerAudio.get(), b.LayerAudio.get()))
+					properties |= DiffPropertyFlags_LayerAudio;
+
+				return properties;
+			}
+		};
+	}
+
+	b8 AetSetDiff::IsSceneChanged(const Scene& sceneB) const
+	{
+		return std::any_of(Changes.begin(), Changes.end(), [&](const DiffChange& change) { return (change.B.Scene == &sceneB); });
+	}
+
+	AetSetDiff Diff(AetSet& a, AetSet& b)
+	{
+		a.LoadAllScenes();
+		b.LoadAllScenes();
+
+		AetSetDiff result;
+		if (a.Name != b.Name)
+			result.Changes.push_back(DiffChange { DiffChangeType::Modified, DiffObjectType::Set, DiffPropertyFlags_Values, 0, b.Name, DiffObjectRef {}, DiffObjectRef {} });
+
+		const ListMatch match = MatchByKey(a.GetSceneCount(), b.GetSceneCount(), [&](u32 i) { return std::string_view(a.GetScene(i).Name); }, [&](u32 i) { return std::string_view(b.GetScene(i).Name); });
+
+		for (size_t i = 0; i < a.GetSceneCount(); i++)
+		{
+			if (match.AToB[i] == Unmatched)
+				result.Changes.push_back(DiffChange { DiffChangeType::Removed, DiffObjectType::Scene, 0, 0, a.GetScene(i).Name, DiffObjectRef { &a.GetScene(i) }, DiffObjectRef {} });
+		}
+
+		for (size_t i = 0; i < b.GetSceneCount(); i++)
+		{
+			if (match.BToA[i] == Unmatched)
+				result.Changes.push_back(DiffChange { DiffChangeType::Added, DiffObjectType::Scene, 0, 0, b.GetScene(i).Name, DiffObjectRef {}, DiffObjectRef { &b.GetScene(i) } });
+		}
+
+		std::vector<u32> matchedScenesB;
+		for (u32 i = 0; i < static_cast<u32>(b.GetSceneCount()); i++)
+		{
+			if (match.BToA[i] != Unmatched)
+				matchedScenesB.push_back(i);
+		}
+
+		std::vector<std::vector<DiffChange>> sceneChanges(matchedScenesB.size());
+		ParallelFor(matchedScenesB.size(), matchedScenesB.size(), 1, [&](size_t index)
+		{
+			const u32 indexB = matchedScenesB[index];
+			SceneDiffer differ { a.GetScene(match.BToA[indexB]), b.GetScene(indexB), sceneChanges[index] };
+			differ.Diff(match.MovedB[indexB] ? DiffPropertyFlags_Order : DiffPropertyFlags_None);
+		});
+
+		for (auto& changes : sceneChanges)
+			result.Changes.insert(result.Changes.end(), std::make_move_iterator(changes.begin()), std::make_move_iterator(changes.end()));
+
+		return result;
+	}
+}
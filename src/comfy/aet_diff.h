@@ -0,0 +1,88 @@
+#pragma once
+#include "core_types.h"
+#include "file_format_aet_set.h"
+
+namespace Comfy::Aet
+{
+	enum class DiffObjectType : u8
+	{
+		Set,
+		Scene,
+		Composition,
+		Layer,
+		Video,
+		Audio,
+		Count
+	};
+
+	enum class DiffChangeType : u8
+	{
+		Added,
+		Removed,
+		Modified,
+		Count
+	};
+
+	using DiffPropertyFlags = u32;
+	enum DiffPropertyFlagsEnum : DiffPropertyFlags
+	{
+		DiffPropertyFlags_None = 0,
+		// NOTE: Plain values such as the set name, the scene header, the video color, size and frame rate or the layer frame range, time remapping, flags and quality
+		DiffPropertyFlags_Values = (1 << 0),
+		// NOTE: Moved relative to the other matched objects of the same list
+		DiffPropertyFlags_Order = (1 << 1),
+		DiffPropertyFlags_Camera = (1 << 2),
+		DiffPropertyFlags_Sources = (1 << 3),
+		DiffPropertyFlags_Item = (1 << 4),
+		DiffPropertyFlags_RefParent = (1 << 5),
+		DiffPropertyFlags_Markers = (1 << 6),
+		// NOTE: Including adding or removing the LayerVideo itself
+		DiffPropertyFlags_TransferMode = (1 << 7),
+		DiffPropertyFlags_Transform = (1 << 8),
+		DiffPropertyFlags_Transform3D = (1 << 9),
+		DiffPropertyFlags_LayerAudio = (1 << 10),
+	};
+
+	// NOTE: Location of an object within one of the two sets, members that don't apply to the object type are null
+	struct DiffObjectRef
+	{
+		const Scene* Scene;
+		const Composition* Composition;
+		const Layer* Layer;
+		const Video* Video;
+		const Audio* Audio;
+	};
+
+	struct DiffChange
+	{
+		DiffChangeType Type;
+		DiffObjectType ObjectType;
+		// NOTE: Only set for modified objects
+		DiffPropertyFlags ModifiedProperties;
+		Transform2DFieldFlags ModifiedTransformFields;
+		// NOTE: Such as "MAIN", "MAIN/Root/layer_name", "MAIN/Video/SPR_NAME" or "MAIN/Audio/1", using the names of B except for removed objects
+		std::string Path;
+		// NOTE: Object within set A and set B. The side an object was added to or removed from only references the containing scene and composition
+		//		 (if any) with the object itself being null. Both are empty for set changes and the missing side of added or removed scenes
+		DiffObjectRef A, B;
+	};
+
+	struct AetSetDiff
+	{
+		// NOTE: Set changes first, followed by all removed and added scenes and then the changes within each remaining scene in the order of B.
+		//		 Within a scene all removed, added and modified objects are listed per object type. The content of added and removed scenes
+		//		 and compositions isn't listed separately
+		std::vector<DiffChange> Changes;
+
+		inline b8 IsEmpty() const { return Changes.empty(); }
+		// NOTE: Whether any object of the scene of B or the scene itself was added or modified, or any of its objects removed
+		b8 IsSceneChanged(const Scene& sceneB) const;
+	};
+
+	// NOTE: Structural comparison for incremental exports, so that unchanged outputs can be skipped and changed ones narrowed down.
+	//		 Scenes are matched by name, compositions by their given name, layers within matched compositions by name, videos by their source names
+	//		 (solid color videos by color and size) and audios by their sound ID. Objects sharing the same key are matched in order of occurrence.
+	//		 Curves are compared key frame by key frame bitwise and item and parent references by whether they point to matched objects.
+	//		 Loads all lazily read scenes first, after which the scenes are compared in parallel
+	AetSetDiff Diff(AetSet& a, AetSet& b);
+}
@@ -0,0 +1,539 @@
+#include "aet_fcurve_util.h"
+#include "core_parallel.h"
+#include <xmmintrin.h>
+#include <algorithm>
+
+namespace Comfy::Aet
+{
+	namespace
+	{
+		// NOTE: Hermite basis of InterpolateHermite() split into the part independent of the end tangent and the factor the end tangent is multiplied by
+		struct HermiteEndTangentTerms
+		{
+			f32 Constant;
+			f32 EndTangentFactor;
+		};
+
+		HermiteEndTangentTerms GetHermiteEndTangentTerms(const KeyFrame& start, const KeyFrame& end, frame_t frame)
+		{
+			const f32 range = end.Frame - start.Frame;
+			const f32 t = (frame - start.Frame) / range;
+			const f32 tt = (t * t), ttt = (tt * t);
+
+			HermiteEndTangentTerms result;
+			result.Constant = ((((ttt - (tt * 2.0f)) + t) * start.Tangent) * range) + (((tt * 3.0f) - (ttt * 2.0f)) * end.Value) + ((((ttt * 2.0f) - (tt * 3.0f)) + 1.0f) * start.Value);
+			result.EndTangentFactor = ((ttt - tt) * range);
+			return result;
+		}
+
+		// NOTE: Calls the function for every point the original curve section between the two key indices is compared at, all original key frames and the middle between each pair
+		template <typename Func>
+		void ForEachCheckPoint(const std::vector<KeyFrame>& keys, size_t startIndex, size_t endIndex, Func func)
+		{
+			for (size_t i = startIndex; i < endIndex; i++)
+			{
+				const KeyFrame& current = keys[i];
+				const KeyFrame& next = keys[i + 1];
+				const frame_t middleFrame = (current.Frame + next.Frame) * 0.5f;
+
+				if (i > startIndex)
+					func(current.Frame, current.Value);
+				func(middleFrame, InterpolateHermite(current, next, middleFrame));
+			}
+		}
+
+		b8 SectionFitsWithinTolerance(const std::vector<KeyFrame>& keys, size_t startIndex, size_t endIndex, const KeyFrame& start, const KeyFrame& end, f32 tolerance)
+		{
+			b8 fits = true;
+			ForEachCheckPoint(keys, startIndex, endIndex, [&](frame_t frame, f32 value)
+			{
+				if (fits && Absolute(InterpolateHermite(start, end, frame) - value) > tolerance)
+					fits = false;
+			});
+			return fits;
+		}
+
+		std::optional<f32> FitEndTangentLeastSquares(const std::vector<KeyFrame>& keys, size_t startIndex, size_t endIndex, const KeyFrame& start, const KeyFrame& end)
+		{
+			f64 numerator = 0.0, denominator = 0.0;
+			ForEachCheckPoint(keys, startIndex, endIndex, [&](frame_t frame, f32 value)
+			{
+				const auto terms = GetHermiteEndTangentTerms(start, end, frame);
+				numerator += static_cast<f64>(value - terms.Constant) * terms.EndTangentFactor;
+				denominator += static_cast<f64>(terms.EndTangentFactor) * terms.EndTangentFactor;
+			});
+
+			if (denominator <= 0.000001)
+				return std::nullopt;
+
+			return static_cast<f32>(numerator / denominator);
+		}
+
+		b8 IsConstantWithinTolerance(const std::vector<KeyFrame>& keys, f32 tolerance)
+		{
+			const f32 constantValue = keys.front().Value;
+
+			b8 isConstant = true;
+			ForEachCheckPoint(keys, 0, keys.size() - 1, [&](frame_t frame, f32 value)
+			{
+				if (isConstant && Absolute(value - constantValue) > tolerance)
+					isConstant = false;
+			});
+			return isConstant && (Absolute(keys.back().Value - constantValue) <= tolerance);
+		}
+
+		frame_t GetSampleFrame(frame_t startFrame, frame_t step, size_t sampleIndex)
+		{
+			return startFrame + (static_cast<f32>(sampleIndex) * step);
+		}
+
+		// NOTE: Solves for the tangents of all key frames at once which only couple with their direct neighbors, making the normal equations tridiagonal.
+		//		 The tangents are weakly pulled towards the finite difference slope of the samples so that key frames without any samples between them stay well defined
+		void SolveKeyFrameTangents(const f32* samples, size_t sampleCount, frame_t startFrame, frame_t step, const std::vector<size_t>& keySampleIndices, std::vector<KeyFrame>& inOutKeys)
+		{
+			constexpr f64 regularizationWeight = 0.0001;
+
+			const size_t keyCount = inOutKeys.size();
+			std::vector<f64> lower(keyCount, 0.0), diagonal(keyCount, 0.0), upper(keyCount, 0.0), rightHandSide(keyCount, 0.0);
+
+			for (size_t k = 0; k < keyCount; k++)
+			{
+				const size_t sampleIndex = keySampleIndices[k];
+				const size_t previousIndex = (sampleIndex > 0) ? (sampleIndex - 1) : sampleIndex;
+				const size_t nextIndex = ((sampleIndex + 1) < sampleCount) ? (sampleIndex + 1) : sampleIndex;
+				const f64 slope = static_cast<f64>(samples[nextIndex] - samples[previousIndex]) / (static_cast<f64>(nextIndex - previousIndex) * step);
+
+				diagonal[k] += regularizationWeight;
+				rightHandSide[k] += regularizationWeight * slope;
+			}
+
+			for (size_t k = 0; (k + 1) < keyCount; k++)
+			{
+				KeyFrame start = inOutKeys[k], end = inOutKeys[k + 1];
+				start.Tangent = end.Tangent = 0.0f;
+
+				for (size_t i = keySampleIndices[k] + 1; i < keySampleIndices[k + 1]; i++)
+				{
+					const frame_t frame = GetSampleFrame(startFrame, step, i);
+					const f64 range = (end.Frame - start.Frame);
+					const f64 t = (frame - start.Frame) / range;
+					const f64 startFactor = ((((t * t) * t) - ((t * t) * 2.0)) + t) * range;
+					const f64 endFactor = (((t * t) * t) - (t * t)) * range;
+					const f64 residual = samples[i] - InterpolateHermite(start, end, frame);
+
+					diagonal[k] += startFactor * startFactor;
+					upper[k] += startFactor * endFactor;
+					lower[k + 1] += startFactor * endFactor;
+					diagonal[k + 1] += endFactor * endFactor;
+					rightHandSide[k] += startFactor * residual;
+					rightHandSide[k + 1] += endFactor * residual;
+				}
+			}
+
+			// NOTE: Thomas algorithm, the system is symmetric positive definite due to the regularization
+			for (size_t k = 1; k < keyCount; k++)
+			{
+				const f64 factor = lower[k] / diagonal[k - 1];
+				diagonal[k] -= factor * upper[k - 1];
+				rightHandSide[k] -= factor * rightHandSide[k - 1];
+			}
+
+			for (size_t k = keyCount; k-- > 0;)
+			{
+				const f64 nextTangent = ((k + 1) < keyCount) ? static_cast<f64>(inOutKeys[k + 1].Tangent) : 0.0;
+				inOutKeys[k].Tangent = static_cast<f32>((rightHandSide[k] - (upper[k] * nextTangent)) / diagonal[k]);
+			}
+		}
+
+		f32 GetMaxAbsoluteDifference(const f32* a, const f32* b, size_t count)
+		{
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			__m128 maxDifferenceV = _mm_setzero_ps();
+
+			size_t i = 0;
+			for (; (i + 4) <= count; i += 4)
+				maxDifferenceV = _mm_max_ps(maxDifferenceV, _mm_andnot_ps(signMask, _mm_sub_ps(_mm_loadu_ps(&a[i]), _mm_loadu_ps(&b[i]))));
+
+			alignas(16) f32 lanes[4];
+			_mm_store_ps(lanes, maxDifferenceV);
+			f32 maxDifference = Max(Max(lanes[0], lanes[1]), Max(lanes[2], lanes[3]));
+
+			for (; i < count; i++)
+				maxDifference = Max(maxDifference, Absolute(a[i] - b[i]));
+			return maxDifference;
+		}
+	}
+
+	size_t ReduceFCurveKeyFrames(FCurve& fcurve, f32 tolerance)
+	{
+		std::vector<KeyFrame> keys = std::move(fcurve.Keys);
+		const size_t keyCount = keys.size();
+
+		if (keyCount < 2 || tolerance < 0.0f)
+		{
+			fcurve.Keys = std::move(keys);
+			return 0;
+		}
+
+		if (IsConstantWithinTolerance(keys, tolerance))
+		{
+			fcurve.Keys = { KeyFrame(keys.front().Frame, keys.front().Value, 0.0f) };
+			return (keyCount - 1);
+		}
+
+		fcurve.Keys.clear();
+		fcurve.Keys.push_back(keys.front());
+
+		size_t startIndex = 0;
+		while (startIndex < (keyCount - 1))
+		{
+			const KeyFrame start = fcurve.Keys.back();
+
+			// NOTE: Hold steps can't be part of a longer section
+			if (keys[startIndex + 1].Frame <= start.Frame)
+			{
+				fcurve.Keys.push_back(keys[++startIndex]);
+				continue;
+			}
+
+			// NOTE: Always possible because every accepted end key also has to fit the original section following it
+			size_t bestEndIndex = startIndex + 1;
+			KeyFrame bestEnd = keys[bestEndIndex];
+
+			for (size_t endIndex = startIndex + 2; endIndex < keyCount; endIndex++)
+			{
+				if (keys[endIndex].Frame <= keys[endIndex - 1].Frame)
+					break;
+
+				KeyFrame end = keys[endIndex];
+				b8 fits = SectionFitsWithinTolerance(keys, startIndex, endIndex, start, end, tolerance);
+
+				if (!fits)
+				{
+					if (const auto fittedTangent = FitEndTangentLeastSquares(keys, startIndex, endIndex, start, end); fittedTangent.has_value())
+					{
+						end.Tangent = fittedTangent.value();
+						fits = SectionFitsWithinTolerance(keys, startIndex, endIndex, start, end, tolerance);
+
+						// NOTE: The refitted tangent also changes the following section which has to remain within tolerance for the next search to start from
+						if (fits && (endIndex + 1) < keyCount && keys[endIndex + 1].Frame > end.Frame)
+							fits = SectionFitsWithinTolerance(keys, endIndex, endIndex + 1, end, keys[endIndex + 1], tolerance);
+					}
+				}
+
+				if (!fits)
+					break;
+
+				bestEndIndex = endIndex;
+				bestEnd = end;
+			}
+
+			fcurve.Keys.push_back(bestEnd);
+			startIndex = bestEndIndex;
+		}
+
+		return (keyCount - fcurve.Keys.size());
+	}
+
+	FCurve FitFCurveToSamples(const f32* samples, size_t sampleCount, frame_t startFrame, frame_t step, f32 maxError)
+	{
+		FCurve result;
+		if (sampleCount < 1)
+			return result;
+
+		const auto [minSample, maxSample] = std::minmax_element(samples, samples + sampleCount);
+		if (sampleCount == 1 || (*maxSample - *minSample) <= (maxError * 2.0f))
+		{
+			result.Keys = { KeyFrame(startFrame, (sampleCount == 1) ? samples[0] : ((*minSample + *maxSample) * 0.5f), 0.0f) };
+			return result;
+		}
+
+		std::vector<size_t> keySampleIndices = { 0, sampleCount - 1 };
+		std::vector<f32> fittedSamples(sampleCount);
+
+		const auto fitKeyFrames = [&](const std::vector<size_t>& keySampleIndices, std::vector<KeyFrame>& outKeys)
+		{
+			outKeys.resize(keySampleIndices.size());
+			for (size_t k = 0; k < keySampleIndices.size(); k++)
+				outKeys[k] = KeyFrame(GetSampleFrame(startFrame, step, keySampleIndices[k]), samples[keySampleIndices[k]], 0.0f);
+
+			SolveKeyFrameTangents(samples, sampleCount, startFrame, step, keySampleIndices, outKeys);
+			SampleFCurveRange(outKeys, startFrame, sampleCount, step, fittedSamples.data());
+			return (GetMaxAbsoluteDifference(samples, fittedSamples.data(), sampleCount) <= maxError);
+		};
+
+		while (!fitKeyFrames(keySampleIndices, result.Keys))
+		{
+			const size_t previousKeyCount = keySampleIndices.size();
+			for (size_t k = 0; (k + 1) < previousKeyCount; k++)
+			{
+				size_t worstIndex = 0;
+				f32 worstError = maxError;
+
+				for (size_t i = keySampleIndices[k] + 1; i < keySampleIndices[k + 1]; i++)
+				{
+					if (const f32 error = Absolute(samples[i] - fittedSamples[i]); error > worstError)
+					{
+						worstIndex = i;
+						worstError = error;
+					}
+				}
+
+				if (worstIndex != 0)
+					keySampleIndices.push_back(worstIndex);
+			}
+
+			// NOTE: Only the key frames themselves may remain outside the error bound due to float rounding, nothing left to insert at that point
+			if (keySampleIndices.size() == previousKeyCount)
+				return result;
+
+			std::sort(keySampleIndices.begin(), keySampleIndices.end());
+		}
+
+		// NOTE: Splitting every failing section at once overshoots, so try to remove each added key frame again while the fit remains within the error bound
+		std::vector<size_t> candidateIndices;
+		std::vector<KeyFrame> candidateKeys;
+
+		for (size_t k = 1; (k + 1) < keySampleIndices.size();)
+		{
+			candidateIndices = keySampleIndices;
+			candidateIndices.erase(candidateIndices.begin() + k);
+
+			if (fitKeyFrames(candidateIndices, candidateKeys))
+			{
+				keySampleIndices.swap(candidateIndices);
+				result.Keys.swap(candidateKeys);
+			}
+			else
+			{
+				k++;
+			}
+		}
+
+		return result;
+	}
+
+	void FitFCurvesToSamples(const std::vector<FCurveFitJob>& jobs)
+	{
+		// NOTE: Short curves are fitted faster than a thread can be started, so only spread the jobs across as many workers as there are samples to justify them
+		constexpr size_t minSamplesPerThread = 512;
+
+		size_t totalSampleCount = 0;
+		for (const auto& job : jobs)
+			totalSampleCount += job.Samples.size();
+
+		ParallelFor(jobs.size(), totalSampleCount, minSamplesPerThread, [&](size_t jobIndex)
+		{
+			const auto& job = jobs[jobIndex];
+			*job.OutFCurve = FitFCurveToSamples(job.Samples.data(), job.Samples.size(), job.StartFrame, job.Step, job.MaxError);
+		});
+	}
+
+	vec2 GetFCurveValueRange(const FCurve& fcurve, frame_t startFrame, frame_t endFrame)
+	{
+		const std::vector<KeyFrame>& keys = fcurve.Keys;
+		if (keys.empty())
+			return vec2(0.0f, 0.0f);
+
+		if (endFrame < startFrame)
+			std::swap(startFrame, endFrame);
+
+		const f32 startValue = fcurve.SampleAt(startFrame), endValue = fcurve.SampleAt(endFrame);
+		vec2 range = vec2(Min(startValue, endValue), Max(startValue, endValue));
+		const auto includeValue = [&](f32 value) { range.x = Min(range.x, value); range.y = Max(range.y, value); };
+
+		// NOTE: First key at or after the start frame, every section ending after it may overlap the range
+		const size_t firstIndex = static_cast<size_t>(std::distance(keys.begin(), std::lower_bound(keys.begin(), keys.end(), startFrame, [](const KeyFrame& key, frame_t frame) { return key.Frame < frame; })));
+		for (size_t i = Max<size_t>(firstIndex, 1); i < keys.size() && keys[i - 1].Frame <= endFrame; i++)
+		{
+			const KeyFrame& start = keys[i - 1];
+			const KeyFrame& end = keys[i];
+
+			// NOTE: Also covers both sides of hold steps
+			if (start.Frame >= startFrame)
+				includeValue(start.Value);
+			if (end.Frame <= endFrame)
+				includeValue(end.Value);
+
+			const f32 sectionRange = (end.Frame - start.Frame);
+			if (sectionRange <= 0.0f)
+				continue;
+
+			// NOTE: Derivative of InterpolateHermite() with respect to t as (a * t^2 + b * t + c)
+			const f32 startSlope = (start.Tangent * sectionRange), endSlope = (end.Tangent * sectionRange), valueDelta = (end.Value - start.Value);
+			const f32 a = ((startSlope + endSlope) * 3.0f) - (valueDelta * 6.0f);
+			const f32 b = (valueDelta * 6.0f) - (startSlope * 4.0f) - (endSlope * 2.0f);
+			const f32 c = startSlope;
+
+			const f32 minT = (Max(startFrame, start.Frame) - start.Frame) / sectionRange;
+			const f32 maxT = (Min(endFrame, end.Frame) - start.Frame) / sectionRange;
+			const auto includeExtremum = [&](f32 t)
+			{
+				if (t > minT && t < maxT)
+					includeValue(InterpolateHermite(start, end, start.Frame + (t * sectionRange)));
+			};
+
+			if (Absolute(a) <= 0.000001f)
+			{
+				if (b != 0.0f)
+					includeExtremum(-c / b);
+			}
+			else if (const f32 discriminant = ((b * b) - (a * c * 4.0f)); discriminant >= 0.0f)
+			{
+				const f32 root = ::sqrtf(discriminant);
+				includeExtremum((-b + root) / (a * 2.0f));
+				includeExtremum((-b - root) / (a * 2.0f));
+			}
+		}
+
+		return range;
+	}
+
+	BakedFCurve BakeFCurve(const FCurve& fcurve, frame_t startFrame, frame_t endFrame, const FCurveBakeSettings& settings)
+	{
+		BakedFCurve baked;
+		baked.StartFrame = startFrame;
+		baked.InverseFrameStep = (1.0f / settings.FrameStep);
+
+		std::vector<f32> values;
+		if (fcurve->size() <= 1 || endFrame <= startFrame || settings.FrameStep <= 0.0f)
+		{
+			values.push_back(fcurve.SampleAt(startFrame));
+		}
+		else
+		{
+			const size_t sampleCount = static_cast<size_t>(Ceil((endFrame - startFrame) / settings.FrameStep)) + 1;
+			values.resize(sampleCount);
+			fcurve.SampleRange(startFrame, sampleCount, settings.FrameStep, values.data());
+		}
+
+		if (settings.Quantize16Bit && values.size() > 1)
+		{
+			const auto [minValue, maxValue] = std::minmax_element(values.begin(), values.end());
+			baked.QuantizedBase = *minValue;
+			baked.QuantizedScale = (*maxValue - *minValue) / static_cast<f32>(std::numeric_limits<u16>::max());
+
+			baked.QuantizedValues.reserve(values.size());
+			for (const f32 value : values)
+				baked.QuantizedValues.push_back((baked.QuantizedScale > 0.0f) ? static_cast<u16>(Round((value - baked.QuantizedBase) / baked.QuantizedScale)) : 0);
+		}
+		else
+		{
+			baked.Values = values;
+		}
+
+		if (values.size() > 1)
+		{
+			std::vector<f32> middleValues(values.size() - 1);
+			fcurve.SampleRange(startFrame + (settings.FrameStep * 0.5f), middleValues.size(), settings.FrameStep, middleValues.data());
+
+			for (size_t i = 0; i < values.size(); i++)
+			{
+				baked.MaxError = Max(baked.MaxError, Absolute(baked.GetValue(i) - values[i]));
+				if (i < middleValues.size())
+					baked.MaxError = Max(baked.MaxError, Absolute(((baked.GetValue(i) + baked.GetValue(i + 1)) * 0.5f) - middleValues[i]));
+			}
+		}
+
+		return baked;
+	}
+
+	size_t BakedLayerVideo::GetByteSize() const
+	{
+		size_t byteSize = 0;
+		for (const auto& baked : Transform)
+			byteSize += baked.GetByteSize();
+		for (const auto& baked : Transform3D)
+			byteSize += baked.GetByteSize();
+		return byteSize;
+	}
+
+	f32 BakedLayerVideo::GetMaxError() const
+	{
+		f32 maxError = 0.0f;
+		for (const auto& baked : Transform)
+			maxError = Max(maxError, baked.MaxError);
+		for (const auto& baked : Transform3D)
+			maxError = Max(maxError, baked.MaxError);
+		return maxError;
+	}
+
+	size_t BakedScene::GetByteSize() const
+	{
+		size_t byteSize = 0;
+		for (const auto& [layer, baked] : LayerVideos)
+			byteSize += baked.GetByteSize();
+		return byteSize;
+	}
+
+	f32 BakedScene::GetMaxError() const
+	{
+		f32 maxError = 0.0f;
+		for (const auto& [layer, baked] : LayerVideos)
+			maxError = Max(maxError, baked.GetMaxError());
+		return maxError;
+	}
+
+	namespace
+	{
+		struct FCurveBakeJob
+		{
+			const FCurve* Source;
+			frame_t StartFrame, EndFrame;
+			BakedFCurve* OutBaked;
+		};
+
+		void AddLayerVideoBakeJobs(const LayerVideo& layerVideo, frame_t startFrame, frame_t endFrame, BakedLayerVideo& outBaked, std::vector<FCurveBakeJob>& outJobs)
+		{
+			for (Transform2DField field = 0; field < Transform2DField_Count; field++)
+				outJobs.push_back({ &layerVideo.Transform[field], startFrame, endFrame, &outBaked.Transform[field] });
+
+			if (layerVideo.Transform3D == nullptr)
+				return;
+
+			outBaked.Transform3D.resize(LayerVideo3D::CurveCount);
+			for (size_t i = 0; i < LayerVideo3D::CurveCount; i++)
+				outJobs.push_back({ &(*layerVideo.Transform3D)[i], startFrame, endFrame, &outBaked.Transform3D[i] });
+		}
+
+		void RunBakeJobs(const std::vector<FCurveBakeJob>& jobs, const FCurveBakeSettings& settings)
+		{
+			ParallelFor(jobs.size(), jobs.size(), 1, [&](size_t jobIndex)
+			{
+				const auto& job = jobs[jobIndex];
+				*job.OutBaked = BakeFCurve(*job.Source, job.StartFrame, job.EndFrame, settings);
+			});
+		}
+	}
+
+	BakedLayerVideo BakeLayerVideo(const LayerVideo& layerVideo, frame_t startFrame, frame_t endFrame, const FCurveBakeSettings& settings)
+	{
+		BakedLayerVideo baked;
+		std::vector<FCurveBakeJob> jobs;
+		AddLayerVideoBakeJobs(layerVideo, startFrame, endFrame, baked, jobs);
+		RunBakeJobs(jobs, settings);
+		return baked;
+	}
+
+	BakedScene BakeScene(const Scene& scene, const FCurveBakeSettings& settings)
+	{
+		BakedScene baked;
+		std::vector<FCurveBakeJob> jobs;
+
+		// NOTE: References to unordered_map elements remain valid while inserting so the jobs can point directly into the final map
+		scene.ForEachComp([&](const auto& comp)
+		{
+			if (comp == nullptr)
+				return;
+
+			for (const auto& layer : comp->Layers)
+			{
+				if (layer->LayerVideo != nullptr && baked.LayerVideos.find(layer.get()) == baked.LayerVideos.end())
+					AddLayerVideoBakeJobs(*layer->LayerVideo, layer->StartFrame, layer->EndFrame, baked.LayerVideos[layer.get()], jobs);
+			}
+		});
+
+		RunBakeJobs(jobs, settings);
+		return baked;
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "core_types.h"
+#include "file_format_aet_set.h"
+#include <array>
+#include <unordered_map>
+
+namespace Comfy::Aet
+{
+	// NOTE: Removes all key frames which can be recovered within the absolute value tolerance by interpolating between the remaining key frames.
+	//		 Where the original tangent of a remaining key frame no longer fits the longer curve section it is refitted using least squares.
+	//		 The reduced curve is checked against the original one at every original key frame and in between each pair of them.
+	//		 Key frames sharing the same frame (= hold steps) are always kept. Returns the number of removed key frames
+	size_t ReduceFCurveKeyFrames(FCurve& fcurve, f32 tolerance);
+
+	// NOTE: Fits a Hermite curve to dense samples taken at (startFrame + i * step) for a positive step, such as per frame values of an expression driven property.
+	//		 Key frames are placed on samples, starting with the first and last one and repeatedly adding the worst fitting sample of each section until all samples
+	//		 are within maxError, followed by removing each added key frame again for as long as the fit stays within maxError.
+	//		 The tangents of all key frames are solved for together in the least squares sense after each step
+	FCurve FitFCurveToSamples(const f32* samples, size_t sampleCount, frame_t startFrame, frame_t step, f32 maxError);
+
+	struct FCurveFitJob
+	{
+		std::vector<f32> Samples;
+		frame_t StartFrame;
+		frame_t Step;
+		f32 MaxError;
+		FCurve* OutFCurve;
+	};
+
+	// NOTE: Runs FitFCurveToSamples() for each job, handing them out to a fixed number of worker threads depending on the total sample count.
+	//		 Small batches are fitted on the calling thread alone
+	void FitFCurvesToSamples(const std::vector<FCurveFitJob>& jobs);
+
+	// NOTE: Smallest and largest value (as x and y) the curve takes on anywhere within the inclusive frame range,
+	//		 found analytically from the key values, the range end points and the extrema of each Hermite section in between
+	vec2 GetFCurveValueRange(const FCurve& fcurve, frame_t startFrame, frame_t endFrame);
+
+	struct FCurveBakeSettings
+	{
+		// NOTE: Distance between samples, use values below one frame for sub-frame accuracy
+		frame_t FrameStep = 1.0f;
+		// NOTE: Store the samples as 16-bit fractions of the value range of the curve, halving the size at the cost of (range / 65535 / 2) additional error
+		b8 Quantize16Bit = false;
+	};
+
+	// NOTE: Uniformly sampled copy of a curve turning each sample into a single indexed load plus a linear interpolation.
+	//		 Frames outside the baked range are clamped the same way FCurve sampling clamps frames outside its key frames
+	struct BakedFCurve
+	{
+		frame_t StartFrame = 0.0f;
+		frame_t InverseFrameStep = 1.0f;
+		std::vector<f32> Values;
+		std::vector<u16> QuantizedValues;
+		f32 QuantizedBase = 0.0f;
+		f32 QuantizedScale = 0.0f;
+		// NOTE: Largest difference to the source curve measured at each sample and in between each pair of them
+		f32 MaxError = 0.0f;
+
+		inline size_t GetSampleCount() const { return Values.empty() ? QuantizedValues.size() : Values.size(); }
+		inline size_t GetByteSize() const { return (Values.size() * sizeof(f32)) + (QuantizedValues.size() * sizeof(u16)); }
+		inline f32 GetValue(size_t index) const { return Values.empty() ? (QuantizedBase + (static_cast<f32>(QuantizedValues[index]) * QuantizedScale)) : Values[index]; }
+
+		inline f32 SampleAt(frame_t frame) const
+		{
+			const size_t sampleCount = GetSampleCount();
+			if (sampleCount <= 1)
+				return (sampleCount == 1) ? GetValue(0) : 0.0f;
+
+			const f32 position = Clamp((frame - StartFrame) * InverseFrameStep, 0.0f, static_cast<f32>(sampleCount - 1));
+			const size_t index = Min(static_cast<size_t>(position), sampleCount - 2);
+			const f32 fraction = (position - static_cast<f32>(index));
+			return GetValue(index) + ((GetValue(index + 1) - GetValue(index)) * fraction);
+		}
+	};
+
+	// NOTE: Bakes the frame range of the curve, constant curves only ever store a single sample
+	BakedFCurve BakeFCurve(const FCurve& fcurve, frame_t startFrame, frame_t endFrame, const FCurveBakeSettings& settings);
+
+	struct BakedLayerVideo
+	{
+		std::array<BakedFCurve, Transform2DField_Count> Transform;
+		// NOTE: Only baked for layers with a LayerVideo3D, in the same order as LayerVideo3D::operator[]
+		std::vector<BakedFCurve> Transform3D;
+
+		size_t GetByteSize() const;
+		f32 GetMaxError() const;
+	};
+
+	struct BakedScene
+	{
+		// NOTE: Each layer baked over its own StartFrame to EndFrame range which its key frames are relative to
+		std::unordered_map<const Layer*, BakedLayerVideo> LayerVideos;
+
+		inline const BakedLayerVideo* FindLayerVideo(const Layer& layer) const { auto found = LayerVideos.find(&layer); return (found != LayerVideos.end()) ? &found->second : nullptr; }
+
+		size_t GetByteSize() const;
+		f32 GetMaxError() const;
+	};
+
+	// NOTE: Bakes all curves of the layer video using multiple threads
+	BakedLayerVideo BakeLayerVideo(const LayerVideo& layerVideo, frame_t startFrame, frame_t endFrame, const FCurveBakeSettings& settings);
+	// NOTE: Bakes the LayerVideo of every layer in the scene, distributing all of their curves across multiple threads
+	BakedScene BakeScene(const Scene& scene, const FCurveBakeSettings& settings);
+}
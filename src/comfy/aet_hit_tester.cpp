@@ -0,0 +1,191 @@
+#include "aet_hit_tester.h"
+#include "core_string.h"
+#include <algorithm>
+
+namespace Comfy::Aet
+{
+	namespace
+	{
+		constexpr f32 MinDeterminant = 0.000001f;
+
+		b8 RegionContainsPoint(const AffineTransform2D& sceneToLocal, vec2 size, vec2 point, vec2& outLocalPoint)
+		{
+			outLocalPoint = sceneToLocal.TransformPoint(point);
+			return (outLocalPoint.x >= 0.0f && outLocalPoint.y >= 0.0f && outLocalPoint.x < size.x && outLocalPoint.y < size.y);
+		}
+
+		b8 BoundsContainPoint(vec2 min, vec2 max, vec2 point)
+		{
+			return (point.x >= min.x && point.y >= min.y && point.x <= max.x && point.y <= max.y);
+		}
+	}
+
+	SceneHitTester::SceneHitTester(const Scene& scene) : evaluator(scene)
+	{
+	}
+
+	void SceneHitTester::Update(frame_t frame)
+	{
+		this->frame = frame;
+		evaluator.Settings.IncludeTransparentLayers = Settings.IncludeTransparentLayers;
+		evaluator.Evaluate(frame, evaluatedLayers);
+
+		regions.clear();
+		nodes.clear();
+
+		for (u32 drawIndex = 0; drawIndex < static_cast<u32>(evaluatedLayers.size()); drawIndex++)
+		{
+			const EvaluatedLayer& layer = evaluatedLayers[drawIndex];
+			if (!Settings.LayerNamePrefix.empty() && !ASCII::StartsWithInsensitive(layer.Layer->GetName(), Settings.LayerNamePrefix))
+				continue;
+
+			const vec2 size = vec2(layer.Video->Size);
+			if (size.x <= 0.0f || size.y <= 0.0f || Absolute(layer.Transform.GetDeterminant()) < MinDeterminant)
+				continue;
+
+			HitRegion& region = regions.emplace_back();
+			region.SceneToLocal = layer.Transform.GetInverse();
+			region.Size = size;
+			region.DrawIndex = drawIndex;
+
+			const vec2 corners[4] = { vec2(0.0f, 0.0f), vec2(size.x, 0.0f), vec2(0.0f, size.y), size };
+			region.Min = region.Max = layer.Transform.TransformPoint(corners[0]);
+			for (const vec2 corner : corners)
+			{
+				const vec2 sceneCorner = layer.Transform.TransformPoint(corner);
+				region.Min = Min(region.Min, sceneCorner);
+				region.Max = Max(region.Max, sceneCorner);
+			}
+		}
+
+		if (regions.empty())
+			return;
+
+		nodes.reserve(((regions.size() / MaxLeafRegionCount) + 1) * 2);
+		nodes.emplace_back();
+		BuildNode(0, 0, static_cast<u32>(regions.size()), 0);
+	}
+
+	void SceneHitTester::HitTest(vec2 point, std::vector<LayerHit>& outHits) const
+	{
+		outHits.clear();
+		if (nodes.empty())
+			return;
+
+		u32 nodeStack[MaxNodeDepth * 2];
+		u32 stackSize = 0;
+		nodeStack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const BVHNode& node = nodes[nodeStack[--stackSize]];
+			if (!BoundsContainPoint(node.Min, node.Max, point))
+				continue;
+
+			if (node.RegionCount == 0)
+			{
+				nodeStack[stackSize++] = node.FirstIndex;
+				nodeStack[stackSize++] = node.FirstIndex + 1;
+				continue;
+			}
+
+			for (u32 i = node.FirstIndex; i < node.FirstIndex + node.RegionCount; i++)
+			{
+				const HitRegion& region = regions[i];
+				vec2 localPoint;
+				if (BoundsContainPoint(region.Min, region.Max, point) && RegionContainsPoint(region.SceneToLocal, region.Size, point, localPoint))
+					outHits.push_back(LayerHit { evaluatedLayers[region.DrawIndex].Layer, region.DrawIndex, localPoint });
+			}
+		}
+
+		std::sort(outHits.begin(), outHits.end(), [](const LayerHit& a, const LayerHit& b) { return a.DrawIndex > b.DrawIndex; });
+	}
+
+	const Layer* SceneHitTester::HitTestTopmost(vec2 point) const
+	{
+		if (nodes.empty())
+			return nullptr;
+
+		const HitRegion* topmostRegion = nullptr;
+
+		u32 nodeStack[MaxNodeDepth * 2];
+		u32 stackSize = 0;
+		nodeStack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const BVHNode& node = nodes[nodeStack[--stackSize]];
+			if (topmostRegion != nullptr && node.MaxDrawIndex <= topmostRegion->DrawIndex)
+				continue;
+			if (!BoundsContainPoint(node.Min, node.Max, point))
+				continue;
+
+			if (node.RegionCount == 0)
+			{
+				// NOTE: Visit the child drawn further in front first to prune as much of the other one as possible
+				const b8 firstIsFront = (nodes[node.FirstIndex].MaxDrawIndex > nodes[node.FirstIndex + 1].MaxDrawIndex);
+				nodeStack[stackSize++] = firstIsFront ? (node.FirstIndex + 1) : node.FirstIndex;
+				nodeStack[stackSize++] = firstIsFront ? node.FirstIndex : (node.FirstIndex + 1);
+				continue;
+			}
+
+			for (u32 i = node.FirstIndex; i < node.FirstIndex + node.RegionCount; i++)
+			{
+				const HitRegion& region = regions[i];
+				if (topmostRegion != nullptr && region.DrawIndex <= topmostRegion->DrawIndex)
+					continue;
+
+				vec2 localPoint;
+				if (BoundsContainPoint(region.Min, region.Max, point) && RegionContainsPoint(region.SceneToLocal, region.Size, point, localPoint))
+					topmostRegion = &region;
+			}
+		}
+
+		return (topmostRegion != nullptr) ? evaluatedLayers[topmostRegion->DrawIndex].Layer : nullptr;
+	}
+
+	void SceneHitTester::BuildNode(u32 nodeIndex, u32 regionsBegin, u32 regionsEnd, u32 depth)
+	{
+		const u32 regionCount = (regionsEnd - regionsBegin);
+
+		vec2 min = regions[regionsBegin].Min, max = regions[regionsBegin].Max;
+		u32 maxDrawIndex = regions[regionsBegin].DrawIndex;
+		for (u32 i = regionsBegin + 1; i < regionsEnd; i++)
+		{
+			min = Min(min, regions[i].Min);
+			max = Max(max, regions[i].Max);
+			maxDrawIndex = Max(maxDrawIndex, regions[i].DrawIndex);
+		}
+
+		nodes[nodeIndex].Min = min;
+		nodes[nodeIndex].Max = max;
+		nodes[nodeIndex].MaxDrawIndex = maxDrawIndex;
+
+		// NOTE: The median split keeps the tree balanced so the depth can never realistically exceed the fixed size query stack
+		if (regionCount <= MaxLeafRegionCount || depth + 1 >= MaxNodeDepth)
+		{
+			nodes[nodeIndex].FirstIndex = regionsBegin;
+			nodes[nodeIndex].RegionCount = regionCount;
+			return;
+		}
+
+		const vec2 extent = (max - min);
+		const b8 splitX = (extent.x >= extent.y);
+		const u32 regionsMiddle = regionsBegin + (regionCount / 2);
+
+		std::nth_element(regions.begin() + regionsBegin, regions.begin() + regionsMiddle, regions.begin() + regionsEnd, [splitX](const HitRegion& a, const HitRegion& b)
+		{
+			return splitX ? ((a.Min.x + a.Max.x) < (b.Min.x + b.Max.x)) : ((a.Min.y + a.Max.y) < (b.Min.y + b.Max.y));
+		});
+
+		// NOTE: Both children are allocated together so that they always end up adjacent
+		const u32 firstChildIndex = static_cast<u32>(nodes.size());
+		nodes[nodeIndex].FirstIndex = firstChildIndex;
+		nodes[nodeIndex].RegionCount = 0;
+		nodes.emplace_back();
+		nodes.emplace_back();
+
+		BuildNode(firstChildIndex, regionsBegin, regionsMiddle, depth + 1);
+		BuildNode(firstChildIndex + 1, regionsMiddle, regionsEnd, depth + 1);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "core_types.h"
+#include "aet_scene_evaluator.h"
+
+namespace Comfy::Aet
+{
+	struct LayerHit
+	{
+		const Layer* Layer;
+		// NOTE: Index into the back to front draw order of the updated frame
+		u32 DrawIndex;
+		// NOTE: Hit position in video space (0,0 to Video->Size)
+		vec2 LocalPoint;
+	};
+
+	// NOTE: Resolves which layers of a scene cover a given scene space point, for example to map input onto "p_*" touch area layers.
+	//		 Each update evaluates the full parent / composition chain once and builds a bounding volume hierarchy over the scene space bounds of all matching video quads,
+	//		 queries then only run the exact (inverse transformed) rectangle test for the few quads whose bounds contain the point.
+	//		 Same as the evaluator the scene structure must not be modified for the lifetime of the hit tester. Queries are const and may run concurrently
+	struct SceneHitTester : NonCopyable
+	{
+		explicit SceneHitTester(const Scene& scene);
+		~SceneHitTester() = default;
+
+		struct SettingsData
+		{
+			// NOTE: Only layers whose name starts with this prefix (case insensitive) are hit tested, all video layers if empty
+			std::string LayerNamePrefix = {};
+			// NOTE: Touch areas are commonly fully transparent so these are included by default
+			b8 IncludeTransparentLayers = true;
+		} Settings;
+
+		// NOTE: Evaluates the scene at the input frame and rebuilds the hierarchy, must be called before querying and again after changing the settings
+		void Update(frame_t frame);
+
+		// NOTE: Replaces the content of outHits with all layers whose transformed quad contains the scene space point, in front to back order
+		void HitTest(vec2 point, std::vector<LayerHit>& outHits) const;
+		// NOTE: Front most layer whose transformed quad contains the scene space point or null
+		const Layer* HitTestTopmost(vec2 point) const;
+
+		inline const Scene& GetScene() const { return evaluator.GetScene(); }
+		inline frame_t GetFrame() const { return frame; }
+		inline const std::vector<EvaluatedLayer>& GetEvaluatedLayers() const { return evaluatedLayers; }
+
+	private:
+		static constexpr u32 MaxLeafRegionCount = 4;
+		static constexpr u32 MaxNodeDepth = 64;
+
+		struct HitRegion
+		{
+			AffineTransform2D SceneToLocal;
+			vec2 Size;
+			vec2 Min, Max;
+			u32 DrawIndex;
+		};
+
+		struct BVHNode
+		{
+			vec2 Min, Max;
+			// NOTE: Used to skip subtrees that can't contain a hit in front of the current one
+			u32 MaxDrawIndex;
+			// NOTE: Regions of leaf nodes or the first of two adjacent child nodes for inner nodes (RegionCount of zero)
+			u32 FirstIndex;
+			u32 RegionCount;
+		};
+
+		void BuildNode(u32 nodeIndex, u32 regionsBegin, u32 regionsEnd, u32 depth);
+
+		SceneEvaluator evaluator;
+		frame_t frame = 0.0f;
+		std::vector<EvaluatedLayer> evaluatedLayers;
+		std::vector<HitRegion> regions;
+		std::vector<BVHNode> nodes;
+	};
+}
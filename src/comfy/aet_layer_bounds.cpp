@@ -0,0 +1,344 @@
+#include "aet_layer_bounds.h"
+#include "aet_fcurve_util.h"
+#include <algorithm>
+
+namespace Comfy::Aet
+{
+	namespace
+	{
+		struct Interval
+		{
+			f32 Min, Max;
+		};
+
+		Interval Add(Interval a, Interval b) { return Interval { a.Min + b.Min, a.Max + b.Max }; }
+		Interval Subtract(Interval a, Interval b) { return Interval { a.Min - b.Max, a.Max - b.Min }; }
+
+		Interval Multiply(Interval a, Interval b)
+		{
+			const f32 products[4] = { (a.Min * b.Min), (a.Min * b.Max), (a.Max * b.Min), (a.Max * b.Max) };
+			return Interval { Min(Min(products[0], products[1]), Min(products[2], products[3])), Max(Max(products[0], products[1]), Max(products[2], products[3])) };
+		}
+
+		f32 GetMaxSquare(Interval value) { return Max(value.Min * value.Min, value.Max * value.Max); }
+
+		Interval GetFCurveInterval(const FCurve& fcurve, frame_t startFrame, frame_t endFrame)
+		{
+			const vec2 range = GetFCurveValueRange(fcurve, startFrame, endFrame);
+			return Interval { range.x, range.y };
+		}
+
+		b8 ContainsPeriodicDegrees(Interval degrees, f32 periodicDegrees)
+		{
+			return Ceil((degrees.Min - periodicDegrees) / 360.0f) <= Floor((degrees.Max - periodicDegrees) / 360.0f);
+		}
+
+		void GetSinCosIntervals(Interval degrees, Interval& outSin, Interval& outCos)
+		{
+			if ((degrees.Max - degrees.Min) >= 360.0f)
+			{
+				outSin = outCos = Interval { -1.0f, 1.0f };
+				return;
+			}
+
+			const f32 startSin = Sin(Angle::FromDegrees(degrees.Min)), endSin = Sin(Angle::FromDegrees(degrees.Max));
+			const f32 startCos = Cos(Angle::FromDegrees(degrees.Min)), endCos = Cos(Angle::FromDegrees(degrees.Max));
+			outSin = Interval { Min(startSin, endSin), Max(startSin, endSin) };
+			outCos = Interval { Min(startCos, endCos), Max(startCos, endCos) };
+
+			if (ContainsPeriodicDegrees(degrees, 90.0f)) outSin.Max = 1.0f;
+			if (ContainsPeriodicDegrees(degrees, 270.0f)) outSin.Min = -1.0f;
+			if (ContainsPeriodicDegrees(degrees, 0.0f)) outCos.Max = 1.0f;
+			if (ContainsPeriodicDegrees(degrees, 180.0f)) outCos.Min = -1.0f;
+		}
+
+		Rect CombineBounds(const Rect& a, const Rect& b)
+		{
+			return Rect(Min(a.TL, b.TL), Max(a.BR, b.BR));
+		}
+
+		b8 AreBoundsEqual(const Rect& a, const Rect& b)
+		{
+			return (a.TL.x == b.TL.x && a.TL.y == b.TL.y && a.BR.x == b.BR.x && a.BR.y == b.BR.y);
+		}
+
+		// NOTE: Bounds of the local rect transformed by the layer video at any frame within the inclusive range, see ComputeLayerTransform() of the SceneEvaluator
+		Rect TransformBounds(const LayerVideo* layerVideo, frame_t startFrame, frame_t endFrame, const Rect& localBounds)
+		{
+			if (layerVideo == nullptr)
+				return localBounds;
+
+			const LayerVideo2D& transform = layerVideo->Transform;
+			const Interval positionX = GetFCurveInterval(transform.Position.X, startFrame, endFrame);
+			const Interval positionY = GetFCurveInterval(transform.Position.Y, startFrame, endFrame);
+
+			const Interval offsetX = Subtract(Interval { localBounds.TL.x, localBounds.BR.x }, GetFCurveInterval(transform.Origin.X, startFrame, endFrame));
+			const Interval offsetY = Subtract(Interval { localBounds.TL.y, localBounds.BR.y }, GetFCurveInterval(transform.Origin.Y, startFrame, endFrame));
+			const Interval scaledX = Multiply(offsetX, GetFCurveInterval(transform.Scale.X, startFrame, endFrame));
+			const Interval scaledY = Multiply(offsetY, GetFCurveInterval(transform.Scale.Y, startFrame, endFrame));
+
+			if (layerVideo->Transform3D != nullptr)
+			{
+				// NOTE: Rotating in 3D followed by dropping Z can only shorten the scaled offset to the origin
+				const LayerVideo3D& transform3D = *layerVideo->Transform3D;
+				const Interval scaledZ = Multiply(GetFCurveInterval(transform3D.OriginZ, startFrame, endFrame), GetFCurveInterval(transform3D.ScaleZ, startFrame, endFrame));
+				const f32 radius = ::sqrtf(GetMaxSquare(scaledX) + GetMaxSquare(scaledY) + GetMaxSquare(scaledZ));
+				return Rect(vec2(positionX.Min - radius, positionY.Min - radius), vec2(positionX.Max + radius, positionY.Max + radius));
+			}
+
+			Interval sin, cos;
+			GetSinCosIntervals(GetFCurveInterval(transform.Rotation, startFrame, endFrame), sin, cos);
+			const Interval rotatedX = Subtract(Multiply(cos, scaledX), Multiply(sin, scaledY));
+			const Interval rotatedY = Add(Multiply(sin, scaledX), Multiply(cos, scaledY));
+
+			// NOTE: The interval product overestimates wide rotation ranges, which can't move any point further than its scaled offset length either
+			const f32 radius = ::sqrtf(GetMaxSquare(scaledX) + GetMaxSquare(scaledY));
+			return Rect(
+				vec2(positionX.Min + Max(rotatedX.Min, -radius), positionY.Min + Max(rotatedY.Min, -radius)),
+				vec2(positionX.Max + Min(rotatedX.Max, radius), positionY.Max + Min(rotatedY.Max, radius)));
+		}
+
+		void AddSegmentFrames(const LayerVideo* layerVideo, frame_t startFrame, frame_t endFrame, std::vector<frame_t>& outFrames)
+		{
+			if (layerVideo == nullptr)
+				return;
+
+			const auto addKeyFrames = [&](const FCurve& fcurve)
+			{
+				for (const KeyFrame& key : fcurve.Keys)
+				{
+					if (key.Frame > startFrame && key.Frame < endFrame)
+						outFrames.push_back(key.Frame);
+				}
+			};
+
+			for (Transform2DField field = 0; field < Transform2DField_Count; field++)
+			{
+				if (field != Transform2DField_Opacity)
+					addKeyFrames(layerVideo->Transform[field]);
+			}
+
+			if (layerVideo->Transform3D != nullptr)
+			{
+				addKeyFrames(layerVideo->Transform3D->OriginZ);
+				addKeyFrames(layerVideo->Transform3D->ScaleZ);
+			}
+		}
+
+		struct SceneLayerBoundsBuilder
+		{
+			SceneLayerBounds& Result;
+			std::vector<const Composition*> CompStack;
+
+			const LayerBounds& AddCompositionBounds(const Composition& comp)
+			{
+				if (const auto found = Result.Compositions.find(&comp); found != Result.Compositions.end())
+					return found->second;
+
+				CompStack.push_back(&comp);
+				const std::vector<u32> refParents = FindEffectiveRefParents(comp);
+
+				LayerBounds compBounds;
+				std::vector<const LayerVideo*> refParentVideos;
+
+				for (u32 i = 0; i < static_cast<u32>(comp.Layers.size()); i++)
+				{
+					refParentVideos.clear();
+					for (u32 refParent = refParents[i]; refParent != InvalidIndex; refParent = refParents[refParent])
+						refParentVideos.push_back(comp.Layers[refParent]->LayerVideo.get());
+
+					const Layer& layer = *comp.Layers[i];
+					LayerBounds& layerBounds = Result.Layers[&layer];
+					layerBounds = ComputeLayerBounds(layer, refParentVideos);
+					compBounds.Segments.insert(compBounds.Segments.end(), layerBounds.Segments.begin(), layerBounds.Segments.end());
+				}
+
+				std::stable_sort(compBounds.Segments.begin(), compBounds.Segments.end(), [](const LayerBoundsSegment& a, const LayerBoundsSegment& b) { return a.StartFrame < b.StartFrame; });
+				UpdateTotalBounds(compBounds);
+
+				CompStack.pop_back();
+				return (Result.Compositions[&comp] = std::move(compBounds));
+			}
+
+		private:
+			static constexpr u32 InvalidIndex = 0xFFFFFFFF;
+
+			// NOTE: Reference parents of the same composition with cycles broken in the same order as the SceneEvaluator
+			std::vector<u32> FindEffectiveRefParents(const Composition& comp) const
+			{
+				const u32 layerCount = static_cast<u32>(comp.Layers.size());
+				std::vector<u32> refParents(layerCount, InvalidIndex);
+
+				for (u32 i = 0; i < layerCount; i++)
+				{
+					const Layer* refParentLayer = comp.Layers[i]->GetRefParentLayer().get();
+					if (refParentLayer == nullptr)
+						continue;
+
+					for (u32 j = 0; j < layerCount; j++)
+					{
+						if (i != j && comp.Layers[j].get() == refParentLayer)
+						{
+							refParents[i] = j;
+							break;
+						}
+					}
+				}
+
+				enum class VisitState : u8 { Unvisited, Visiting, Visited };
+				std::vector<VisitState> visitStates(layerCount, VisitState::Unvisited);
+
+				const auto visit = [&](const auto& visit, u32 index) -> void
+				{
+					if (visitStates[index] != VisitState::Unvisited)
+						return;
+
+					visitStates[index] = VisitState::Visiting;
+					if (const u32 refParent = refParents[index]; refParent != InvalidIndex)
+					{
+						if (visitStates[refParent] == VisitState::Visiting)
+							refParents[index] = InvalidIndex;
+						else
+							visit(visit, refParent);
+					}
+					visitStates[index] = VisitState::Visited;
+				};
+
+				for (u32 i = 0; i < layerCount; i++)
+					visit(visit, i);
+
+				return refParents;
+			}
+
+			LayerBounds ComputeLayerBounds(const Layer& layer, const std::vector<const LayerVideo*>& refParentVideos)
+			{
+				LayerBounds result;
+				if (!layer.GetIsVisible() || layer.StartFrame >= layer.EndFrame)
+					return result;
+
+				const LayerBounds* compBounds = nullptr;
+				Rect videoBounds;
+
+				if (layer.ItemType == ItemType::Video && layer.GetVideoItem() != nullptr)
+				{
+					videoBounds = Rect(vec2(0.0f, 0.0f), vec2(layer.GetVideoItem()->Size));
+				}
+				else if (layer.ItemType == ItemType::Composition && layer.GetCompItem() != nullptr)
+				{
+					const Composition* compItem = layer.GetCompItem();
+					if (std::find(CompStack.begin(), CompStack.end(), compItem) != CompStack.end())
+						return result;
+
+					compBounds = &AddCompositionBounds(*compItem);
+					if (compBounds->IsEmpty())
+						return result;
+				}
+				else
+				{
+					return result;
+				}
+
+				std::vector<frame_t> segmentFrames = { layer.StartFrame, layer.EndFrame };
+				AddSegmentFrames(layer.LayerVideo.get(), layer.StartFrame, layer.EndFrame, segmentFrames);
+				for (const LayerVideo* refParentVideo : refParentVideos)
+					AddSegmentFrames(refParentVideo, layer.StartFrame, layer.EndFrame, segmentFrames);
+
+				std::sort(segmentFrames.begin(), segmentFrames.end());
+				segmentFrames.erase(std::unique(segmentFrames.begin(), segmentFrames.end()), segmentFrames.end());
+
+				for (size_t i = 1; i < segmentFrames.size(); i++)
+				{
+					const frame_t startFrame = segmentFrames[i - 1], endFrame = segmentFrames[i];
+
+					Rect bounds = videoBounds;
+					if (compBounds != nullptr)
+					{
+						// NOTE: Same time remapping as the SceneEvaluator, the item time runs backwards for negative time scales
+						const frame_t startItemFrame = ((startFrame - layer.StartFrame) * layer.TimeScale) + layer.StartOffset;
+						const frame_t endItemFrame = ((endFrame - layer.StartFrame) * layer.TimeScale) + layer.StartOffset;
+						if (!compBounds->TryGetBounds(Min(startItemFrame, endItemFrame), Max(startItemFrame, endItemFrame), bounds))
+							continue;
+					}
+
+					bounds = TransformBounds(layer.LayerVideo.get(), startFrame, endFrame, bounds);
+					for (const LayerVideo* refParentVideo : refParentVideos)
+						bounds = TransformBounds(refParentVideo, startFrame, endFrame, bounds);
+
+					if (!result.Segments.empty())
+					{
+						LayerBoundsSegment& lastSegment = result.Segments.back();
+						if (lastSegment.EndFrame == startFrame && AreBoundsEqual(lastSegment.Bounds, bounds))
+						{
+							lastSegment.EndFrame = endFrame;
+							continue;
+						}
+					}
+
+					result.Segments.push_back(LayerBoundsSegment { startFrame, endFrame, bounds });
+				}
+
+				UpdateTotalBounds(result);
+				return result;
+			}
+
+			static void UpdateTotalBounds(LayerBounds& bounds)
+			{
+				if (bounds.Segments.empty())
+					return;
+
+				bounds.TotalBounds = bounds.Segments.front().Bounds;
+				for (const LayerBoundsSegment& segment : bounds.Segments)
+					bounds.TotalBounds = CombineBounds(bounds.TotalBounds, segment.Bounds);
+			}
+		};
+	}
+
+	b8 LayerBounds::TryGetBounds(frame_t startFrame, frame_t endFrame, Rect& outBounds) const
+	{
+		b8 anyOverlapping = false;
+		for (const LayerBoundsSegment& segment : Segments)
+		{
+			if (segment.StartFrame > endFrame)
+				break;
+			if (segment.EndFrame <= startFrame)
+				continue;
+
+			outBounds = anyOverlapping ? CombineBounds(outBounds, segment.Bounds) : segment.Bounds;
+			anyOverlapping = true;
+		}
+		return anyOverlapping;
+	}
+
+	b8 LayerBounds::MayIntersect(const Rect& viewport, frame_t startFrame, frame_t endFrame) const
+	{
+		if (Segments.empty() || !TotalBounds.Overlaps(viewport))
+			return false;
+
+		for (const LayerBoundsSegment& segment : Segments)
+		{
+			if (segment.StartFrame > endFrame)
+				break;
+			if (segment.EndFrame > startFrame && segment.Bounds.Overlaps(viewport))
+				return true;
+		}
+		return false;
+	}
+
+	SceneLayerBounds ComputeSceneLayerBounds(const Scene& scene)
+	{
+		SceneLayerBounds result;
+		SceneLayerBoundsBuilder builder { result };
+
+		// NOTE: Starting with the root composition so that recursive references are resolved from the top the same way the SceneEvaluator sees them
+		if (scene.RootComposition != nullptr)
+			builder.AddCompositionBounds(*scene.RootComposition);
+
+		for (const auto& comp : scene.Compositions)
+		{
+			if (comp != nullptr)
+				builder.AddCompositionBounds(*comp);
+		}
+
+		return result;
+	}
+}
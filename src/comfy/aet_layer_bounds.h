@@ -0,0 +1,48 @@
+#pragma once
+#include "core_types.h"
+#include "file_format_aet_set.h"
+#include <unordered_map>
+
+namespace Comfy::Aet
+{
+	struct LayerBoundsSegment
+	{
+		// NOTE: Frame range in the time of the containing composition, inclusive start and exclusive end same as the layer itself
+		frame_t StartFrame, EndFrame;
+		// NOTE: Axis aligned with TL as the min and BR as the max corner
+		Rect Bounds;
+	};
+
+	struct LayerBounds
+	{
+		// NOTE: Sorted by StartFrame, may overlap for compositions which combine the segments of all of their layers
+		std::vector<LayerBoundsSegment> Segments;
+		// NOTE: Union of all segments, only valid if not empty
+		Rect TotalBounds;
+
+		inline b8 IsEmpty() const { return Segments.empty(); }
+
+		// NOTE: Union of all segments overlapping the inclusive frame range, returns false if none do
+		b8 TryGetBounds(frame_t startFrame, frame_t endFrame, Rect& outBounds) const;
+		// NOTE: False if the layer is guaranteed to stay outside of the viewport for the entire inclusive frame range
+		b8 MayIntersect(const Rect& viewport, frame_t startFrame, frame_t endFrame) const;
+	};
+
+	// NOTE: Conservative screen space area each layer can cover over time, without sampling any individual frames.
+	//		 Layers are split into segments between the key frames of their transform curves. For each segment the value range of every curve is found analytically
+	//		 and used to bound the layer quad (the video size or the composition content) through its transform and all of its reference parents.
+	//		 Bounds are in the space and time of the containing composition so root composition layers are in scene space. Composition layers include
+	//		 the bounds of all layers of their composition over the remapped item time, so a consumer skipping a composition layer can skip its entire subtree.
+	//		 3D layers are bounded by the length of their scaled quad around the position as the orthographic projection can't make it any longer
+	struct SceneLayerBounds
+	{
+		std::unordered_map<const Layer*, LayerBounds> Layers;
+		std::unordered_map<const Composition*, LayerBounds> Compositions;
+
+		inline const LayerBounds* FindLayerBounds(const Layer& layer) const { auto found = Layers.find(&layer); return (found != Layers.end()) ? &found->second : nullptr; }
+		inline const LayerBounds* FindCompositionBounds(const Composition& comp) const { auto found = Compositions.find(&comp); return (found != Compositions.end()) ? &found->second : nullptr; }
+	};
+
+	// NOTE: Hidden layers and layers without a video or composition item have empty bounds. Recursive composition references are ignored, same as the SceneEvaluator
+	SceneLayerBounds ComputeSceneLayerBounds(const Scene& scene);
+}
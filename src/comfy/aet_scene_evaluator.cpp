@@ -0,0 +1,242 @@
+#include "aet_scene_evaluator.h"
+#include <algorithm>
+
+namespace Comfy::Aet
+{
+	static mat3 Multiply(const mat3& a, const mat3& b)
+	{
+		mat3 result;
+		for (size_t row = 0; row < 3; row++)
+		{
+			for (size_t column = 0; column < 3; column++)
+				result[row][column] = (a[row][0] * b[0][column]) + (a[row][1] * b[1][column]) + (a[row][2] * b[2][column]);
+		}
+		return result;
+	}
+
+	static mat3 RotationX(Angle angle) { const f32 s = Sin(angle), c = Cos(angle); return mat3 { vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, c, -s), vec3(0.0f, s, c) }; }
+	static mat3 RotationY(Angle angle) { const f32 s = Sin(angle), c = Cos(angle); return mat3 { vec3(c, 0.0f, s), vec3(0.0f, 1.0f, 0.0f), vec3(-s, 0.0f, c) }; }
+	static mat3 RotationZ(Angle angle) { const f32 s = Sin(angle), c = Cos(angle); return mat3 { vec3(c, -s, 0.0f), vec3(s, c, 0.0f), vec3(0.0f, 0.0f, 1.0f) }; }
+
+	static AffineTransform2D ComputeLayerTransform(const LayerVideo& layerVideo, frame_t frame, FCurveCursor* cursors, f32& outOpacity)
+	{
+		const LayerVideo2D& transform = layerVideo.Transform;
+		f32 values[Transform2DField_Count];
+		for (Transform2DField field = 0; field < Transform2DField_Count; field++)
+			values[field] = transform[field].SampleAt(frame, cursors[field]);
+
+		const vec2 origin = vec2(values[Transform2DField_OriginX], values[Transform2DField_OriginY]);
+		const vec2 position = vec2(values[Transform2DField_PositionX], values[Transform2DField_PositionY]);
+		const vec2 scale = vec2(values[Transform2DField_ScaleX], values[Transform2DField_ScaleY]);
+		const Angle rotation = Angle::FromDegrees(values[Transform2DField_Rotation]);
+		outOpacity = values[Transform2DField_Opacity];
+
+		if (layerVideo.Transform3D == nullptr)
+		{
+			const f32 sin = Sin(rotation), cos = Cos(rotation);
+
+			AffineTransform2D result;
+			result.A = (cos * scale.x);
+			result.B = (sin * scale.x);
+			result.C = (-sin * scale.y);
+			result.D = (cos * scale.y);
+			result.E = position.x - ((result.A * origin.x) + (result.C * origin.y));
+			result.F = position.y - ((result.B * origin.x) + (result.D * origin.y));
+			return result;
+		}
+
+		const LayerVideo3D& transform3D = *layerVideo.Transform3D;
+		f32 values3D[LayerVideo3D::CurveCount];
+		for (size_t i = 0; i < LayerVideo3D::CurveCount; i++)
+			values3D[i] = transform3D[i].SampleAt(frame, cursors[Transform2DField_Count + i]);
+
+		const f32 originZ = values3D[0], scaleZ = values3D[7];
+		const vec3 direction = vec3(values3D[2], values3D[3], values3D[4]);
+		const vec2 rotationXY = vec2(values3D[5], values3D[6]);
+
+		// NOTE: Orientation followed by the X, Y and Z rotation, same as After Effects. The position Z doesn't affect the orthographic projection
+		const mat3 orientation = Multiply(RotationZ(Angle::FromDegrees(direction.z)), Multiply(RotationY(Angle::FromDegrees(direction.y)), RotationX(Angle::FromDegrees(direction.x))));
+		const mat3 rotationMatrix = Multiply(RotationZ(rotation), Multiply(RotationY(Angle::FromDegrees(rotationXY.y)), Multiply(RotationX(Angle::FromDegrees(rotationXY.x)), orientation)));
+		const mat3 linear = Multiply(rotationMatrix, mat3 { vec3(scale.x, 0.0f, 0.0f), vec3(0.0f, scale.y, 0.0f), vec3(0.0f, 0.0f, scaleZ) });
+
+		AffineTransform2D result;
+		result.A = linear[0][0];
+		result.B = linear[1][0];
+		result.C = linear[0][1];
+		result.D = linear[1][1];
+		result.E = position.x - ((linear[0][0] * origin.x) + (linear[0][1] * origin.y) + (linear[0][2] * originZ));
+		result.F = position.y - ((linear[1][0] * origin.x) + (linear[1][1] * origin.y) + (linear[1][2] * originZ));
+		return result;
+	}
+
+	SceneEvaluator::SceneEvaluator(const Scene& scene) : scene(scene)
+	{
+		if (scene.RootComposition == nullptr)
+			return;
+
+		std::vector<const Composition*> compStack = { scene.RootComposition.get() };
+		AddCompNodes(*scene.RootComposition, InvalidNode, compStack);
+		AddDrawOrder(0, static_cast<u32>(scene.RootComposition->Layers.size()));
+
+		nodeStates.resize(nodes.size());
+	}
+
+	void SceneEvaluator::Evaluate(frame_t frame, std::vector<EvaluatedLayer>& outLayers)
+	{
+		outLayers.clear();
+
+		for (const u32 nodeIndex : evaluationOrder)
+		{
+			LayerNode& node = nodes[nodeIndex];
+			LayerNodeState& state = nodeStates[nodeIndex];
+			const LayerNodeState* parentState = (node.Parent != InvalidNode) ? &nodeStates[node.Parent] : nullptr;
+
+			state.Active = false;
+			state.HasTransform = false;
+			if (parentState != nullptr && !parentState->Active)
+				continue;
+
+			const Layer& layer = *node.Layer;
+			const frame_t parentFrame = (parentState != nullptr) ? parentState->ItemFrame : frame;
+
+			state.Active = layer.GetIsVisible() && (parentFrame >= layer.StartFrame) && (parentFrame < layer.EndFrame);
+			if (!state.Active && !node.IsRefParent)
+				continue;
+
+			// NOTE: Transform key frames are stored in the time of the parent composition while the item itself runs on its own remapped time
+			state.ItemFrame = ((parentFrame - layer.StartFrame) * layer.TimeScale) + layer.StartOffset;
+
+			f32 opacity = 1.0f;
+			state.LocalTransform = (layer.LayerVideo != nullptr) ? ComputeLayerTransform(*layer.LayerVideo, parentFrame, node.Cursors, opacity) : AffineTransform2D {};
+
+			if (node.RefParent != InvalidNode && nodeStates[node.RefParent].HasTransform)
+				state.LocalTransform = (nodeStates[node.RefParent].LocalTransform * state.LocalTransform);
+
+			state.WorldTransform = (parentState != nullptr) ? (parentState->WorldTransform * state.LocalTransform) : state.LocalTransform;
+			state.Opacity = (parentState != nullptr) ? (parentState->Opacity * opacity) : opacity;
+			state.HasTransform = true;
+		}
+
+		for (const u32 nodeIndex : drawOrder)
+		{
+			const LayerNodeState& state = nodeStates[nodeIndex];
+			if (!state.Active || (state.Opacity <= 0.0f && !Settings.IncludeTransparentLayers))
+				continue;
+
+			const Layer& layer = *nodes[nodeIndex].Layer;
+			const Video* video = layer.GetVideoItem();
+			if (video == nullptr)
+				continue;
+
+			i32 sourceIndex = -1;
+			if (const i32 sourceCount = static_cast<i32>(video->Sources.size()); sourceCount == 1)
+				sourceIndex = 0;
+			else if (sourceCount > 1)
+				sourceIndex = Clamp(static_cast<i32>(Floor(state.ItemFrame * video->FilesPerFrame)), 0, sourceCount - 1);
+
+			EvaluatedLayer& evaluated = outLayers.emplace_back();
+			evaluated.Layer = &layer;
+			evaluated.Video = video;
+			evaluated.SourceIndex = sourceIndex;
+			evaluated.Transform = state.WorldTransform;
+			evaluated.Opacity = state.Opacity;
+			evaluated.BlendMode = (layer.LayerVideo != nullptr) ? layer.LayerVideo->TransferMode.BlendMode : BlendMode::Normal;
+			evaluated.ItemFrame = state.ItemFrame;
+		}
+	}
+
+	void SceneEvaluator::AddCompNodes(const Composition& comp, u32 parentNode, std::vector<const Composition*>& compStack)
+	{
+		const u32 childrenBegin = static_cast<u32>(nodes.size());
+		const u32 childrenCount = static_cast<u32>(comp.Layers.size());
+		const u32 childrenEnd = (childrenBegin + childrenCount);
+
+		if (parentNode != InvalidNode)
+		{
+			nodes[parentNode].ChildrenBegin = childrenBegin;
+			nodes[parentNode].ChildrenCount = childrenCount;
+		}
+
+		for (const auto& layer : comp.Layers)
+		{
+			LayerNode& node = nodes.emplace_back();
+			node.Layer = layer.get();
+			node.Parent = parentNode;
+			node.RefParent = InvalidNode;
+			node.ChildrenBegin = 0;
+			node.ChildrenCount = 0;
+			node.IsRefParent = false;
+		}
+
+		// NOTE: Reference parent layers are always part of the same composition
+		for (u32 i = childrenBegin; i < childrenEnd; i++)
+		{
+			const Layer* refParentLayer = nodes[i].Layer->GetRefParentLayer();
+			if (refParentLayer == nullptr)
+				continue;
+
+			for (u32 j = childrenBegin; j < childrenEnd; j++)
+			{
+				if (i != j && nodes[j].Layer == refParentLayer)
+				{
+					nodes[i].RefParent = j;
+					nodes[j].IsRefParent = true;
+					break;
+				}
+			}
+		}
+
+		// NOTE: Reference parents have to be evaluated before the layers referencing them, cyclic references are ignored
+		enum class VisitState : u8 { Unvisited, Visiting, Visited };
+		std::vector<VisitState> visitStates(childrenCount, VisitState::Unvisited);
+
+		const auto visit = [&](const auto& visit, u32 nodeIndex) -> void
+		{
+			if (visitStates[nodeIndex - childrenBegin] != VisitState::Unvisited)
+				return;
+
+			visitStates[nodeIndex - childrenBegin] = VisitState::Visiting;
+			if (const u32 refParent = nodes[nodeIndex].RefParent; refParent != InvalidNode)
+			{
+				if (visitStates[refParent - childrenBegin] == VisitState::Visiting)
+					nodes[nodeIndex].RefParent = InvalidNode;
+				else
+					visit(visit, refParent);
+			}
+
+			visitStates[nodeIndex - childrenBegin] = VisitState::Visited;
+			evaluationOrder.push_back(nodeIndex);
+		};
+
+		for (u32 i = childrenBegin; i < childrenEnd; i++)
+			visit(visit, i);
+
+		for (u32 i = childrenBegin; i < childrenEnd; i++)
+		{
+			const Layer& layer = *nodes[i].Layer;
+			if (layer.ItemType != ItemType::Composition)
+				continue;
+
+			const Composition* compItem = layer.GetCompItem();
+			if (compItem == nullptr || std::find(compStack.begin(), compStack.end(), compItem) != compStack.end())
+				continue;
+
+			compStack.push_back(compItem);
+			AddCompNodes(*compItem, i, compStack);
+			compStack.pop_back();
+		}
+	}
+
+	void SceneEvaluator::AddDrawOrder(u32 childrenBegin, u32 childrenCount)
+	{
+		// NOTE: The first layer of a composition is displayed on top
+		for (u32 i = childrenBegin + childrenCount; i-- > childrenBegin;)
+		{
+			const LayerNode& node = nodes[i];
+			if (node.Layer->ItemType == ItemType::Video)
+				drawOrder.push_back(i);
+			else if (node.Layer->ItemType == ItemType::Composition && node.ChildrenCount > 0)
+				AddDrawOrder(node.ChildrenBegin, node.ChildrenCount);
+		}
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "core_types.h"
+#include "file_format_aet_set.h"
+
+namespace Comfy::Aet
+{
+	// NOTE: 2D affine transform mapping a point to (A * x + C * y + E, B * x + D * y + F)
+	struct AffineTransform2D
+	{
+		f32 A = 1.0f, B = 0.0f;
+		f32 C = 0.0f, D = 1.0f;
+		f32 E = 0.0f, F = 0.0f;
+
+		inline vec2 TransformPoint(vec2 point) const { return vec2((A * point.x) + (C * point.y) + E, (B * point.x) + (D * point.y) + F); }
+		inline vec2 TransformVector(vec2 vector) const { return vec2((A * vector.x) + (C * vector.y), (B * vector.x) + (D * vector.y)); }
+		inline f32 GetDeterminant() const { return (A * D) - (B * C); }
+
+		// NOTE: Expects a non zero determinant
+		inline AffineTransform2D GetInverse() const
+		{
+			const f32 inverseDeterminant = (1.0f / GetDeterminant());
+			const f32 a = (D * inverseDeterminant), b = (-B * inverseDeterminant), c = (-C * inverseDeterminant), d = (A * inverseDeterminant);
+			return AffineTransform2D { a, b, c, d, -((a * E) + (c * F)), -((b * E) + (d * F)) };
+		}
+
+		// NOTE: Combined transform applying the right hand side first
+		inline AffineTransform2D operator*(const AffineTransform2D& other) const
+		{
+			return AffineTransform2D
+			{
+				(A * other.A) + (C * other.B), (B * other.A) + (D * other.B),
+				(A * other.C) + (C * other.D), (B * other.C) + (D * other.D),
+				(A * other.E) + (C * other.F) + E, (B * other.E) + (D * other.F) + F,
+			};
+		}
+	};
+
+	struct EvaluatedLayer
+	{
+		const Layer* Layer;
+		const Video* Video;
+		// NOTE: Index into the Video sources to be displayed or -1 for source-less (solid color) videos
+		i32 SourceIndex;
+		// NOTE: Maps from video space (0,0 to Video->Size) into scene space
+		AffineTransform2D Transform;
+		f32 Opacity;
+		BlendMode BlendMode;
+		// NOTE: Frame within the layer item after applying all parent composition time remapping
+		frame_t ItemFrame;
+	};
+
+	// NOTE: Computes where every visible video layer of a scene ends up at a given frame, flattening all nested composition layers.
+	//		 The layer instance tree, reference parent layers, evaluation order and composition time remapping are resolved once on construction,
+	//		 so the scene structure must not be modified for the lifetime of the evaluator (only the animation data may be).
+	//		 Child item time is mapped as ((parentFrame - StartFrame) * TimeScale + StartOffset) and 3D transforms are orthographically projected.
+	//		 Keeps sampling cursors per layer instance so evaluating consecutive frames is cheapest. Not thread safe, use one evaluator per thread
+	struct SceneEvaluator : NonCopyable
+	{
+		explicit SceneEvaluator(const Scene& scene);
+		~SceneEvaluator() = default;
+
+		struct SettingsData
+		{
+			// NOTE: Also output visible layers with a combined opacity of zero, such as invisible touch area placeholders
+			b8 IncludeTransparentLayers = false;
+		} Settings;
+
+		// NOTE: Replaces the content of outLayers with all visible video layers at the input scene frame, in back to front draw order
+		void Evaluate(frame_t frame, std::vector<EvaluatedLayer>& outLayers);
+
+		inline const Scene& GetScene() const { return scene; }
+		inline size_t GetLayerInstanceCount() const { return nodes.size(); }
+
+	private:
+		static constexpr size_t CursorCount = Transform2DField_Count + LayerVideo3D::CurveCount;
+		static constexpr u32 InvalidNode = 0xFFFFFFFF;
+
+		struct LayerNode
+		{
+			const Layer* Layer;
+			// NOTE: Composition layer instance containing this layer or InvalidNode for root composition layers
+			u32 Parent;
+			u32 RefParent;
+			u32 ChildrenBegin, ChildrenCount;
+			b8 IsRefParent;
+			FCurveCursor Cursors[CursorCount];
+		};
+
+		struct LayerNodeState
+		{
+			b8 Active;
+			b8 HasTransform;
+			frame_t ItemFrame;
+			f32 Opacity;
+			// NOTE: Including the transforms of all reference parent layers
+			AffineTransform2D LocalTransform;
+			AffineTransform2D WorldTransform;
+		};
+
+		void AddCompNodes(const Composition& comp, u32 parentNode, std::vector<const Composition*>& compStack);
+		void AddDrawOrder(u32 childrenBegin, u32 childrenCount);
+
+		const Scene& scene;
+		std::vector<LayerNode> nodes;
+		std::vector<LayerNodeState> nodeStates;
+		std::vector<u32> evaluationOrder;
+		std::vector<u32> drawOrder;
+	};
+}
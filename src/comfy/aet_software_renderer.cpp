@@ -0,0 +1,384 @@
+#include "aet_software_renderer.h"
+#include "texture_util.h"
+#include "core_string.h"
+#include <emmintrin.h>
+#include <future>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace Comfy::Aet
+{
+	namespace
+	{
+		constexpr u32 PackedAlphaMask = 0xFF000000;
+		// NOTE: Below this target size waking up the workers and synchronizing with them takes longer than rendering all tiles on the calling thread
+		constexpr i32 MinWorkerPixelCount = (256 * 256);
+
+		u32 PremultiplyRGBA(u32 rgba)
+		{
+			const u32 alpha = (rgba >> 24);
+			const u32 rb = ((((rgba & 0x00FF00FF) * alpha) + 0x00800080) >> 8) & 0x00FF00FF;
+			const u32 g = ((((rgba & 0x0000FF00) * alpha) + 0x00008000) >> 8) & 0x0000FF00;
+			return (rgba & PackedAlphaMask) | rb | g;
+		}
+
+		u32 LerpRGBA(u32 a, u32 b, u32 weight)
+		{
+			const u32 inverseWeight = (256 - weight);
+			const u32 rb = ((((a & 0x00FF00FF) * inverseWeight) + ((b & 0x00FF00FF) * weight)) >> 8) & 0x00FF00FF;
+			const u32 ga = (((((a >> 8) & 0x00FF00FF) * inverseWeight) + (((b >> 8) & 0x00FF00FF) * weight))) & 0xFF00FF00;
+			return rb | ga;
+		}
+
+		u32 SampleBilinear(const u32* texels, i32 stride, ivec2 offset, ivec2 size, vec2 position)
+		{
+			const f32 u = (position.x - 0.5f), v = (position.y - 0.5f);
+			const f32 floorU = Floor(u), floorV = Floor(v);
+			const u32 weightX = static_cast<u32>((u - floorU) * 256.0f), weightY = static_cast<u32>((v - floorV) * 256.0f);
+
+			// NOTE: Clamp to the sprite region itself to avoid bleeding in neighboring sprites
+			const i32 x0 = Clamp(static_cast<i32>(floorU), 0, size.x - 1), x1 = Clamp(static_cast<i32>(floorU) + 1, 0, size.x - 1);
+			const i32 y0 = Clamp(static_cast<i32>(floorV), 0, size.y - 1), y1 = Clamp(static_cast<i32>(floorV) + 1, 0, size.y - 1);
+
+			const u32* row0 = &texels[(offset.y + y0) * stride + offset.x];
+			const u32* row1 = &texels[(offset.y + y1) * stride + offset.x];
+			return LerpRGBA(LerpRGBA(row0[x0], row0[x1], weightX), LerpRGBA(row1[x0], row1[x1], weightX), weightY);
+		}
+
+		// NOTE: (a * b) / 255 for each 16-bit lane holding an 8-bit value, rounded
+		__m128i MultiplyUNorm8(__m128i a, __m128i b)
+		{
+			const __m128i product = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+		}
+
+		__m128i BroadcastAlpha(__m128i pixels)
+		{
+			return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		}
+
+		// NOTE: Blends two premultiplied pixels unpacked to 16-bit lanes. A fully transparent source leaves the destination unchanged for all modes
+		template <BlendMode Mode>
+		__m128i BlendPixels(__m128i source, __m128i destination, __m128i opacity)
+		{
+			source = MultiplyUNorm8(source, opacity);
+			const __m128i inverseAlpha = _mm_sub_epi16(_mm_set1_epi16(255), BroadcastAlpha(source));
+
+			if constexpr (Mode == BlendMode::Add)
+				return _mm_adds_epu16(destination, source);
+			else if constexpr (Mode == BlendMode::Multiply)
+			{
+				// NOTE: (source * destination) + (source * (1 - destination alpha)) + (destination * (1 - source alpha))
+				const __m128i inverseDestinationAlpha = _mm_sub_epi16(_mm_set1_epi16(255), BroadcastAlpha(destination));
+				return _mm_add_epi16(_mm_add_epi16(MultiplyUNorm8(source, destination), MultiplyUNorm8(source, inverseDestinationAlpha)), MultiplyUNorm8(destination, inverseAlpha));
+			}
+			else if constexpr (Mode == BlendMode::Screen)
+				return _mm_sub_epi16(_mm_add_epi16(destination, source), MultiplyUNorm8(source, destination));
+			else
+				return _mm_add_epi16(source, MultiplyUNorm8(destination, inverseAlpha));
+		}
+
+		template <BlendMode Mode>
+		void BlendSpan(const u32* source, u32* destination, i32 count, u32 opacity)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i opacity16 = _mm_set1_epi16(static_cast<i16>(opacity));
+
+			i32 i = 0;
+			for (; (i + 4) <= count; i += 4)
+			{
+				const __m128i sourcePixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]));
+				const __m128i destinationPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&destination[i]));
+
+				const __m128i low = BlendPixels<Mode>(_mm_unpacklo_epi8(sourcePixels, zero), _mm_unpacklo_epi8(destinationPixels, zero), opacity16);
+				const __m128i high = BlendPixels<Mode>(_mm_unpackhi_epi8(sourcePixels, zero), _mm_unpackhi_epi8(destinationPixels, zero), opacity16);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&destination[i]), _mm_packus_epi16(low, high));
+			}
+
+			for (; i < count; i++)
+			{
+				const __m128i sourcePixel = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<i32>(source[i])), zero);
+				const __m128i destinationPixel = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<i32>(destination[i])), zero);
+				destination[i] = static_cast<u32>(_mm_cvtsi128_si32(_mm_packus_epi16(BlendPixels<Mode>(sourcePixel, destinationPixel, opacity16), zero)));
+			}
+		}
+
+		void BlendSpan(BlendMode blendMode, const u32* source, u32* destination, i32 count, u32 opacity)
+		{
+			switch (blendMode)
+			{
+			case BlendMode::Add: BlendSpan<BlendMode::Add>(source, destination, count, opacity); break;
+			case BlendMode::Multiply: BlendSpan<BlendMode::Multiply>(source, destination, count, opacity); break;
+			case BlendMode::Screen: BlendSpan<BlendMode::Screen>(source, destination, count, opacity); break;
+			default: BlendSpan<BlendMode::Normal>(source, destination, count, opacity); break;
+			}
+		}
+
+		b8 SpriteFitsInTexture(const Spr& spr, ivec2 textureSize)
+		{
+			const ivec4 region = ivec4(static_cast<i32>(spr.PixelRegion.x), static_cast<i32>(spr.PixelRegion.y), static_cast<i32>(spr.PixelRegion.z), static_cast<i32>(spr.PixelRegion.w));
+			return (region.x >= 0 && region.y >= 0 && region.z > 0 && region.w > 0 && (region.x + region.z) <= textureSize.x && (region.y + region.w) <= textureSize.y);
+		}
+	}
+
+	struct SoftwareRenderer::TileWorkerPool : NonCopyable
+	{
+		TileWorkerPool(u32 workerCount)
+		{
+			workers.reserve(workerCount);
+			for (u32 i = 0; i < workerCount; i++)
+				workers.emplace_back([this] { WorkerLoop(); });
+		}
+
+		~TileWorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				exitRequested = true;
+			}
+
+			wakeCondition.notify_all();
+			for (auto& worker : workers)
+				worker.join();
+		}
+
+		inline u32 GetWorkerCount() const { return static_cast<u32>(workers.size()); }
+
+		// NOTE: Runs the job on every worker as well as on the calling thread and returns once all of them have finished
+		void Run(const std::function<void()>& job)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				currentJob = &job;
+				busyWorkerCount = GetWorkerCount();
+				jobGeneration++;
+			}
+
+			wakeCondition.notify_all();
+			job();
+
+			std::unique_lock<std::mutex> lock(mutex);
+			doneCondition.wait(lock, [&] { return (busyWorkerCount == 0); });
+			currentJob = nullptr;
+		}
+
+	private:
+		void WorkerLoop()
+		{
+			u64 lastJobGeneration = 0;
+			while (true)
+			{
+				const std::function<void()>* job = nullptr;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					wakeCondition.wait(lock, [&] { return (exitRequested || jobGeneration != lastJobGeneration); });
+					if (exitRequested)
+						return;
+
+					lastJobGeneration = jobGeneration;
+					job = currentJob;
+				}
+
+				(*job)();
+
+				b8 lastWorkerDone;
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					lastWorkerDone = (--busyWorkerCount == 0);
+				}
+
+				if (lastWorkerDone)
+					doneCondition.notify_one();
+			}
+		}
+
+		std::mutex mutex;
+		std::condition_variable wakeCondition, doneCondition;
+		const std::function<void()>* currentJob = nullptr;
+		u64 jobGeneration = 0;
+		u32 busyWorkerCount = 0;
+		b8 exitRequested = false;
+		std::vector<std::thread> workers;
+	};
+
+	SoftwareRenderer::SoftwareRenderer(const Scene& scene, const SprSet* sprSet, std::string_view sourceNamePrefix) : scene(scene), evaluator(scene)
+	{
+		if (sprSet == nullptr)
+			return;
+
+		const auto& inTextures = sprSet->TexSet.Textures;
+		textures.resize(inTextures.size());
+
+		std::vector<std::future<void>> textureFutures;
+		textureFutures.reserve(inTextures.size());
+
+		for (size_t i = 0; i < inTextures.size(); i++)
+		{
+			textureFutures.push_back(std::async(std::launch::async, [&, i]
+			{
+				const Tex& inTexture = *inTextures[i];
+				DecodedTexture& outTexture = textures[i];
+
+				const ivec2 size = inTexture.GetSize();
+				const size_t byteSize = TextureFormatByteSize(size, TextureFormat::RGBA8);
+				auto rgba = std::make_unique<u32[]>(static_cast<size_t>(size.x) * size.y);
+
+				// NOTE: Textures are stored following the OpenGL convention so flip them once here to match the top-down sprite pixel regions
+				if (!ConvertTextureToRGBABuffer(inTexture, reinterpret_cast<u8*>(rgba.get()), byteSize) || !FlipTextureBufferY(size, reinterpret_cast<u8*>(rgba.get()), TextureFormat::RGBA8, byteSize))
+					return;
+
+				for (size_t pixel = 0; pixel < static_cast<size_t>(size.x) * size.y; pixel++)
+					rgba[pixel] = PremultiplyRGBA(rgba[pixel]);
+
+				outTexture.Size = size;
+				outTexture.RGBA = std::move(rgba);
+			}));
+		}
+
+		for (const auto& video : scene.Videos)
+		{
+			for (const auto& source : video->Sources)
+			{
+				const auto sourceName = ASCII::TrimPrefixInsensitive(source.Name, sourceNamePrefix);
+				const auto matchingSpr = FindIfOrNull(sprSet->Sprites, [&](const Spr& spr) { return ASCII::MatchesInsensitive(spr.Name, sourceName); });
+
+				if (matchingSpr != nullptr && InBounds(matchingSpr->TextureIndex, inTextures) && SpriteFitsInTexture(*matchingSpr, inTextures[matchingSpr->TextureIndex]->GetSize()))
+					sourceSprites[&source] = matchingSpr;
+			}
+		}
+
+		for (auto& future : textureFutures)
+			future.wait();
+	}
+
+	SoftwareRenderer::~SoftwareRenderer() = default;
+
+	void SoftwareRenderer::Render(frame_t frame, u32* outRGBA)
+	{
+		const ivec2 resolution = scene.Resolution;
+		if (resolution.x <= 0 || resolution.y <= 0)
+			return;
+
+		evaluator.Evaluate(frame, evaluatedLayers);
+		drawQuads.clear();
+
+		for (const auto& layer : evaluatedLayers)
+		{
+			DrawQuad quad = {};
+			quad.Size = vec2(layer.Video->Size);
+			quad.Opacity = static_cast<u32>(Clamp(static_cast<i32>(Round(layer.Opacity * 255.0f)), 0, 255));
+			quad.BlendMode = layer.BlendMode;
+
+			if (layer.SourceIndex < 0)
+			{
+				quad.SolidColor = (layer.Video->Color | PackedAlphaMask);
+			}
+			else
+			{
+				const auto foundSpr = sourceSprites.find(&layer.Video->Sources[layer.SourceIndex]);
+				if (foundSpr == sourceSprites.end())
+					continue;
+
+				const Spr& spr = *foundSpr->second;
+				const DecodedTexture& texture = textures[spr.TextureIndex];
+				if (texture.RGBA == nullptr)
+					continue;
+
+				quad.Size = spr.GetSize();
+				quad.Texels = texture.RGBA.get();
+				quad.TexelStride = texture.Size.x;
+				quad.TexelOffset = ivec2(static_cast<i32>(spr.PixelRegion.x), static_cast<i32>(spr.PixelRegion.y));
+			}
+
+			if (quad.Opacity == 0 || Absolute(layer.Transform.GetDeterminant()) < 0.000001f)
+				continue;
+
+			quad.ScreenToLocal = layer.Transform.GetInverse();
+
+			const vec2 corners[4] = { vec2(0.0f, 0.0f), vec2(quad.Size.x, 0.0f), vec2(0.0f, quad.Size.y), quad.Size };
+			vec2 min = layer.Transform.TransformPoint(corners[0]), max = min;
+			for (const vec2 corner : corners)
+			{
+				const vec2 screenCorner = layer.Transform.TransformPoint(corner);
+				min = Min(min, screenCorner);
+				max = Max(max, screenCorner);
+			}
+
+			quad.ScreenMin = ivec2(Clamp(static_cast<i32>(Floor(min.x)), 0, resolution.x), Clamp(static_cast<i32>(Floor(min.y)), 0, resolution.y));
+			quad.ScreenMax = ivec2(Clamp(static_cast<i32>(Ceil(max.x)), 0, resolution.x), Clamp(static_cast<i32>(Ceil(max.y)), 0, resolution.y));
+
+			if (quad.ScreenMin.x < quad.ScreenMax.x && quad.ScreenMin.y < quad.ScreenMax.y)
+				drawQuads.push_back(quad);
+		}
+
+		const u32 clearColor = Settings.ClearColor.value_or(scene.BackgroundColor | PackedAlphaMask);
+		const ivec2 tileSize = ivec2(Max(Settings.TileSize.x, 1), Max(Settings.TileSize.y, 1));
+		const ivec2 tileCount = ivec2((resolution.x + tileSize.x - 1) / tileSize.x, (resolution.y + tileSize.y - 1) / tileSize.y);
+		const u32 totalTileCount = static_cast<u32>(tileCount.x * tileCount.y);
+
+		std::atomic<u32> nextTileIndex = 0;
+		const auto renderRemainingTiles = [&]()
+		{
+			for (u32 tileIndex = nextTileIndex++; tileIndex < totalTileCount; tileIndex = nextTileIndex++)
+			{
+				const ivec2 tileMin = ivec2(static_cast<i32>(tileIndex) % tileCount.x, static_cast<i32>(tileIndex) / tileCount.x) * tileSize;
+				RenderTile(tileMin, Min(tileMin + tileSize, resolution), clearColor, outRGBA);
+			}
+		};
+
+		const b8 smallTarget = ((resolution.x * resolution.y) < MinWorkerPixelCount);
+		const u32 workerCount = (Settings.Multithreaded && !smallTarget) ? (Clamp(std::thread::hardware_concurrency(), 1u, totalTileCount) - 1) : 0;
+
+		if (workerCount == 0)
+		{
+			renderRemainingTiles();
+			return;
+		}
+
+		if (workerPool == nullptr || workerPool->GetWorkerCount() != workerCount)
+			workerPool = std::make_unique<TileWorkerPool>(workerCount);
+
+		workerPool->Run(renderRemainingTiles);
+	}
+
+	void SoftwareRenderer::RenderTile(ivec2 tileMin, ivec2 tileMax, u32 clearColor, u32* outRGBA) const
+	{
+		const i32 stride = scene.Resolution.x;
+		for (i32 y = tileMin.y; y < tileMax.y; y++)
+			std::fill(&outRGBA[y * stride + tileMin.x], &outRGBA[y * stride + tileMax.x], clearColor);
+
+		std::vector<u32> sourceSpan(static_cast<size_t>(tileMax.x - tileMin.x));
+
+		for (const auto& quad : drawQuads)
+		{
+			const ivec2 min = Max(quad.ScreenMin, tileMin), max = Min(quad.ScreenMax, tileMax);
+			if (min.x >= max.x || min.y >= max.y)
+				continue;
+
+			const i32 spanWidth = (max.x - min.x);
+			const ivec2 texelSize = ivec2(static_cast<i32>(quad.Size.x), static_cast<i32>(quad.Size.y));
+			const vec2 localStepX = vec2(quad.ScreenToLocal.A, quad.ScreenToLocal.B);
+
+			for (i32 y = min.y; y < max.y; y++)
+			{
+				// NOTE: Sample at pixel centers, any pixel outside the quad is left fully transparent
+				vec2 local = quad.ScreenToLocal.TransformPoint(vec2(static_cast<f32>(min.x) + 0.5f, static_cast<f32>(y) + 0.5f));
+				for (i32 x = 0; x < spanWidth; x++, local += localStepX)
+				{
+					const b8 inside = (local.x >= 0.0f && local.y >= 0.0f && local.x < quad.Size.x && local.y < quad.Size.y);
+					if (!inside)
+						sourceSpan[x] = 0;
+					else if (quad.Texels == nullptr)
+						sourceSpan[x] = quad.SolidColor;
+					else
+						sourceSpan[x] = SampleBilinear(quad.Texels, quad.TexelStride, quad.TexelOffset, texelSize, local);
+				}
+
+				BlendSpan(quad.BlendMode, sourceSpan.data(), &outRGBA[y * stride + min.x], spanWidth, quad.Opacity);
+			}
+		}
+	}
+}
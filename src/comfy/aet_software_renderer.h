@@ -0,0 +1,69 @@
+#pragma once
+#include "core_types.h"
+#include "aet_scene_evaluator.h"
+#include "file_format_spr_set.h"
+#include <unordered_map>
+
+namespace Comfy::Aet
+{
+	// NOTE: Headless CPU renderer drawing all visible video layers of a scene into an RGBA8 buffer, mainly intended for image based regression testing.
+	//		 Textures are decoded and premultiplied once on construction, sprites are then bilinearly sampled and blended four pixels at a time using SSE2.
+	//		 Supports the Normal, Add, Multiply and Screen blend modes with all other blend modes being drawn as Normal.
+	//		 The target buffer is split into tiles which are rendered in parallel by worker threads kept alive across frames, while small targets are rendered
+	//		 on the calling thread alone. Not thread safe itself, use one renderer per thread
+	struct SoftwareRenderer : NonCopyable
+	{
+		// NOTE: Video sources are matched to the sprites by name after trimming the source name prefix (typically "{SET_NAME}_"), same as the importer does.
+		//		 Only the textures are decoded into copies, the scene and the sprites of the SprSet are referenced directly so both have to outlive the renderer
+		SoftwareRenderer(const Scene& scene, const SprSet* sprSet, std::string_view sourceNamePrefix);
+		~SoftwareRenderer();
+
+		struct SettingsData
+		{
+			// NOTE: Cleared to the opaque scene background color if unset
+			std::optional<u32> ClearColor = {};
+			ivec2 TileSize = ivec2(128, 64);
+			b8 Multithreaded = true;
+		} Settings;
+
+		inline ivec2 GetResolution() const { return scene.Resolution; }
+
+		// NOTE: Renders into a tightly packed top-down RGBA8 buffer of GetResolution() pixels using premultiplied alpha
+		void Render(frame_t frame, u32* outRGBA);
+
+	private:
+		struct DecodedTexture
+		{
+			ivec2 Size;
+			std::unique_ptr<u32[]> RGBA;
+		};
+
+		struct DrawQuad
+		{
+			AffineTransform2D ScreenToLocal;
+			// NOTE: Min inclusive, max exclusive
+			ivec2 ScreenMin, ScreenMax;
+			vec2 Size;
+			// NOTE: Null for source-less videos drawn using the solid color instead
+			const u32* Texels;
+			i32 TexelStride;
+			ivec2 TexelOffset;
+			u32 SolidColor;
+			u32 Opacity;
+			BlendMode BlendMode;
+		};
+
+		void RenderTile(ivec2 tileMin, ivec2 tileMax, u32 clearColor, u32* outRGBA) const;
+
+		// NOTE: Created on first use and only recreated if the worker count changes
+		struct TileWorkerPool;
+		std::unique_ptr<TileWorkerPool> workerPool;
+
+		const Scene& scene;
+		SceneEvaluator evaluator;
+		std::vector<DecodedTexture> textures;
+		std::unordered_map<const VideoSource*, const Spr*> sourceSprites;
+		std::vector<EvaluatedLayer> evaluatedLayers;
+		std::vector<DrawQuad> drawQuads;
+	};
+}
@@ -1,5 +1,9 @@
 #include "file_format_aet_set.h"
+#include "core_parallel.h"
 #include <algorithm>
+#include <cstring>
+#include <future>
+#include <xmmintrin.h>
 
 namespace Comfy::Aet
 {
@@ -14,6 +18,13 @@ namespace Comfy::Aet
 				+ ((((((t * t) * t) * 2.0f) - ((t * t) * 3.0f)) + 1.0f) * start.Value));
 	}
 
+	static size_t FindFCurveEndKeyIndex(const std::vector<KeyFrame>& keys, frame_t frame)
+	{
+		// NOTE: First key at or after the input frame, skipping the front key which the caller has already checked against
+		const auto found = std::lower_bound(keys.begin() + 1, keys.end(), frame, [](const KeyFrame& key, frame_t frame) { return key.Frame < frame; });
+		return static_cast<size_t>(std::distance(keys.begin(), found));
+	}
+
 	f32 SampleFCurveAt(const std::vector<KeyFrame>& keys, frame_t frame)
 	{
 		if (keys.size() <= 0)
@@ -26,33 +37,173 @@ namespace Comfy::Aet
 		else if (frame >= back.Frame)
 			return back.Value;
 
-		const KeyFrame* start = &front;
-		const KeyFrame* end = start;
-		for (size_t i = 1; i < keys.size(); i++)
+		const size_t endIndex = FindFCurveEndKeyIndex(keys, frame);
+		return InterpolateHermite(keys[endIndex - 1], keys[endIndex], frame);
+	}
+
+	f32 SampleFCurveAt(const std::vector<KeyFrame>& keys, frame_t frame, FCurveCursor& cursor)
+	{
+		if (keys.size() <= 0)
+			return 0.0f;
+
+		const KeyFrame& front = keys.front();
+		const KeyFrame& back = keys.back();
+		if (keys.size() == 1 || frame <= front.Frame)
+			return front.Value;
+		else if (frame >= back.Frame)
+			return back.Value;
+
+		size_t endIndex = cursor.EndKeyIndex;
+		if (endIndex < 1 || endIndex >= keys.size() || (endIndex > 1 && keys[endIndex - 1].Frame >= frame))
 		{
-			end = &keys[i];
-			if (end->Frame >= frame)
-				break;
-			start = end;
+			endIndex = FindFCurveEndKeyIndex(keys, frame);
+		}
+		else
+		{
+			while (keys[endIndex].Frame < frame && (endIndex + 1) < keys.size())
+				endIndex++;
 		}
 
-		return InterpolateHermite(*start, *end, frame);
+		cursor.EndKeyIndex = endIndex;
+		return InterpolateHermite(keys[endIndex - 1], keys[endIndex], frame);
 	}
 
-	std::shared_ptr<Layer> Scene::FindLayer(std::string_view name)
+	static void InterpolateHermiteRange(const KeyFrame& start, const KeyFrame& end, frame_t startFrame, frame_t step, size_t firstIndex, size_t lastIndex, f32* outValues)
+	{
+		const f32 range = end.Frame - start.Frame;
+		size_t i = firstIndex;
+
+		// NOTE: Same operations in the same order as InterpolateHermite() so that each lane produces the scalar result
+		const __m128 rangeV = _mm_set1_ps(range), startFrameV = _mm_set1_ps(start.Frame);
+		const __m128 startValueV = _mm_set1_ps(start.Value), endValueV = _mm_set1_ps(end.Value);
+		const __m128 startTangentV = _mm_set1_ps(start.Tangent), endTangentV = _mm_set1_ps(end.Tangent);
+		const __m128 oneV = _mm_set1_ps(1.0f), twoV = _mm_set1_ps(2.0f), threeV = _mm_set1_ps(3.0f);
+		const __m128 rangeStartV = _mm_set1_ps(startFrame), stepV = _mm_set1_ps(step);
+
+		for (; (i + 4) <= lastIndex; i += 4)
+		{
+			const f32 fi = static_cast<f32>(i);
+			const __m128 indexV = _mm_setr_ps(fi, static_cast<f32>(i + 1), static_cast<f32>(i + 2), static_cast<f32>(i + 3));
+			const __m128 frameV = _mm_add_ps(rangeStartV, _mm_mul_ps(indexV, stepV));
+
+			const __m128 t = _mm_div_ps(_mm_sub_ps(frameV, startFrameV), rangeV);
+			const __m128 tt = _mm_mul_ps(t, t);
+			const __m128 ttt = _mm_mul_ps(tt, t);
+
+			const __m128 startTangentFactor = _mm_mul_ps(_mm_add_ps(_mm_sub_ps(ttt, _mm_mul_ps(tt, twoV)), t), startTangentV);
+			const __m128 endTangentFactor = _mm_mul_ps(_mm_sub_ps(ttt, tt), endTangentV);
+			const __m128 tangents = _mm_mul_ps(_mm_add_ps(startTangentFactor, endTangentFactor), rangeV);
+
+			const __m128 endValueFactor = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(tt, threeV), _mm_mul_ps(ttt, twoV)), endValueV);
+			const __m128 startValueFactor = _mm_mul_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(ttt, twoV), _mm_mul_ps(tt, threeV)), oneV), startValueV);
+
+			_mm_storeu_ps(&outValues[i], _mm_add_ps(tangents, _mm_add_ps(endValueFactor, startValueFactor)));
+		}
+
+		for (; i < lastIndex; i++)
+			outValues[i] = InterpolateHermite(start, end, startFrame + static_cast<f32>(i) * step);
+	}
+
+	void SampleFCurveRange(const std::vector<KeyFrame>& keys, frame_t startFrame, size_t frameCount, frame_t step, f32* outValues)
+	{
+		if (keys.size() <= 1 || step <= 0.0f)
+		{
+			for (size_t i = 0; i < frameCount; i++)
+				outValues[i] = SampleFCurveAt(keys, startFrame + static_cast<f32>(i) * step);
+			return;
+		}
+
+		const auto frameAt = [&](size_t i) { return startFrame + static_cast<f32>(i) * step; };
+		const KeyFrame& front = keys.front();
+		const KeyFrame& back = keys.back();
+
+		size_t i = 0;
+		while (i < frameCount && frameAt(i) <= front.Frame)
+			outValues[i++] = front.Value;
+
+		size_t endIndex = 1;
+		while (i < frameCount && frameAt(i) < back.Frame)
+		{
+			const frame_t frame = frameAt(i);
+			while (keys[endIndex].Frame < frame)
+				endIndex++;
+
+			// NOTE: All following frames up to and including the end key frame share the same segment
+			const frame_t segmentEndFrame = keys[endIndex].Frame;
+			size_t segmentEnd = i + 1;
+			while (segmentEnd < frameCount && frameAt(segmentEnd) <= segmentEndFrame && frameAt(segmentEnd) < back.Frame)
+				segmentEnd++;
+
+			InterpolateHermiteRange(keys[endIndex - 1], keys[endIndex], startFrame, step, i, segmentEnd, outValues);
+			i = segmentEnd;
+		}
+
+		while (i < frameCount)
+			outValues[i++] = back.Value;
+	}
+
+	void LayerVideo2D::SampleRange(frame_t startFrame, size_t frameCount, frame_t step, f32* outValues) const
+	{
+		for (Transform2DField field = 0; field < Transform2DField_Count; field++)
+			(*this)[field].SampleRange(startFrame, frameCount, step, &outValues[field * frameCount]);
+	}
+
+	void LayerVideo3D::SampleRange(frame_t startFrame, size_t frameCount, frame_t step, f32* outValues) const
+	{
+		for (size_t i = 0; i < CurveCount; i++)
+			(*this)[i].SampleRange(startFrame, frameCount, step, &outValues[i * frameCount]);
+	}
+
+	void LayerNameLookup::Clear()
+	{
+		LayersByName.clear();
+		LayersByMarkerName.clear();
+	}
+
+	void LayerNameLookup::Add(const std::shared_ptr<Layer>& layer)
+	{
+		const u32 order = static_cast<u32>(LayersByName.size());
+		LayersByName.emplace(std::hash<std::string_view>()(layer->GetName()), Entry { order, layer, nullptr });
+
+		for (const auto& marker : layer->Markers)
+			LayersByMarkerName.emplace(std::hash<std::string_view>()(marker->Name), Entry { order, layer, marker.get() });
+	}
+
+	std::shared_ptr<Layer> LayerNameLookup::FindLayer(std::string_view name) const
 	{
-		const std::shared_ptr<Layer>& rootFoundLayer = RootComposition->FindLayer(name);
-		if (rootFoundLayer != nullptr)
-			return rootFoundLayer;
+		const Entry* result = nullptr;
+		for (auto [it, end] = LayersByName.equal_range(std::hash<std::string_view>()(name)); it != end; it++)
+		{
+			if ((result == nullptr || it->second.Order < result->Order) && it->second.Layer->GetName() == name)
+				result = &it->second;
+		}
+		return (result != nullptr) ? result->Layer : nullptr;
+	}
 
-		for (i32 i = static_cast<i32>(Compositions.size()) - 1; i >= 0; i--)
+	std::shared_ptr<Layer> LayerNameLookup::FindLayerByMarker(std::string_view markerName) const
+	{
+		const Entry* result = nullptr;
+		for (auto [it, end] = LayersByMarkerName.equal_range(std::hash<std::string_view>()(markerName)); it != end; it++)
 		{
-			const std::shared_ptr<Layer>& layer = Compositions[i]->FindLayer(name);
-			if (layer != nullptr)
-				return layer;
+			if ((result == nullptr || it->second.Order < result->Order) && it->second.Marker->Name == markerName)
+				result = &it->second;
 		}
+		return (result != nullptr) ? result->Layer : nullptr;
+	}
 
-		return nullptr;
+	const LayerNameLookup& Composition::GetLayerNameLookup() const
+	{
+		layerNameLookup.BuildIfInvalid([&](LayerNameLookup& lookup)
+		{
+			for (const auto& layer : Layers)
+				lookup.Add(layer);
+		});
+		return layerNameLookup;
+	}
+
+	std::shared_ptr<Layer> Scene::FindLayer(std::string_view name)
+	{
+		return GetLayerNameLookup().FindLayer(name);
 	}
 
 	std::shared_ptr<const Layer> Scene::FindLayer(std::string_view name) const
@@ -60,6 +211,271 @@ namespace Comfy::Aet
 		return const_cast<Scene*>(this)->FindLayer(name);
 	}
 
+	std::shared_ptr<Layer> Scene::FindLayerByMarker(std::string_view markerName)
+	{
+		return GetLayerNameLookup().FindLayerByMarker(markerName);
+	}
+
+	std::shared_ptr<const Layer> Scene::FindLayerByMarker(std::string_view markerName) const
+	{
+		return const_cast<Scene*>(this)->FindLayerByMarker(markerName);
+	}
+
+	void Scene::InvalidateLayerNameLookup()
+	{
+		layerNameLookup.BuildGuard.Invalidate();
+		ForEachComp([&](auto& comp)
+		{
+			if (comp != nullptr)
+				comp->InvalidateLayerNameLookup();
+		});
+	}
+
+	void Scene::BuildLayerNameLookups() const
+	{
+		GetLayerNameLookup();
+		ForEachComp([&](const auto& comp)
+		{
+			if (comp != nullptr)
+				comp->BuildLayerNameLookup();
+		});
+	}
+
+	const LayerNameLookup& Scene::GetLayerNameLookup() const
+	{
+		layerNameLookup.BuildIfInvalid([&](LayerNameLookup& lookup)
+		{
+			const auto addCompLayers = [&](const std::shared_ptr<Composition>& comp)
+			{
+				if (comp != nullptr)
+				{
+					for (const auto& layer : comp->Layers)
+						lookup.Add(layer);
+				}
+			};
+
+			addCompLayers(RootComposition);
+			for (auto it = Compositions.rbegin(); it != Compositions.rend(); it++)
+				addCompLayers(*it);
+		});
+		return layerNameLookup;
+	}
+
+	struct LayerTimeInterval
+	{
+		frame_t StartFrame, EndFrame;
+		u32 LayerIndex;
+	};
+
+	static u32 BuildLayerTimeIndexNode(LayerTimeIndex& index, std::vector<LayerTimeInterval>& intervals)
+	{
+		if (intervals.empty())
+			return LayerTimeIndex::InvalidNode;
+
+		// NOTE: Centered on the median start frame. Its own interval always contains it so that every node stores at least one layer,
+		//		 while neither child can receive more than half of the intervals
+		const auto median = intervals.begin() + (intervals.size() / 2);
+		std::nth_element(intervals.begin(), median, intervals.end(), [](const auto& a, const auto& b) { return a.StartFrame < b.StartFrame; });
+		const frame_t center = median->StartFrame;
+
+		std::vector<LayerTimeInterval> left, right, containing;
+		for (const auto& interval : intervals)
+		{
+			if (interval.EndFrame <= center)
+				left.push_back(interval);
+			else if (interval.StartFrame > center)
+				right.push_back(interval);
+			else
+				containing.push_back(interval);
+		}
+
+		const u32 nodeIndex = static_cast<u32>(index.Nodes.size());
+		index.Nodes.push_back(LayerTimeIndex::Node { center, LayerTimeIndex::InvalidNode, LayerTimeIndex::InvalidNode, static_cast<u32>(index.ByStartFrame.size()), static_cast<u32>(containing.size()) });
+
+		std::sort(containing.begin(), containing.end(), [](const auto& a, const auto& b) { return a.StartFrame < b.StartFrame; });
+		for (const auto& interval : containing)
+			index.ByStartFrame.push_back(LayerTimeIndex::Entry { interval.StartFrame, interval.LayerIndex });
+
+		std::sort(containing.begin(), containing.end(), [](const auto& a, const auto& b) { return a.EndFrame > b.EndFrame; });
+		for (const auto& interval : containing)
+			index.ByEndFrame.push_back(LayerTimeIndex::Entry { interval.EndFrame, interval.LayerIndex });
+
+		const u32 leftIndex = BuildLayerTimeIndexNode(index, left);
+		const u32 rightIndex = BuildLayerTimeIndexNode(index, right);
+		index.Nodes[nodeIndex].Left = leftIndex;
+		index.Nodes[nodeIndex].Right = rightIndex;
+		return nodeIndex;
+	}
+
+	void LayerTimeIndex::Build(const std::vector<std::shared_ptr<Layer>>& layers)
+	{
+		Nodes.clear();
+		ByStartFrame.clear();
+		ByEndFrame.clear();
+
+		std::vector<LayerTimeInterval> intervals;
+		intervals.reserve(layers.size());
+
+		for (size_t i = 0; i < layers.size(); i++)
+		{
+			if (layers[i] != nullptr && layers[i]->StartFrame < layers[i]->EndFrame)
+				intervals.push_back(LayerTimeInterval { layers[i]->StartFrame, layers[i]->EndFrame, static_cast<u32>(i) });
+		}
+
+		ByStartFrame.reserve(intervals.size());
+		ByEndFrame.reserve(intervals.size());
+		BuildLayerTimeIndexNode(*this, intervals);
+	}
+
+	void LayerTimeIndex::FindActive(frame_t frame, std::vector<u32>& outLayerIndices) const
+	{
+		for (u32 nodeIndex = Nodes.empty() ? InvalidNode : 0; nodeIndex != InvalidNode;)
+		{
+			const Node& node = Nodes[nodeIndex];
+			const u32 entriesEnd = (node.EntriesBegin + node.EntriesCount);
+
+			// NOTE: All layers of the node contain the center, so only the side facing the frame has to be checked
+			if (frame < node.Center)
+			{
+				for (u32 i = node.EntriesBegin; i < entriesEnd && ByStartFrame[i].Frame <= frame; i++)
+					outLayerIndices.push_back(ByStartFrame[i].LayerIndex);
+				nodeIndex = node.Left;
+			}
+			else
+			{
+				for (u32 i = node.EntriesBegin; i < entriesEnd && ByEndFrame[i].Frame > frame; i++)
+					outLayerIndices.push_back(ByEndFrame[i].LayerIndex);
+				nodeIndex = node.Right;
+			}
+		}
+	}
+
+	void LayerTimeIndex::FindActive(frame_t startFrame, frame_t endFrame, std::vector<u32>& outLayerIndices) const
+	{
+		if (!Nodes.empty() && startFrame < endFrame)
+			FindActive(0, startFrame, endFrame, outLayerIndices);
+	}
+
+	void LayerTimeIndex::FindActive(u32 nodeIndex, frame_t startFrame, frame_t endFrame, std::vector<u32>& outLayerIndices) const
+	{
+		while (nodeIndex != InvalidNode)
+		{
+			const Node& node = Nodes[nodeIndex];
+			const u32 entriesEnd = (node.EntriesBegin + node.EntriesCount);
+
+			if (endFrame <= node.Center)
+			{
+				for (u32 i = node.EntriesBegin; i < entriesEnd && ByStartFrame[i].Frame < endFrame; i++)
+					outLayerIndices.push_back(ByStartFrame[i].LayerIndex);
+				nodeIndex = node.Left;
+			}
+			else if (startFrame >= node.Center)
+			{
+				for (u32 i = node.EntriesBegin; i < entriesEnd && ByEndFrame[i].Frame > startFrame; i++)
+					outLayerIndices.push_back(ByEndFrame[i].LayerIndex);
+				nodeIndex = node.Right;
+			}
+			else
+			{
+				// NOTE: The range contains the center and therefore overlaps all layers of the node
+				for (u32 i = node.EntriesBegin; i < entriesEnd; i++)
+					outLayerIndices.push_back(ByStartFrame[i].LayerIndex);
+
+				FindActive(node.Left, startFrame, endFrame, outLayerIndices);
+				nodeIndex = node.Right;
+			}
+		}
+	}
+
+	const LayerTimeIndex& Composition::GetLayerTimeIndex() const
+	{
+		layerTimeIndex.BuildIfInvalid(Layers);
+		return layerTimeIndex;
+	}
+
+	static void FindActiveCompLayers(const Composition& comp, frame_t startFrame, frame_t endFrame, b8 isRange, i32 parentIndex,
+		std::vector<const Composition*>& compStack, std::vector<u32>& layerIndices, std::vector<ActiveLayerInstance>& outLayers)
+	{
+		// NOTE: Sharing a single index buffer between all recursion levels, each one only appending to and then restoring its size
+		const size_t indicesBegin = layerIndices.size();
+		if (isRange)
+			comp.FindActiveLayerIndices(startFrame, endFrame, layerIndices);
+		else
+			comp.FindActiveLayerIndices(startFrame, layerIndices);
+
+		std::sort(layerIndices.begin() + indicesBegin, layerIndices.end());
+		const size_t indicesEnd = layerIndices.size();
+
+		for (size_t i = indicesBegin; i < indicesEnd; i++)
+		{
+			const Layer& layer = *comp.Layers[layerIndices[i]];
+			const frame_t localStartFrame = isRange ? Max(startFrame, layer.StartFrame) : startFrame;
+			const frame_t localEndFrame = isRange ? Min(endFrame, layer.EndFrame) : startFrame;
+
+			const i32 instanceIndex = static_cast<i32>(outLayers.size());
+			outLayers.push_back(ActiveLayerInstance { &layer, parentIndex, localStartFrame, localEndFrame });
+
+			if (layer.ItemType != ItemType::Composition)
+				continue;
+
+			const Composition* compItem = layer.GetCompItem();
+			if (compItem == nullptr || std::find(compStack.begin(), compStack.end(), compItem) != compStack.end())
+				continue;
+
+			frame_t itemStartFrame = ((localStartFrame - layer.StartFrame) * layer.TimeScale) + layer.StartOffset;
+			frame_t itemEndFrame = ((localEndFrame - layer.StartFrame) * layer.TimeScale) + layer.StartOffset;
+			if (itemEndFrame < itemStartFrame)
+				std::swap(itemStartFrame, itemEndFrame);
+
+			// NOTE: A zero time scale freezes the item on a single frame
+			const b8 isItemRange = (isRange && itemStartFrame < itemEndFrame);
+
+			compStack.push_back(compItem);
+			FindActiveCompLayers(*compItem, itemStartFrame, itemEndFrame, isItemRange, instanceIndex, compStack, layerIndices, outLayers);
+			compStack.pop_back();
+		}
+
+		layerIndices.resize(indicesBegin);
+	}
+
+	void Scene::FindActiveLayers(frame_t frame, std::vector<ActiveLayerInstance>& outLayers) const
+	{
+		if (RootComposition == nullptr)
+			return;
+
+		std::vector<const Composition*> compStack = { RootComposition.get() };
+		std::vector<u32> layerIndices;
+		FindActiveCompLayers(*RootComposition, frame, frame, false, -1, compStack, layerIndices, outLayers);
+	}
+
+	void Scene::FindActiveLayers(frame_t startFrame, frame_t endFrame, std::vector<ActiveLayerInstance>& outLayers) const
+	{
+		if (RootComposition == nullptr || !(startFrame < endFrame))
+			return;
+
+		std::vector<const Composition*> compStack = { RootComposition.get() };
+		std::vector<u32> layerIndices;
+		FindActiveCompLayers(*RootComposition, startFrame, endFrame, true, -1, compStack, layerIndices, outLayers);
+	}
+
+	void Scene::InvalidateLayerTimeIndices()
+	{
+		ForEachComp([&](auto& comp)
+		{
+			if (comp != nullptr)
+				comp->InvalidateLayerTimeIndex();
+		});
+	}
+
+	void Scene::BuildLayerTimeIndices() const
+	{
+		ForEachComp([&](const auto& comp)
+		{
+			if (comp != nullptr)
+				comp->BuildLayerTimeIndex();
+		});
+	}
+
 	i32 Scene::FindLayerIndex(Composition& comp, std::string_view name) const
 	{
 		for (i32 i = static_cast<i32>(comp.Layers.size()) - 1; i >= 0; i--)
@@ -105,14 +521,16 @@ namespace Comfy::Aet
 	{
 		assert(RootComposition != nullptr);
 		ForEachComp([&](auto& comp) { InternalLinkCompItems(*comp); });
+
+		InternalFileLookup = {};
 	}
 
 	void Scene::InternalLinkCompItems(Composition& comp)
 	{
-		auto findSetLayerItem = [](auto& layer, auto& itemVector)
+		auto findSetLayerItem = [](auto& layer, auto& itemLookup)
 		{
-			if (auto f = FindIfOrNull(itemVector, [&](auto& e) { return e->InternalFilePosition == layer.InternalItemFileOffset; }); f != nullptr)
-				layer.SetItem(*f);
+			if (auto f = itemLookup.find(layer.InternalItemFileOffset); f != itemLookup.end())
+				layer.SetItem(f->second);
 		};
 
 		for (auto& layer : comp.Layers)
@@ -120,11 +538,11 @@ namespace Comfy::Aet
 			if (layer->InternalItemFileOffset != FileAddr::NullPtr)
 			{
 				if (layer->ItemType == ItemType::Video)
-					findSetLayerItem(*layer, Videos);
+					findSetLayerItem(*layer, InternalFileLookup.Videos);
 				else if (layer->ItemType == ItemType::Audio)
-					findSetLayerItem(*layer, Audios);
+					findSetLayerItem(*layer, InternalFileLookup.Audios);
 				else if (layer->ItemType == ItemType::Composition)
-					findSetLayerItem(*layer, Compositions);
+					findSetLayerItem(*layer, InternalFileLookup.Compositions);
 			}
 
 			if (layer->InternalParentFileOffset != FileAddr::NullPtr)
@@ -134,17 +552,8 @@ namespace Comfy::Aet
 
 	void Scene::InternalFindSetLayerRefParentLayer(Layer& layer)
 	{
-		for (auto& otherComp : Compositions)
-		{
-			for (auto& otherLayer : otherComp->Layers)
-			{
-				if (otherLayer->InternalFilePosition == layer.InternalParentFileOffset)
-				{
-					layer.Ref.ParentLayer = otherLayer;
-					return;
-				}
-			}
-		}
+		if (auto f = InternalFileLookup.Layers.find(layer.InternalParentFileOffset); f != InternalFileLookup.Layers.end())
+			layer.Ref.ParentLayer = f->second;
 	}
 
 	template <typename FlagsStruct>
@@ -171,7 +580,7 @@ namespace Comfy::Aet
 		}
 	}
 
-	static u32 ReadU32ColorRGB(StreamReader& reader)
+	u32 ReadU32ColorRGB(StreamReader& reader)
 	{
 		u32 value = 0;
 		*(reinterpret_cast<u8*>(&value) + 0) = reader.ReadU8();
@@ -251,8 +660,8 @@ namespace Comfy::Aet
 		return StreamResult::Success;
 	}
 
-	template <typename FlagsStruct>
-	static void WriteFlagsBitfieldStruct(StreamWriter& writer, const FlagsStruct& in)
+	template <typename FlagsStruct, typename WriterType>
+	static void WriteFlagsBitfieldStruct(WriterType& writer, const FlagsStruct& in)
 	{
 		if constexpr (sizeof(FlagsStruct) == sizeof(u8))
 			writer.WriteU8(*reinterpret_cast<const u8*>(&in));
@@ -264,13 +673,90 @@ namespace Comfy::Aet
 			static_assert(false);
 	}
 
-	static void WriteFCurvePtr(StreamWriter& writer, const FCurve& in)
+	// NOTE: Same layout as written to the file, single key curves only store their value
+	static void GetFCurveKeyData(const FCurve& in, std::vector<f32>& outKeyData)
+	{
+		outKeyData.clear();
+		if (in->size() == 1)
+		{
+			outKeyData.push_back(in->front().Value);
+			return;
+		}
+
+		outKeyData.reserve(in->size() * 3);
+		for (auto& keyFrame : in.Keys)
+			outKeyData.push_back(keyFrame.Frame);
+
+		for (auto& keyFrame : in.Keys)
+		{
+			outKeyData.push_back(keyFrame.Value);
+			outKeyData.push_back(keyFrame.Tangent);
+		}
+	}
+
+	struct FCurveWritePool : NonCopyable
+	{
+		struct Entry
+		{
+			std::vector<f32> KeyData;
+			FileAddr FilePosition;
+		};
+
+		// NOTE: Key = MurmurHash of the serialized key data, entries are only considered duplicates after a full size and memcmp check to rule out hash collisions.
+		//		 Node based so that the file positions can be referenced by the delayed writes of later duplicates
+		std::unordered_multimap<u32, Entry> WrittenEntries;
+		std::vector<f32> KeyDataBuffer;
+
+		// NOTE: Returns the entry of the first curve with the same key data, adding a new one for the input curve if there is none
+		Entry& FindOrAdd(const FCurve& in, b8& outAdded)
+		{
+			GetFCurveKeyData(in, KeyDataBuffer);
+
+			const size_t keyDataSize = (KeyDataBuffer.size() * sizeof(f32));
+			const u32 keyDataHash = MurmurHashU32(std::string_view(reinterpret_cast<cstr>(KeyDataBuffer.data()), keyDataSize));
+
+			const auto[hashMatchBegin, hashMatchEnd] = WrittenEntries.equal_range(keyDataHash);
+			for (auto it = hashMatchBegin; it != hashMatchEnd; it++)
+			{
+				Entry& other = it->second;
+				if (other.KeyData.size() == KeyDataBuffer.size() && std::memcmp(other.KeyData.data(), KeyDataBuffer.data(), keyDataSize) == 0)
+				{
+					outAdded = false;
+					return other;
+				}
+			}
+
+			outAdded = true;
+			return WrittenEntries.emplace(keyDataHash, Entry { KeyDataBuffer, FileAddr::NullPtr })->second;
+		}
+	};
+
+	static void WriteFCurvePtr(StreamWriter& writer, const FCurve& in, FCurveWritePool* pool)
 	{
 		if (in->size() > 0)
 		{
-			writer.WriteU32(static_cast<u32>(in->size()));
-			writer.WriteFuncPtr([&in](StreamWriter& writer)
+			FCurveWritePool::Entry* pooledEntry = nullptr;
+			if (pool != nullptr)
+			{
+				b8 added;
+				FCurveWritePool::Entry& entry = pool->FindOrAdd(in, added);
+				if (!added)
+				{
+					// NOTE: Only ever referencing the first occurrence, all of which have been written by the time the delayed write pool is flushed
+					writer.WriteSize(in->size());
+					writer.WriteDelayedPtr([&entry](StreamWriter& writer) { writer.WritePtr(entry.FilePosition); });
+					return;
+				}
+
+				pooledEntry = &entry;
+			}
+
+			writer.WriteSize(in->size());
+			writer.WriteFuncPtr([&in, pooledEntry](StreamWriter& writer)
 			{
+				if (pooledEntry != nullptr)
+					pooledEntry->FilePosition = writer.GetPositionOffsetAware();
+
 				if (in->size() == 1)
 				{
 					writer.WriteF32(in->front().Value);
@@ -290,45 +776,45 @@ namespace Comfy::Aet
 		}
 		else
 		{
-			writer.WriteU32(0x00000000);
+			writer.WriteSize(0);
 			writer.WritePtr(FileAddr::NullPtr);
 		}
 	}
 
-	static void WriteFCurve2DPtr(StreamWriter& writer, const FCurve2D& in)
+	static void WriteFCurve2DPtr(StreamWriter& writer, const FCurve2D& in, FCurveWritePool* pool)
 	{
-		WriteFCurvePtr(writer, in.X);
-		WriteFCurvePtr(writer, in.Y);
+		WriteFCurvePtr(writer, in.X, pool);
+		WriteFCurvePtr(writer, in.Y, pool);
 	}
 
-	static void WriteFCurve3DPtr(StreamWriter& writer, const FCurve3D& in)
+	static void WriteFCurve3DPtr(StreamWriter& writer, const FCurve3D& in, FCurveWritePool* pool)
 	{
-		WriteFCurvePtr(writer, in.X);
-		WriteFCurvePtr(writer, in.Y);
-		WriteFCurvePtr(writer, in.Z);
+		WriteFCurvePtr(writer, in.X, pool);
+		WriteFCurvePtr(writer, in.Y, pool);
+		WriteFCurvePtr(writer, in.Z, pool);
 	}
 
-	static void WriteLayerVideo2D(StreamWriter& writer, const LayerVideo2D& in)
+	static void WriteLayerVideo2D(StreamWriter& writer, const LayerVideo2D& in, FCurveWritePool* pool)
 	{
-		WriteFCurve2DPtr(writer, in.Origin);
-		WriteFCurve2DPtr(writer, in.Position);
-		WriteFCurvePtr(writer, in.Rotation);
-		WriteFCurve2DPtr(writer, in.Scale);
-		WriteFCurvePtr(writer, in.Opacity);
+		WriteFCurve2DPtr(writer, in.Origin, pool);
+		WriteFCurve2DPtr(writer, in.Position, pool);
+		WriteFCurvePtr(writer, in.Rotation, pool);
+		WriteFCurve2DPtr(writer, in.Scale, pool);
+		WriteFCurvePtr(writer, in.Opacity, pool);
 	}
 
-	static void WriteLayerVideo3D(StreamWriter& writer, const LayerVideo3D& in)
+	static void WriteLayerVideo3D(StreamWriter& writer, const LayerVideo3D& in, FCurveWritePool* pool)
 	{
-		WriteFCurvePtr(writer, in.OriginZ);
-		WriteFCurvePtr(writer, in.PositionZ);
-		WriteFCurve3DPtr(writer, in.DirectionXYZ);
-		WriteFCurve2DPtr(writer, in.RotationXY);
-		WriteFCurvePtr(writer, in.ScaleZ);
+		WriteFCurvePtr(writer, in.OriginZ, pool);
+		WriteFCurvePtr(writer, in.PositionZ, pool);
+		WriteFCurve3DPtr(writer, in.DirectionXYZ, pool);
+		WriteFCurve2DPtr(writer, in.RotationXY, pool);
+		WriteFCurvePtr(writer, in.ScaleZ, pool);
 	}
 
-	static void ReadLayerVideo(StreamReader& reader, std::shared_ptr<LayerVideo>& out)
+	static void ReadLayerVideo(StreamReader& reader, std::shared_ptr<LayerVideo>& out, const std::shared_ptr<NodeArena>& arena)
 	{
-		out = std::make_shared<LayerVideo>();
+		out = MakeNode<LayerVideo>(arena);
 		out->TransferMode.BlendMode = static_cast<BlendMode>(reader.ReadU8());
 		out->TransferMode.Flags = ReadFlagsStruct<TransferFlags>(reader);
 		out->TransferMode.TrackMatte = static_cast<TrackMatte>(reader.ReadU8());
@@ -342,9 +828,9 @@ namespace Comfy::Aet
 		const auto perspectivePropertiesOffset = reader.ReadPtr();
 		if (perspectivePropertiesOffset != FileAddr::NullPtr)
 		{
-			reader.ReadAtOffsetAware(perspectivePropertiesOffset, [out](StreamReader& reader)
+			reader.ReadAtOffsetAware(perspectivePropertiesOffset, [&](StreamReader& reader)
 			{
-				out->Transform3D = std::make_shared<LayerVideo3D>();
+				out->Transform3D = MakeNode<LayerVideo3D>(arena);
 				ReadLayerVideo3D(reader, *out->Transform3D);
 			});
 		}
@@ -380,7 +866,7 @@ namespace Comfy::Aet
 		SetFCurveStartFrame(inOut.ScaleZ, startFrame);
 	}
 
-	void Layer::Read(StreamReader& reader)
+	void Layer::Read(StreamReader& reader, const std::shared_ptr<NodeArena>& arena)
 	{
 		InternalFilePosition = reader.GetPositionOffsetAware();
 		Name = reader.ReadStrPtrOffsetAware();
@@ -406,7 +892,7 @@ namespace Comfy::Aet
 		{
 			Markers.reserve(markerCount);
 			for (size_t i = 0; i < markerCount; i++)
-				Markers.push_back(std::make_shared<Marker>());
+				Markers.push_back(MakeNode<Marker>(arena));
 
 			reader.ReadAtOffsetAware(markersOffset, [this](StreamReader& reader)
 			{
@@ -425,7 +911,7 @@ namespace Comfy::Aet
 		{
 			reader.ReadAtOffsetAware(layerVideoOffset, [&](StreamReader& reader)
 			{
-				ReadLayerVideo(reader, this->LayerVideo);
+				ReadLayerVideo(reader, this->LayerVideo, arena);
 				SetLayerVideoStartFrame(this->LayerVideo->Transform, StartFrame);
 
 				if (this->LayerVideo->Transform3D != nullptr)
@@ -436,19 +922,14 @@ namespace Comfy::Aet
 		InternalAudioDataFileOffset = reader.ReadPtr();
 	}
 
-	void Scene::Read(StreamReader& reader)
+	void Scene::Read(StreamReader& reader, const std::shared_ptr<NodeArena>& arena)
 	{
-		Name = reader.ReadStrPtrOffsetAware();
-		StartFrame = reader.ReadF32();
-		EndFrame = reader.ReadF32();
-		FrameRate = reader.ReadF32();
-		BackgroundColor = ReadU32ColorRGB(reader);
-		Resolution = reader.ReadIVec2();
+		InternalReadHeader(reader);
 
 		const auto cameraOffset = reader.ReadPtr();
 		if (cameraOffset != FileAddr::NullPtr)
 		{
-			Camera = std::make_shared<Aet::Camera>();
+			Camera = MakeNode<Aet::Camera>(arena);
 			reader.ReadAtOffsetAware(cameraOffset, [this](StreamReader& reader)
 			{
 				ReadFCurve3DPtr(reader, Camera->Eye);
@@ -464,34 +945,41 @@ namespace Comfy::Aet
 		if (compCount > 0 && compsOffset != FileAddr::NullPtr)
 		{
 			Compositions.resize(compCount - 1);
-			reader.ReadAtOffsetAware(compsOffset, [this](StreamReader& reader)
+			reader.ReadAtOffsetAware(compsOffset, [&](StreamReader& reader)
 			{
-				const auto readMakeComp = [](StreamReader& reader, std::shared_ptr<Composition>& comp)
+				const auto readMakeComp = [&](StreamReader& reader, std::shared_ptr<Composition>& comp, b8 isRoot)
 				{
-					comp = std::make_shared<Composition>();
+					comp = MakeNode<Composition>(arena);
 					comp->InternalFilePosition = reader.GetPositionOffsetAware();
 
+					if (!isRoot)
+						InternalFileLookup.Compositions.try_emplace(comp->InternalFilePosition, comp);
+
 					const auto layerCount = reader.ReadSize();
 					const auto layersOffset = reader.ReadPtr();
 
 					if (layerCount > 0 && layersOffset != FileAddr::NullPtr)
 					{
 						comp->Layers.resize(layerCount);
-						reader.ReadAtOffsetAware(layersOffset, [&comp](StreamReader& reader)
+						reader.ReadAtOffsetAware(layersOffset, [&](StreamReader& reader)
 						{
 							for (auto& layer : comp->Layers)
 							{
-								layer = std::make_shared<Layer>();
-								layer->Read(reader);
+								layer = MakeNode<Layer>(arena);
+								layer->Read(reader, arena);
+
+								if (!isRoot)
+									InternalFileLookup.Layers.try_emplace(layer->InternalFilePosition, layer);
 							}
 						});
 					}
 				};
 
+				InternalFileLookup.Compositions.reserve(Compositions.size());
 				for (auto& comp : Compositions)
-					readMakeComp(reader, comp);
+					readMakeComp(reader, comp, false);
 
-				readMakeComp(reader, RootComposition);
+				readMakeComp(reader, RootComposition, true);
 			});
 		}
 
@@ -500,12 +988,14 @@ namespace Comfy::Aet
 		if (videoCount > 0 && videosOffset != FileAddr::NullPtr)
 		{
 			Videos.reserve(videoCount);
+			InternalFileLookup.Videos.reserve(videoCount);
 			reader.ReadAtOffsetAware(videosOffset, [&](StreamReader& reader)
 			{
 				for (size_t i = 0; i < videoCount; i++)
 				{
-					auto& video = *Videos.emplace_back(std::make_shared<Video>());
+					auto& video = *Videos.emplace_back(MakeNode<Video>(arena));
 					video.InternalFilePosition = reader.GetPositionOffsetAware();
+					InternalFileLookup.Videos.try_emplace(video.InternalFilePosition, Videos.back());
 					video.Color = ReadU32ColorRGB(reader);
 					video.Size.x = reader.ReadU16();
 					video.Size.y = reader.ReadU16();
@@ -523,6 +1013,8 @@ namespace Comfy::Aet
 							{
 								source.Name = reader.ReadStrPtrOffsetAware();
 								source.ID = SprID(reader.ReadU32());
+								if (reader.GetPtrSize() == PtrSize::Mode64Bit)
+									reader.ReadU32();
 							}
 						});
 					}
@@ -535,21 +1027,33 @@ namespace Comfy::Aet
 		if (audioCount > 0 && audiosOffset != FileAddr::NullPtr)
 		{
 			Audios.reserve(audioCount);
+			InternalFileLookup.Audios.reserve(audioCount);
 			reader.ReadAtOffsetAware(audiosOffset, [&](StreamReader& reader)
 			{
 				for (size_t i = 0; i < audioCount; i++)
 				{
-					auto& audio = *Audios.emplace_back(std::make_shared<Audio>());
+					auto& audio = *Audios.emplace_back(MakeNode<Audio>(arena));
 					audio.InternalFilePosition = reader.GetPositionOffsetAware();
+					InternalFileLookup.Audios.try_emplace(audio.InternalFilePosition, Audios.back());
 					audio.SoundID = reader.ReadU32();
 				}
 			});
 		}
 	}
 
-	void Scene::Write(StreamWriter& writer)
+	void Scene::InternalReadHeader(StreamReader& reader)
+	{
+		Name = reader.ReadStrPtrOffsetAware();
+		StartFrame = reader.ReadF32();
+		EndFrame = reader.ReadF32();
+		FrameRate = reader.ReadF32();
+		BackgroundColor = ReadU32ColorRGB(reader);
+		Resolution = reader.ReadIVec2();
+	}
+
+	void Scene::Write(StreamWriter& writer, FCurveWritePool* fcurvePool)
 	{
-		writer.WriteFuncPtr([this](StreamWriter& writer)
+		writer.WriteFuncPtr([this, fcurvePool](StreamWriter& writer)
 		{
 			writer.WriteStrPtr(Name);
 			writer.WriteF32(StartFrame);
@@ -561,14 +1065,14 @@ namespace Comfy::Aet
 
 			if (this->Camera != nullptr)
 			{
-				writer.WriteFuncPtr([this](StreamWriter& writer)
+				writer.WriteFuncPtr([this, fcurvePool](StreamWriter& writer)
 				{
-					WriteFCurve3DPtr(writer, Camera->Eye);
-					WriteFCurve3DPtr(writer, Camera->Position);
-					WriteFCurve3DPtr(writer, Camera->Position);
-					WriteFCurve3DPtr(writer, Camera->Direction);
-					WriteFCurve3DPtr(writer, Camera->Rotation);
-					WriteFCurvePtr(writer, Camera->Zoom);
+					WriteFCurve3DPtr(writer, Camera->Eye, fcurvePool);
+					WriteFCurve3DPtr(writer, Camera->Position, fcurvePool);
+					WriteFCurve3DPtr(writer, Camera->Position, fcurvePool);
+					WriteFCurve3DPtr(writer, Camera->Direction, fcurvePool);
+					WriteFCurve3DPtr(writer, Camera->Rotation, fcurvePool);
+					WriteFCurvePtr(writer, Camera->Zoom, fcurvePool);
 				});
 			}
 			else
@@ -577,20 +1081,20 @@ namespace Comfy::Aet
 			}
 
 			assert(RootComposition != nullptr);
-			writer.WriteU32(static_cast<u32>(Compositions.size()) + 1);
-			writer.WriteFuncPtr([this](StreamWriter& writer)
+			writer.WriteSize(Compositions.size() + 1);
+			writer.WriteFuncPtr([this, fcurvePool](StreamWriter& writer)
 			{
-				const auto writeComp = [](StreamWriter& writer, const std::shared_ptr<Composition>& comp)
+				const auto writeComp = [fcurvePool](StreamWriter& writer, const std::shared_ptr<Composition>& comp)
 				{
-					comp->InternalFilePosition = writer.GetPosition();
+					comp->InternalFilePosition = writer.GetPositionOffsetAware();
 					if (comp->Layers.size() > 0)
 					{
-						writer.WriteU32(static_cast<u32>(comp->Layers.size()));
-						writer.WriteFuncPtr([&comp](StreamWriter& writer)
+						writer.WriteSize(comp->Layers.size());
+						writer.WriteFuncPtr([&comp, fcurvePool](StreamWriter& writer)
 						{
 							for (auto& layer : comp->Layers)
 							{
-								layer->InternalFilePosition = writer.GetPosition();
+								layer->InternalFilePosition = writer.GetPositionOffsetAware();
 								writer.WriteStrPtr(layer->Name);
 								writer.WriteF32(layer->StartFrame);
 								writer.WriteF32(layer->EndFrame);
@@ -599,6 +1103,8 @@ namespace Comfy::Aet
 								WriteFlagsBitfieldStruct<LayerFlags>(writer, layer->Flags);
 								writer.WriteU8(static_cast<u8>(layer->Quality));
 								writer.WriteU8(static_cast<u8>(layer->ItemType));
+								if (writer.GetPtrSize() == PtrSize::Mode64Bit)
+									writer.WriteU32(0x00000000);
 
 								FileAddr itemFileOffset = FileAddr::NullPtr;
 								if (layer->ItemType == ItemType::Video && layer->GetVideoItem() != nullptr)
@@ -634,39 +1140,43 @@ namespace Comfy::Aet
 
 								if (layer->Markers.size() > 0)
 								{
-									writer.WriteU32(static_cast<u32>(layer->Markers.size()));
+									writer.WriteSize(layer->Markers.size());
 									writer.WriteFuncPtr([&layer](StreamWriter& writer)
 									{
 										for (auto& marker : layer->Markers)
 										{
 											writer.WriteF32(marker->Frame);
+											if (writer.GetPtrSize() == PtrSize::Mode64Bit)
+												writer.WriteU32(0x00000000);
 											writer.WriteStrPtr(marker->Name);
 										}
 									});
 								}
 								else
 								{
-									writer.WriteU32(0x00000000);
+									writer.WriteSize(0);
 									writer.WritePtr(FileAddr::NullPtr);
 								}
 
 								if (layer->LayerVideo != nullptr)
 								{
 									LayerVideo& layerVideo = *layer->LayerVideo;
-									writer.WriteFuncPtr([&layerVideo](StreamWriter& writer)
+									writer.WriteFuncPtr([&layerVideo, fcurvePool](StreamWriter& writer)
 									{
 										writer.WriteU8(static_cast<u8>(layerVideo.TransferMode.BlendMode));
 										WriteFlagsBitfieldStruct<TransferFlags>(writer, layerVideo.TransferMode.Flags);
 										writer.WriteU8(static_cast<u8>(layerVideo.TransferMode.TrackMatte));
 										writer.WriteU8(0xCC);
+										if (writer.GetPtrSize() == PtrSize::Mode64Bit)
+											writer.WriteU32(0x00000000);
 
-										WriteLayerVideo2D(writer, layerVideo.Transform);
+										WriteLayerVideo2D(writer, layerVideo.Transform, fcurvePool);
 
 										if (layerVideo.Transform3D != nullptr)
 										{
-											writer.WriteFuncPtr([&layerVideo](StreamWriter& writer)
+											writer.WriteFuncPtr([&layerVideo, fcurvePool](StreamWriter& writer)
 											{
-												WriteLayerVideo3D(writer, *layerVideo.Transform3D);
+												WriteLayerVideo3D(writer, *layerVideo.Transform3D, fcurvePool);
 												writer.WriteAlignmentPadding(16);
 											});
 										}
@@ -692,7 +1202,7 @@ namespace Comfy::Aet
 					}
 					else
 					{
-						writer.WriteU32(0x00000000);
+						writer.WriteSize(0);
 						writer.WritePtr(FileAddr::NullPtr);
 					}
 				};
@@ -706,12 +1216,12 @@ namespace Comfy::Aet
 
 			if (!Videos.empty())
 			{
-				writer.WriteU32(static_cast<u32>(Videos.size()));
+				writer.WriteSize(Videos.size());
 				writer.WriteFuncPtr([this](StreamWriter& writer)
 				{
 					for (auto& video : Videos)
 					{
-						video->InternalFilePosition = writer.GetPosition();
+						video->InternalFilePosition = writer.GetPositionOffsetAware();
 						writer.WriteU32(video->Color);
 						writer.WriteI16(static_cast<i16>(video->Size.x));
 						writer.WriteI16(static_cast<i16>(video->Size.y));
@@ -725,6 +1235,8 @@ namespace Comfy::Aet
 								{
 									writer.WriteStrPtr(source.Name);
 									writer.WriteU32(static_cast<u32>(source.ID));
+									if (writer.GetPtrSize() == PtrSize::Mode64Bit)
+										writer.WriteU32(0x00000000);
 								}
 							});
 						}
@@ -739,18 +1251,18 @@ namespace Comfy::Aet
 			}
 			else
 			{
-				writer.WriteU32(0x00000000);
+				writer.WriteSize(0);
 				writer.WritePtr(FileAddr::NullPtr);
 			}
 
 			if (Audios.size() > 0)
 			{
-				writer.WriteU32(static_cast<u32>(Audios.size()));
+				writer.WriteSize(Audios.size());
 				writer.WriteFuncPtr([this](StreamWriter& writer)
 				{
 					for (auto& audio : Audios)
 					{
-						audio->InternalFilePosition = writer.GetPosition();
+						audio->InternalFilePosition = writer.GetPositionOffsetAware();
 						writer.WriteU32(audio->SoundID);
 					}
 					writer.WriteAlignmentPadding(16);
@@ -758,7 +1270,7 @@ namespace Comfy::Aet
 			}
 			else
 			{
-				writer.WriteU32(0x00000000);
+				writer.WriteSize(0);
 				writer.WritePtr(FileAddr::NullPtr);
 			}
 
@@ -766,17 +1278,808 @@ namespace Comfy::Aet
 		});
 	}
 
-	StreamResult AetSet::Read(StreamReader& reader)
+	// NOTE: Two pass AetSet writer producing the exact same output as writing all scenes through Scene::Write and flushing the writer pools.
+	//		 The layout pass visits every block (pointed to data structure) of a scene in first in first out order, recording its size and pointer fields.
+	//		 Each scene is laid out independently using scene local block indices, so all scenes can be laid out concurrently.
+	//		 The scene layouts are then merged by assigning final offsets depth by depth and scene by scene, which is the order the pointer pool flushes them in.
+	//		 This pass also resolves the FCurve duplicates, pooled strings and file positions. Finally, the fill pass writes each scene's blocks
+	//		 into a single preallocated buffer at their final offsets, without seeking and again with every scene independent of all others
+	struct AetSetLayout
 	{
-		const auto baseHeader = SectionHeader::TryRead(reader, SectionSignature::AETC);
-		SectionHeader::ScanPOFSectionsForPtrSize(reader);
+		enum class BlockType : u8
+		{
+			Scene,
+			Camera,
+			Compositions,
+			Layers,
+			Markers,
+			LayerVideo,
+			LayerVideo3D,
+			FCurveKeys,
+			Videos,
+			VideoSources,
+			Audios,
+		};
 
-		if (baseHeader.has_value())
+		struct Block
 		{
-			reader.SetEndianness(baseHeader->Endianness);
-			reader.Seek(baseHeader->StartOfSubSectionAddress());
+			BlockType Type;
+			// NOTE: Set for FCurveKeys blocks identical to a previous one, which aren't written themselves and share the offset of the first instead
+			b8 IsDuplicate;
+			// NOTE: Padding only ever follows the block content with its size depending on the final absolute position
+			i32 EndAlignment;
+			// NOTE: Number of pointers between the scene table and this block
+			u32 Depth;
+			void* Object;
+			size_t ContentSize;
+			size_t Offset;
+			u32 FirstPointerIndex, PointerCount;
+			u32 KeyDataHash;
+		};
 
-			if (reader.GetPtrSize() == PtrSize::Mode64Bit)
+		enum class PointerType : u8
+		{
+			Block,
+			String,
+			FilePosition,
+		};
+
+		// NOTE: Non null pointer field within a block
+		struct Pointer
+		{
+			PointerType Type;
+			u32 BlockPosition;
+			u32 TargetBlockIndex;
+			const FileAddr* TargetFilePosition;
+			std::string_view String;
+			FileAddr StringOffset;
+		};
+
+		struct FilePositionEntry
+		{
+			u32 BlockIndex;
+			u32 BlockPosition;
+			FileAddr* Target;
+		};
+
+		struct SceneLayout
+		{
+			std::vector<Block> Blocks;
+			std::vector<Pointer> Pointers;
+			std::vector<FilePositionEntry> FilePositions;
+			// NOTE: Absolute stream positions of all pointer fields written by the fill pass
+			std::vector<FileAddr> PointerAddresses;
+		};
+
+		struct StringEntry
+		{
+			size_t Offset;
+			std::string_view String;
+		};
+
+		b8 Is64, IsBE;
+		b8 EmptyNullStringPointers;
+		FileAddr BasePosition, BaseOffsetAwarePosition;
+
+		std::vector<SceneLayout> Scenes;
+		// NOTE: All unique strings in file order, written after the last block
+		std::vector<StringEntry> Strings;
+		size_t DataSize;
+
+		inline size_t GetPtrSize() const { return Is64 ? sizeof(u64) : sizeof(u32); }
+		inline FileAddr ToOffsetAware(size_t position) const { return BaseOffsetAwarePosition + static_cast<FileAddr>(position); }
+		inline size_t AlignPosition(size_t position, size_t alignment) const
+		{
+			// NOTE: Aligned by the absolute stream position, same as StreamWriter::WriteAlignmentPadding()
+			const size_t absolutePosition = (static_cast<size_t>(BasePosition) + position);
+			return position + (((absolutePosition + (alignment - 1)) & ~(alignment - 1)) - absolutePosition);
+		}
+	};
+
+	// NOTE: Shared by both passes so that the layout is guaranteed to match the data written
+	template <typename PassType>
+	static void WriteLayoutBlock(PassType& writer, const AetSetLayout::Block& block)
+	{
+		using BlockType = AetSetLayout::BlockType;
+
+		switch (block.Type)
+		{
+		case BlockType::Scene:
+		{
+			Scene& scene = *static_cast<Scene*>(block.Object);
+			writer.WriteStrPtr(scene.Name);
+			writer.WriteF32(scene.StartFrame);
+			writer.WriteF32(scene.EndFrame);
+			writer.WriteF32(scene.FrameRate);
+			writer.WriteU32(scene.BackgroundColor);
+			writer.WriteI32(scene.Resolution.x);
+			writer.WriteI32(scene.Resolution.y);
+
+			if (scene.Camera != nullptr)
+				writer.WriteBlockPtr(BlockType::Camera, scene.Camera.get());
+			else
+				writer.WriteNullPtr();
+
+			assert(scene.RootComposition != nullptr);
+			writer.WriteSize(scene.Compositions.size() + 1);
+			writer.WriteBlockPtr(BlockType::Compositions, &scene);
+
+			if (!scene.Videos.empty())
+			{
+				writer.WriteSize(scene.Videos.size());
+				writer.WriteBlockPtr(BlockType::Videos, &scene);
+			}
+			else
+			{
+				writer.WriteSize(0);
+				writer.WriteNullPtr();
+			}
+
+			if (!scene.Audios.empty())
+			{
+				writer.WriteSize(scene.Audios.size());
+				writer.WriteBlockPtr(BlockType::Audios, &scene);
+			}
+			else
+			{
+				writer.WriteSize(0);
+				writer.WriteNullPtr();
+			}
+
+			writer.WriteAlignmentPadding(16);
+			break;
+		}
+		case BlockType::Camera:
+		{
+			// NOTE: Including the duplicate position written by Scene::Write
+			Camera& camera = *static_cast<Camera*>(block.Object);
+			for (const FCurve3D* fcurve3D : { &camera.Eye, &camera.Position, &camera.Position, &camera.Direction, &camera.Rotation })
+			{
+				writer.WriteFCurvePtr(fcurve3D->X);
+				writer.WriteFCurvePtr(fcurve3D->Y);
+				writer.WriteFCurvePtr(fcurve3D->Z);
+			}
+			writer.WriteFCurvePtr(camera.Zoom);
+			break;
+		}
+		case BlockType::Compositions:
+		{
+			static_cast<Scene*>(block.Object)->ForEachComp([&](const std::shared_ptr<Composition>& comp)
+			{
+				writer.SetFilePosition(comp->InternalFilePosition);
+				if (!comp->Layers.empty())
+				{
+					writer.WriteSize(comp->Layers.size());
+					writer.WriteBlockPtr(BlockType::Layers, comp.get());
+				}
+				else
+				{
+					writer.WriteSize(0);
+					writer.WriteNullPtr();
+				}
+			});
+
+			writer.WriteAlignmentPadding(16);
+			break;
+		}
+		case BlockType::Layers:
+		{
+			for (auto& layer : static_cast<Composition*>(block.Object)->Layers)
+			{
+				writer.SetFilePosition(layer->InternalFilePosition);
+				writer.WriteStrPtr(layer->Name);
+				writer.WriteF32(layer->StartFrame);
+				writer.WriteF32(layer->EndFrame);
+				writer.WriteF32(layer->StartOffset);
+				writer.WriteF32(layer->TimeScale);
+				WriteFlagsBitfieldStruct<LayerFlags>(writer, layer->Flags);
+				writer.WriteU8(static_cast<u8>(layer->Quality));
+				writer.WriteU8(static_cast<u8>(layer->ItemType));
+				if (writer.GetPtrSize() == PtrSize::Mode64Bit)
+					writer.WriteU32(0x00000000);
+
+				const FileAddr* itemFilePosition = nullptr;
+				if (layer->ItemType == ItemType::Video && layer->GetVideoItem() != nullptr)
+					itemFilePosition = &layer->GetVideoItem()->InternalFilePosition;
+				else if (layer->ItemType == ItemType::Audio && layer->GetAudioItem() != nullptr)
+					itemFilePosition = &layer->GetAudioItem()->InternalFilePosition;
+				else if (layer->ItemType == ItemType::Composition && layer->GetCompItem() != nullptr)
+					itemFilePosition = &layer->GetCompItem()->InternalFilePosition;
+
+				if (itemFilePosition != nullptr)
+					writer.WriteDelayedPtr(*itemFilePosition);
+				else
+					writer.WriteNullPtr();
+
+				if (layer->GetRefParentLayer() != nullptr)
+					writer.WriteDelayedPtr(layer->GetRefParentLayer()->InternalFilePosition);
+				else
+					writer.WriteNullPtr();
+
+				if (!layer->Markers.empty())
+				{
+					writer.WriteSize(layer->Markers.size());
+					writer.WriteBlockPtr(BlockType::Markers, layer.get());
+				}
+				else
+				{
+					writer.WriteSize(0);
+					writer.WriteNullPtr();
+				}
+
+				if (layer->LayerVideo != nullptr)
+					writer.WriteBlockPtr(BlockType::LayerVideo, layer->LayerVideo.get());
+				else
+					writer.WriteNullPtr();
+
+				// TODO: audioDataFilePtr
+				writer.WriteNullPtr();
+			}
+
+			writer.WriteAlignmentPadding(16);
+			break;
+		}
+		case BlockType::Markers:
+		{
+			for (auto& marker : static_cast<Layer*>(block.Object)->Markers)
+			{
+				writer.WriteF32(marker->Frame);
+				if (writer.GetPtrSize() == PtrSize::Mode64Bit)
+					writer.WriteU32(0x00000000);
+				writer.WriteStrPtr(marker->Name);
+			}
+			break;
+		}
+		case BlockType::LayerVideo:
+		{
+			LayerVideo& layerVideo = *static_cast<LayerVideo*>(block.Object);
+			writer.WriteU8(static_cast<u8>(layerVideo.TransferMode.BlendMode));
+			WriteFlagsBitfieldStruct<TransferFlags>(writer, layerVideo.TransferMode.Flags);
+			writer.WriteU8(static_cast<u8>(layerVideo.TransferMode.TrackMatte));
+			writer.WriteU8(0xCC);
+			if (writer.GetPtrSize() == PtrSize::Mode64Bit)
+				writer.WriteU32(0x00000000);
+
+			for (Transform2DField field = 0; field < Transform2DField_Count; field++)
+				writer.WriteFCurvePtr(layerVideo.Transform[field]);
+
+			if (layerVideo.Transform3D != nullptr)
+				writer.WriteBlockPtr(BlockType::LayerVideo3D, layerVideo.Transform3D.get());
+			else
+				writer.WriteNullPtr();
+
+			writer.WriteAlignmentPadding(16);
+			break;
+		}
+		case BlockType::LayerVideo3D:
+		{
+			LayerVideo3D& transform3D = *static_cast<LayerVideo3D*>(block.Object);
+			for (size_t i = 0; i < LayerVideo3D::CurveCount; i++)
+				writer.WriteFCurvePtr(transform3D[i]);
+
+			writer.WriteAlignmentPadding(16);
+			break;
+		}
+		case BlockType::FCurveKeys:
+		{
+			const FCurve& fcurve = *static_cast<const FCurve*>(block.Object);
+			if (fcurve->size() == 1)
+			{
+				writer.WriteF32(fcurve->front().Value);
+			}
+			else
+			{
+				for (auto& keyFrame : fcurve.Keys)
+					writer.WriteF32(keyFrame.Frame);
+
+				for (auto& keyFrame : fcurve.Keys)
+				{
+					writer.WriteF32(keyFrame.Value);
+					writer.WriteF32(keyFrame.Tangent);
+				}
+			}
+			break;
+		}
+		case BlockType::Videos:
+		{
+			for (auto& video : static_cast<Scene*>(block.Object)->Videos)
+			{
+				writer.SetFilePosition(video->InternalFilePosition);
+				writer.WriteU32(video->Color);
+				writer.WriteI16(static_cast<i16>(video->Size.x));
+				writer.WriteI16(static_cast<i16>(video->Size.y));
+				writer.WriteF32(video->FilesPerFrame);
+
+				if (!video->Sources.empty())
+				{
+					writer.WriteU32(static_cast<u32>(video->Sources.size()));
+					writer.WriteBlockPtr(BlockType::VideoSources, video.get());
+				}
+				else
+				{
+					writer.WriteU32(0x00000000);
+					writer.WriteNullPtr();
+				}
+			}
+
+			writer.WriteAlignmentPadding(16);
+			break;
+		}
+		case BlockType::VideoSources:
+		{
+			for (auto& source : static_cast<Video*>(block.Object)->Sources)
+			{
+				writer.WriteStrPtr(source.Name);
+				writer.WriteU32(static_cast<u32>(source.ID));
+				if (writer.GetPtrSize() == PtrSize::Mode64Bit)
+					writer.WriteU32(0x00000000);
+			}
+			break;
+		}
+		case BlockType::Audios:
+		{
+			for (auto& audio : static_cast<Scene*>(block.Object)->Audios)
+			{
+				writer.SetFilePosition(audio->InternalFilePosition);
+				writer.WriteU32(audio->SoundID);
+			}
+
+			writer.WriteAlignmentPadding(16);
+			break;
+		}
+		}
+	}
+
+	struct AetSceneLayoutPass : NonCopyable
+	{
+		AetSceneLayoutPass(const AetSetLayout& layout, AetSetLayout::SceneLayout& out, b8 hashFCurves) : Layout(layout), Out(out), HashFCurves(hashFCurves) {}
+
+		const AetSetLayout& Layout;
+		AetSetLayout::SceneLayout& Out;
+		b8 HashFCurves;
+		std::vector<f32> KeyDataBuffer;
+
+		u32 BlockIndex = 0;
+		size_t Position = 0;
+
+		inline void WriteU8(u8) { Position += sizeof(u8); }
+		inline void WriteU16(u16) { Position += sizeof(u16); }
+		inline void WriteU32(u32) { Position += sizeof(u32); }
+		inline void WriteI16(i16) { Position += sizeof(i16); }
+		inline void WriteI32(i32) { Position += sizeof(i32); }
+		inline void WriteF32(f32) { Position += sizeof(f32); }
+		inline void WriteSize(size_t) { Position += Layout.GetPtrSize(); }
+		inline void WriteNullPtr() { Position += Layout.GetPtrSize(); }
+		inline PtrSize GetPtrSize() const { return Layout.Is64 ? PtrSize::Mode64Bit : PtrSize::Mode32Bit; }
+		inline void WriteAlignmentPadding(i32 alignment) { assert(Out.Blocks[BlockIndex].EndAlignment == 0); Out.Blocks[BlockIndex].EndAlignment = alignment; }
+		inline void SetFilePosition(FileAddr& outFilePosition) { Out.FilePositions.push_back(AetSetLayout::FilePositionEntry { BlockIndex, static_cast<u32>(Position), &outFilePosition }); }
+
+		AetSetLayout::Pointer& AddPointer(AetSetLayout::PointerType type)
+		{
+			AetSetLayout::Pointer& pointer = Out.Pointers.emplace_back();
+			pointer.Type = type;
+			pointer.BlockPosition = static_cast<u32>(Position);
+			Position += Layout.GetPtrSize();
+			return pointer;
+		}
+
+		u32 WriteBlockPtr(AetSetLayout::BlockType type, void* object)
+		{
+			const u32 targetBlockIndex = static_cast<u32>(Out.Blocks.size());
+			Out.Blocks.push_back(AetSetLayout::Block { type, false, 0, Out.Blocks[BlockIndex].Depth + 1, object });
+			AddPointer(AetSetLayout::PointerType::Block).TargetBlockIndex = targetBlockIndex;
+			return targetBlockIndex;
+		}
+
+		void WriteStrPtr(std::string_view value)
+		{
+			if (Layout.EmptyNullStringPointers && value.empty())
+				WriteNullPtr();
+			else
+				AddPointer(AetSetLayout::PointerType::String).String = value;
+		}
+
+		void WriteDelayedPtr(const FileAddr& filePosition)
+		{
+			AddPointer(AetSetLayout::PointerType::FilePosition).TargetFilePosition = &filePosition;
+		}
+
+		void WriteFCurvePtr(const FCurve& in)
+		{
+			if (in->empty())
+			{
+				WriteSize(0);
+				WriteNullPtr();
+				return;
+			}
+
+			WriteSize(in->size());
+			const u32 keysBlockIndex = WriteBlockPtr(AetSetLayout::BlockType::FCurveKeys, const_cast<FCurve*>(&in));
+
+			if (HashFCurves)
+			{
+				GetFCurveKeyData(in, KeyDataBuffer);
+				Out.Blocks[keysBlockIndex].KeyDataHash = MurmurHashU32(std::string_view(reinterpret_cast<cstr>(KeyDataBuffer.data()), KeyDataBuffer.size() * sizeof(f32)));
+			}
+		}
+
+		void Run(Scene& scene)
+		{
+			Out.Blocks.push_back(AetSetLayout::Block { AetSetLayout::BlockType::Scene, false, 0, 1, &scene });
+
+			// NOTE: Blocks are appended while iterating, visiting them in the same first in first out order as StreamWriter::FlushPointerPool()
+			for (BlockIndex = 0; BlockIndex < Out.Blocks.size(); BlockIndex++)
+			{
+				Position = 0;
+				Out.Blocks[BlockIndex].FirstPointerIndex = static_cast<u32>(Out.Pointers.size());
+
+				const AetSetLayout::Block block = Out.Blocks[BlockIndex];
+				WriteLayoutBlock(*this, block);
+
+				Out.Blocks[BlockIndex].ContentSize = Position;
+				Out.Blocks[BlockIndex].PointerCount = static_cast<u32>(Out.Pointers.size()) - block.FirstPointerIndex;
+			}
+		}
+	};
+
+	static b8 IsFCurveKeyDataIdentical(const FCurve& a, const FCurve& b)
+	{
+		const auto bitsEqual = [](f32 left, f32 right) { return std::memcmp(&left, &right, sizeof(f32)) == 0; };
+
+		if (a->size() != b->size())
+			return false;
+		if (a->size() == 1)
+			return bitsEqual(a->front().Value, b->front().Value);
+
+		for (size_t i = 0; i < a->size(); i++)
+		{
+			if (!bitsEqual(a.Keys[i].Frame, b.Keys[i].Frame) || !bitsEqual(a.Keys[i].Value, b.Keys[i].Value) || !bitsEqual(a.Keys[i].Tangent, b.Keys[i].Tangent))
+				return false;
+		}
+		return true;
+	}
+
+	static void MergeSceneLayouts(AetSetLayout& layout, b8 deduplicateFCurves, b8 poolStrings)
+	{
+		using SceneLayout = AetSetLayout::SceneLayout;
+		using Block = AetSetLayout::Block;
+
+		// NOTE: The scene table itself, followed by a null terminator
+		size_t position = layout.AlignPosition((layout.Scenes.size() + 1) * layout.GetPtrSize(), 16);
+
+		size_t remainingBlocks = 0;
+		for (const auto& sceneLayout : layout.Scenes)
+			remainingBlocks += sceneLayout.Blocks.size();
+
+		struct OrderedBlock { SceneLayout* Layout; const Block* Target; };
+		std::vector<OrderedBlock> fileOrder;
+		fileOrder.reserve(remainingBlocks);
+
+		std::vector<size_t> blockCursors(layout.Scenes.size(), 0), filePositionCursors(layout.Scenes.size(), 0);
+		std::unordered_multimap<u32, const Block*> writtenFCurves;
+
+		// NOTE: Scene local blocks are already sorted by depth
+		for (u32 depth = 1; remainingBlocks > 0; depth++)
+		{
+			for (size_t sceneIndex = 0; sceneIndex < layout.Scenes.size(); sceneIndex++)
+			{
+				SceneLayout& sceneLayout = layout.Scenes[sceneIndex];
+				size_t& blockIndex = blockCursors[sceneIndex];
+				size_t& filePositionIndex = filePositionCursors[sceneIndex];
+
+				for (; blockIndex < sceneLayout.Blocks.size() && sceneLayout.Blocks[blockIndex].Depth == depth; blockIndex++, remainingBlocks--)
+				{
+					Block& block = sceneLayout.Blocks[blockIndex];
+					if (deduplicateFCurves && block.Type == AetSetLayout::BlockType::FCurveKeys)
+					{
+						const FCurve& fcurve = *static_cast<const FCurve*>(block.Object);
+						const auto[hashMatchBegin, hashMatchEnd] = writtenFCurves.equal_range(block.KeyDataHash);
+						for (auto it = hashMatchBegin; it != hashMatchEnd; it++)
+						{
+							if (IsFCurveKeyDataIdentical(*static_cast<const FCurve*>(it->second->Object), fcurve))
+							{
+								block.IsDuplicate = true;
+								block.Offset = it->second->Offset;
+								break;
+							}
+						}
+
+						if (block.IsDuplicate)
+							continue;
+						writtenFCurves.emplace(block.KeyDataHash, &block);
+					}
+
+					// NOTE: Same as StreamWriter::FlushPointerPool() so that all 64-bit pointer fields end up naturally aligned
+					if (layout.Is64)
+						position = layout.AlignPosition(position, sizeof(u64));
+
+					block.Offset = position;
+					position += block.ContentSize;
+					if (block.EndAlignment > 0)
+						position = layout.AlignPosition(position, static_cast<size_t>(block.EndAlignment));
+
+					// NOTE: Objects shared between scenes end up with the position of the last one written, same as the pointer pool
+					for (; filePositionIndex < sceneLayout.FilePositions.size() && sceneLayout.FilePositions[filePositionIndex].BlockIndex == blockIndex; filePositionIndex++)
+					{
+						const auto& filePosition = sceneLayout.FilePositions[filePositionIndex];
+						*filePosition.Target = layout.ToOffsetAware(block.Offset + filePosition.BlockPosition);
+					}
+
+					fileOrder.push_back(OrderedBlock { &sceneLayout, &block });
+				}
+			}
+		}
+
+		position = layout.AlignPosition(position, 16);
+
+		std::unordered_map<std::string_view, FileAddr> writtenStrings;
+		for (const auto& ordered : fileOrder)
+		{
+			for (u32 i = 0; i < ordered.Target->PointerCount; i++)
+			{
+				AetSetLayout::Pointer& pointer = ordered.Layout->Pointers[ordered.Target->FirstPointerIndex + i];
+				if (pointer.Type != AetSetLayout::PointerType::String)
+					continue;
+
+				if (poolStrings)
+				{
+					if (auto writtenString = writtenStrings.find(pointer.String); writtenString != writtenStrings.end())
+					{
+						pointer.StringOffset = writtenString->second;
+						continue;
+					}
+					writtenStrings.emplace(pointer.String, layout.ToOffsetAware(position));
+				}
+
+				pointer.StringOffset = layout.ToOffsetAware(position);
+				layout.Strings.push_back(AetSetLayout::StringEntry { position, pointer.String });
+				position += (pointer.String.size() + sizeof('\0'));
+			}
+		}
+
+		layout.DataSize = layout.AlignPosition(position, 16);
+	}
+
+	struct AetSetFillPass
+	{
+		const AetSetLayout& Layout;
+		// NOTE: Only null for writing the scene table
+		AetSetLayout::SceneLayout* SceneLayout;
+		u8* Data;
+		size_t Position;
+		size_t PointerIndex;
+
+		template <typename T>
+		inline void WriteT(T value) { std::memcpy(&Data[Position], &value, sizeof(T)); Position += sizeof(T); }
+
+		inline void WriteU8(u8 value) { WriteT<u8>(value); }
+		inline void WriteU16(u16 value) { WriteT<u16>(Layout.IsBE ? ByteSwapU16(value) : value); }
+		inline void WriteU32(u32 value) { WriteT<u32>(Layout.IsBE ? ByteSwapU32(value) : value); }
+		inline void WriteI16(i16 value) { WriteT<i16>(Layout.IsBE ? ByteSwapI16(value) : value); }
+		inline void WriteI32(i32 value) { WriteT<i32>(Layout.IsBE ? ByteSwapI32(value) : value); }
+		inline void WriteF32(f32 value) { WriteT<f32>(Layout.IsBE ? ByteSwapF32(value) : value); }
+
+		inline void WritePtr(FileAddr value)
+		{
+			if (Layout.Is64)
+				WriteT<i64>(Layout.IsBE ? ByteSwapI64(static_cast<i64>(value)) : static_cast<i64>(value));
+			else
+				WriteT<i32>(Layout.IsBE ? ByteSwapI32(static_cast<i32>(value)) : static_cast<i32>(value));
+		}
+
+		inline void WriteSize(size_t value)
+		{
+			if (Layout.Is64)
+				WriteT<u64>(Layout.IsBE ? ByteSwapU64(static_cast<u64>(value)) : static_cast<u64>(value));
+			else
+				WriteT<u32>(Layout.IsBE ? ByteSwapU32(static_cast<u32>(value)) : static_cast<u32>(value));
+		}
+
+		inline void WriteNullPtr() { WritePtr(FileAddr::NullPtr); }
+		inline PtrSize GetPtrSize() const { return Layout.Is64 ? PtrSize::Mode64Bit : PtrSize::Mode32Bit; }
+		// NOTE: The padding bytes themselves have already been filled in upfront
+		inline void WriteAlignmentPadding(i32) {}
+		inline void SetFilePosition(FileAddr&) {}
+
+		void WriteNextPtr()
+		{
+			const AetSetLayout::Pointer& pointer = SceneLayout->Pointers[PointerIndex++];
+			SceneLayout->PointerAddresses.push_back(Layout.BasePosition + static_cast<FileAddr>(Position));
+
+			if (pointer.Type == AetSetLayout::PointerType::Block)
+				WritePtr(Layout.ToOffsetAware(SceneLayout->Blocks[pointer.TargetBlockIndex].Offset));
+			else if (pointer.Type == AetSetLayout::PointerType::String)
+				WritePtr(pointer.StringOffset);
+			else
+				WritePtr(*pointer.TargetFilePosition);
+		}
+
+		inline void WriteBlockPtr(AetSetLayout::BlockType, void*) { WriteNextPtr(); }
+		inline void WriteStrPtr(std::string_view value) { (Layout.EmptyNullStringPointers && value.empty()) ? WriteNullPtr() : WriteNextPtr(); }
+		inline void WriteDelayedPtr(const FileAddr&) { WriteNextPtr(); }
+
+		inline void WriteFCurvePtr(const FCurve& in)
+		{
+			WriteSize(in->size());
+			(in->empty()) ? WriteNullPtr() : WriteNextPtr();
+		}
+
+		void Run()
+		{
+			for (const auto& block : SceneLayout->Blocks)
+			{
+				if (block.IsDuplicate)
+					continue;
+
+				Position = block.Offset;
+				PointerIndex = block.FirstPointerIndex;
+				WriteLayoutBlock(*this, block);
+			}
+		}
+	};
+
+	static void WriteSetDataUsingLayout(StreamWriter& writer, AetSet& set, b8 deduplicateFCurves, b8 parallel)
+	{
+		AetSetLayout layout = {};
+		layout.Is64 = writer.Is64;
+		layout.IsBE = writer.IsBE;
+		layout.EmptyNullStringPointers = writer.Settings.EmptyNullStringPointers;
+		layout.BasePosition = writer.GetPosition();
+		layout.BaseOffsetAwarePosition = writer.GetPositionOffsetAware();
+		layout.Scenes.resize(set.GetSceneCount());
+
+		const auto forEachScene = [&](auto func)
+		{
+			// NOTE: Without any total work every scene is processed on the calling thread
+			ParallelFor(set.GetSceneCount(), parallel ? set.GetSceneCount() : 0, 1, func);
+		};
+
+		forEachScene([&](size_t i)
+		{
+			AetSceneLayoutPass(layout, layout.Scenes[i], deduplicateFCurves).Run(set.GetScene(i));
+		});
+
+		MergeSceneLayouts(layout, deduplicateFCurves, writer.Settings.PoolStrings);
+
+		auto data = std::make_unique<u8[]>(layout.DataSize);
+		std::memset(data.get(), 0xCC, layout.DataSize);
+
+		forEachScene([&](size_t i)
+		{
+			AetSetFillPass { layout, &layout.Scenes[i], data.get(), 0, 0 }.Run();
+		});
+
+		std::vector<FileAddr> sceneTableAddresses;
+		AetSetFillPass tableFillPass = { layout, nullptr, data.get(), 0, 0 };
+		for (const auto& sceneLayout : layout.Scenes)
+		{
+			sceneTableAddresses.push_back(layout.BasePosition + static_cast<FileAddr>(tableFillPass.Position));
+			tableFillPass.WritePtr(layout.ToOffsetAware(sceneLayout.Blocks.front().Offset));
+		}
+		tableFillPass.WriteNullPtr();
+
+		for (const auto& string : layout.Strings)
+		{
+			std::memcpy(&data[string.Offset], string.String.data(), string.String.size());
+			data[string.Offset + string.String.size()] = '\0';
+		}
+
+		writer.WriteBuffer(data.get(), layout.DataSize);
+
+		writer.WrittenPointerAddresses.insert(writer.WrittenPointerAddresses.end(), sceneTableAddresses.begin(), sceneTableAddresses.end());
+		for (const auto& sceneLayout : layout.Scenes)
+			writer.WrittenPointerAddresses.insert(writer.WrittenPointerAddresses.end(), sceneLayout.PointerAddresses.begin(), sceneLayout.PointerAddresses.end());
+	}
+
+	static void ReadLinkScene(StreamReader& reader, FileAddr sceneOffset, const std::shared_ptr<NodeArena>& arena, Scene& scene)
+	{
+		reader.ReadAtOffsetAware(sceneOffset, [&](StreamReader& reader)
+		{
+			scene.Read(reader, arena);
+		});
+
+		scene.InternalUpdateParentPointers();
+		scene.InternalLinkPostRead();
+		scene.InternalUpdateCompNamesAfterLayerItems();
+	}
+
+	// NOTE: File data and reader state needed to read the remaining scenes of a lazily read AetSet, indexed the same as the scenes
+	struct AetSet::LazySceneSource : NonCopyable
+	{
+		LazySceneSource(const StreamReader& reader, std::shared_ptr<NodeArena> arena) : Reader(reader), Arena(std::move(arena))
+		{
+			if (auto* memoryStream = dynamic_cast<MemoryStream*>(reader.Stream); memoryStream != nullptr)
+				Data = memoryStream->ShareDataVector();
+
+			if (Data == nullptr)
+			{
+				Data = std::make_shared<std::vector<u8>>(static_cast<size_t>(reader.GetLength()));
+				Reader.ReadAt(FileAddr::NullPtr, [&](StreamReader& reader) { reader.ReadBuffer(Data->data(), Data->size()); });
+			}
+
+			Stream.FromStreamSource(*Data);
+			Reader.Stream = &Stream;
+		}
+
+		std::mutex Mutex;
+		std::shared_ptr<std::vector<u8>> Data;
+		MemoryStream Stream;
+		StreamReader Reader;
+		std::shared_ptr<NodeArena> Arena;
+		std::vector<std::optional<FileAddr>> PendingSceneOffsets;
+		size_t PendingSceneCount = 0;
+	};
+
+	Scene& AetSet::GetScene(size_t index)
+	{
+		LoadSceneIfPending(index);
+		return *scenes[index];
+	}
+
+	const Scene& AetSet::GetScene(size_t index) const
+	{
+		LoadSceneIfPending(index);
+		return *scenes[index];
+	}
+
+	b8 AetSet::IsSceneLoaded(size_t index) const
+	{
+		if (lazySceneSource == nullptr)
+			return true;
+
+		std::lock_guard<std::mutex> lock(lazySceneSource->Mutex);
+		return (index >= lazySceneSource->PendingSceneOffsets.size()) || !lazySceneSource->PendingSceneOffsets[index].has_value();
+	}
+
+	void AetSet::LoadAllScenes()
+	{
+		for (size_t i = 0; i < scenes.size() && lazySceneSource != nullptr; i++)
+			LoadSceneIfPending(i);
+
+		lazySceneSource = nullptr;
+	}
+
+	Scene& AetSet::AddScene(std::shared_ptr<Scene> scene)
+	{
+		assert(scene != nullptr);
+		return *scenes.emplace_back(std::move(scene));
+	}
+
+	void AetSet::LoadSceneIfPending(size_t index) const
+	{
+		// NOTE: The source itself is only ever reset by non-const member functions, so concurrent const access only has to synchronize the pending scenes
+		if (lazySceneSource == nullptr)
+			return;
+
+		LazySceneSource& source = *lazySceneSource;
+		std::lock_guard<std::mutex> lock(source.Mutex);
+
+		if (index >= source.PendingSceneOffsets.size() || !source.PendingSceneOffsets[index].has_value())
+			return;
+
+		ReadLinkScene(source.Reader, *source.PendingSceneOffsets[index], source.Arena, *scenes[index]);
+		source.PendingSceneOffsets[index].reset();
+
+		// NOTE: Release the file data as soon as it is no longer needed, while keeping the now empty source itself alive for any other concurrent callers
+		if (--source.PendingSceneCount == 0)
+		{
+			source.Stream.Close();
+			source.Data = nullptr;
+		}
+	}
+
+	StreamResult AetSet::Read(StreamReader& reader)
+	{
+		auto baseHeader = SectionHeader::TryRead(reader, SectionSignature::AETC);
+		SectionHeader::ScanPOFSectionsForPtrSize(reader);
+		SectionByteSwapScope byteSwapScope { reader, baseHeader };
+
+		if (baseHeader.has_value())
+		{
+			reader.SetEndianness(baseHeader->Endianness);
+			reader.Seek(baseHeader->StartOfSubSectionAddress());
+
+			if (reader.GetPtrSize() == PtrSize::Mode64Bit)
 				reader.PushBaseOffset();
 		}
 
@@ -787,22 +2090,81 @@ namespace Comfy::Aet
 				sceneCount++;
 		});
 
-		Scenes.reserve(sceneCount);
+		std::vector<FileAddr> sceneOffsets;
+		sceneOffsets.reserve(sceneCount);
 		for (size_t i = 0; i < sceneCount; i++)
+			sceneOffsets.push_back(reader.ReadPtr());
+
+		// NOTE: In-memory nodes are larger than their file counterparts but key frames and strings are allocated separately, so the file size makes for a reasonable first block size
+		const auto makeArena = [&](size_t sceneArenaCount) { return Settings.UseNodeArena ? std::make_shared<NodeArena>(static_cast<size_t>(reader.GetLength()) / sceneArenaCount) : nullptr; };
+
+		// NOTE: Scenes never reference each other's data, so they can be read independently as long as every thread uses its own stream position and arena
+		auto* memoryStream = dynamic_cast<MemoryStream*>(reader.Stream);
+
+		lazySceneSource = nullptr;
+		if (Settings.LazySceneRead)
 		{
-			const auto sceneOffset = reader.ReadPtr();
-			if (!reader.IsValidPointer(sceneOffset))
-				return StreamResult::BadPointer;
+			for (const auto sceneOffset : sceneOffsets)
+			{
+				if (!reader.IsValidPointer(sceneOffset))
+					return StreamResult::BadPointer;
+			}
 
-			auto& scene = *Scenes.emplace_back(std::make_shared<Scene>());
-			reader.ReadAtOffsetAware(sceneOffset, [&](StreamReader& reader)
+			lazySceneSource = std::make_shared<LazySceneSource>(reader, makeArena(1));
+			lazySceneSource->PendingSceneOffsets.resize(scenes.size());
+
+			scenes.reserve(scenes.size() + sceneCount);
+			for (const auto sceneOffset : sceneOffsets)
 			{
-				scene.Read(reader);
-			});
+				auto& scene = scenes.emplace_back(MakeNode<Scene>(lazySceneSource->Arena));
+				reader.ReadAtOffsetAware(sceneOffset, [&](StreamReader& reader) { scene->InternalReadHeader(reader); });
+				lazySceneSource->PendingSceneOffsets.push_back(sceneOffset);
+				lazySceneSource->PendingSceneCount++;
+			}
+		}
+		else if (Settings.ParallelSceneRead && sceneCount > 1 && memoryStream != nullptr)
+		{
+			for (const auto sceneOffset : sceneOffsets)
+			{
+				if (!reader.IsValidPointer(sceneOffset))
+					return StreamResult::BadPointer;
+			}
+
+			scenes.reserve(sceneCount);
+			std::vector<std::future<void>> sceneFutures;
+			sceneFutures.reserve(sceneCount);
 
-			scene.InternalUpdateParentPointers();
-			scene.InternalLinkPostRead();
-			scene.InternalUpdateCompNamesAfterLayerItems();
+			for (size_t i = 0; i < sceneCount; i++)
+			{
+				const auto arena = makeArena(sceneCount);
+				auto& scene = scenes.emplace_back(MakeNode<Scene>(arena));
+
+				sceneFutures.push_back(std::async(std::launch::async, [&, arena, sceneOffset = sceneOffsets[i], scene = scene.get()]
+				{
+					MemoryStream sceneStream;
+					sceneStream.FromStreamSource(memoryStream->GetDataVector());
+
+					StreamReader sceneReader = reader;
+					sceneReader.Stream = &sceneStream;
+					ReadLinkScene(sceneReader, sceneOffset, arena, *scene);
+				}));
+			}
+
+			for (auto& future : sceneFutures)
+				future.wait();
+		}
+		else
+		{
+			const auto arena = makeArena(1);
+
+			scenes.reserve(sceneCount);
+			for (const auto sceneOffset : sceneOffsets)
+			{
+				if (!reader.IsValidPointer(sceneOffset))
+					return StreamResult::BadPointer;
+
+				ReadLinkScene(reader, sceneOffset, arena, *scenes.emplace_back(MakeNode<Scene>(arena)));
+			}
 		}
 
 		if (baseHeader.has_value() && reader.GetPtrSize() == PtrSize::Mode64Bit)
@@ -813,22 +2175,46 @@ namespace Comfy::Aet
 
 	StreamResult AetSet::Write(StreamWriter& writer)
 	{
-		for (auto& scene : Scenes)
+		LoadAllScenes();
+
+		// NOTE: Shared by all scenes so that duplicates are found across the entire set
+		FCurveWritePool fcurvePool;
+
+		const auto writeSetData = [this, &fcurvePool](StreamWriter& writer)
 		{
-			assert(scene != nullptr);
-			scene->Write(writer);
-		}
+			if (Settings.PrecomputedLayoutWrite)
+			{
+				WriteSetDataUsingLayout(writer, *this, Settings.DeduplicateFCurves, Settings.ParallelSceneWrite);
+				return;
+			}
 
-		writer.WritePtr(FileAddr::NullPtr);
-		writer.WriteAlignmentPadding(16);
+			for (auto& scene : scenes)
+			{
+				assert(scene != nullptr);
+				scene->Write(writer, Settings.DeduplicateFCurves ? &fcurvePool : nullptr);
+			}
 
-		writer.FlushPointerPool();
-		writer.WriteAlignmentPadding(16);
+			writer.WritePtr(FileAddr::NullPtr);
+			writer.WriteAlignmentPadding(16);
 
-		writer.FlushStringPointerPool();
-		writer.WriteAlignmentPadding(16);
+			writer.FlushPointerPool();
+			writer.WriteAlignmentPadding(16);
+
+			writer.FlushStringPointerPool();
+			writer.WriteAlignmentPadding(16);
+
+			writer.FlushDelayedWritePool();
+		};
 
-		writer.FlushDelayedWritePool();
+		if (writer.HasSections)
+		{
+			SectionHeader::WriteSection(writer, SectionSignature::AETC, writeSetData);
+			SectionHeader::WriteEndOfFileSection(writer);
+		}
+		else
+		{
+			writeSetData(writer);
+		}
 
 		return StreamResult::Success;
 	}
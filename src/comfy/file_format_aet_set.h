@@ -3,6 +3,10 @@
 #include "file_format_common.h"
 #include "file_format_db.h"
 #include <optional>
+#include <memory_resource>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
 
 namespace Comfy
 {
@@ -57,6 +61,34 @@ namespace Comfy::Aet
 	struct Video;
 	struct Composition;
 
+	// NOTE: Monotonic memory resource the scene graph nodes of a read AetSet are allocated from, turning the many small individual node allocations
+	//		 into a few large blocks which are released all at once. Each node allocated from it keeps it alive, so nodes may still safely outlive their AetSet
+	struct NodeArena : NonCopyable
+	{
+		explicit NodeArena(size_t initialSize) : Resource(initialSize) {}
+		std::pmr::monotonic_buffer_resource Resource;
+	};
+
+	template <typename T>
+	struct NodeArenaAllocator
+	{
+		using value_type = T;
+		std::shared_ptr<NodeArena> Arena;
+
+		explicit NodeArenaAllocator(std::shared_ptr<NodeArena> arena) : Arena(std::move(arena)) {}
+		template <typename U> NodeArenaAllocator(const NodeArenaAllocator<U>& other) : Arena(other.Arena) {}
+
+		inline T* allocate(size_t count) { return static_cast<T*>(Arena->Resource.allocate(count * sizeof(T), alignof(T))); }
+		inline void deallocate(T* pointer, size_t count) { Arena->Resource.deallocate(pointer, count * sizeof(T), alignof(T)); }
+
+		template <typename U> inline b8 operator==(const NodeArenaAllocator<U>& other) const { return Arena == other.Arena; }
+		template <typename U> inline b8 operator!=(const NodeArenaAllocator<U>& other) const { return Arena != other.Arena; }
+	};
+
+	// NOTE: Falls back to a regular std::make_shared() for a null arena
+	template <typename T>
+	inline std::shared_ptr<T> MakeNode(const std::shared_ptr<NodeArena>& arena) { return (arena != nullptr) ? std::allocate_shared<T>(NodeArenaAllocator<T>(arena)) : std::make_shared<T>(); }
+
 	struct VideoSource
 	{
 		std::string Name;
@@ -151,6 +183,19 @@ namespace Comfy::Aet
 	f32 InterpolateHermite(const KeyFrame& start, const KeyFrame& end, frame_t frame);
 	f32 SampleFCurveAt(const std::vector<KeyFrame>& keys, frame_t frame);
 
+	// NOTE: Remembers the key pair used by the previous sample so that sampling the same curve at monotonically increasing frames
+	//		 only has to step forward instead of searching through all keys each time. Any other access pattern falls back to a binary search
+	struct FCurveCursor
+	{
+		size_t EndKeyIndex = 1;
+	};
+
+	f32 SampleFCurveAt(const std::vector<KeyFrame>& keys, frame_t frame, FCurveCursor& cursor);
+
+	// NOTE: Samples frameCount values at (startFrame + i * step) for a positive step, walking the curve segments only once.
+	//		 Matches SampleFCurveAt() within float tolerance while interpolating multiple frames at once using SSE
+	void SampleFCurveRange(const std::vector<KeyFrame>& keys, frame_t startFrame, size_t frameCount, frame_t step, f32* outValues);
+
 	struct KeyFrame
 	{
 		frame_t Frame = 0.0f;
@@ -168,6 +213,8 @@ namespace Comfy::Aet
 		std::vector<KeyFrame> Keys;
 
 		inline f32 SampleAt(frame_t frame) const { return SampleFCurveAt(Keys, frame); }
+		inline f32 SampleAt(frame_t frame, FCurveCursor& cursor) const { return SampleFCurveAt(Keys, frame, cursor); }
+		inline void SampleRange(frame_t startFrame, size_t frameCount, frame_t step, f32* outValues) const { SampleFCurveRange(Keys, startFrame, frameCount, step, outValues); }
 		inline std::vector<KeyFrame>* operator->() { return &Keys; }
 		inline const std::vector<KeyFrame>* operator->() const { return &Keys; }
 	};
@@ -194,6 +241,9 @@ namespace Comfy::Aet
 
 		inline FCurve& operator[](Transform2DField field) { assert(field < Transform2DField_Count); return (&Origin.X)[field]; }
 		inline const FCurve& operator[](Transform2DField field) const { assert(field < Transform2DField_Count); return (&Origin.X)[field]; }
+
+		// NOTE: Writes frameCount values for each field, one field after another in Transform2DField order
+		void SampleRange(frame_t startFrame, size_t frameCount, frame_t step, f32* outValues) const;
 	};
 
 	struct LayerVideo3D
@@ -203,6 +253,14 @@ namespace Comfy::Aet
 		FCurve3D DirectionXYZ;
 		FCurve2D RotationXY;
 		FCurve ScaleZ;
+
+		// NOTE: OriginZ, PositionZ, DirectionXYZ.X/Y/Z, RotationXY.X/Y, ScaleZ
+		static constexpr size_t CurveCount = 8;
+		inline FCurve& operator[](size_t index) { assert(index < CurveCount); return (&OriginZ)[index]; }
+		inline const FCurve& operator[](size_t index) const { assert(index < CurveCount); return (&OriginZ)[index]; }
+
+		// NOTE: Writes frameCount values for each curve, one curve after another in member order
+		void SampleRange(frame_t startFrame, size_t frameCount, frame_t step, f32* outValues) const;
 	};
 
 	struct LayerVideo
@@ -324,7 +382,103 @@ namespace Comfy::Aet
 		inline Composition* GetParentComposition() { return InternalParentComposition; }
 		inline const Composition* GetParentComposition() const { return InternalParentComposition; }
 
-		void Read(StreamReader& reader);
+		void Read(StreamReader& reader, const std::shared_ptr<NodeArena>& arena = nullptr);
+	};
+
+	// NOTE: Valid state of a lookup built on first use from within const functions. Concurrent first uses build it only once while later uses don't have to lock.
+	//		 Invalidating it however has to be synchronized with all uses the same way any other edit of the data it is built from would be.
+	//		 Copies start out invalid since the copied lookup would still reference the objects of the original owner
+	struct LazyBuildGuard
+	{
+		std::atomic<b8> IsValid = false;
+		std::mutex BuildMutex;
+
+		LazyBuildGuard() = default;
+		LazyBuildGuard(const LazyBuildGuard&) {}
+		inline LazyBuildGuard& operator=(const LazyBuildGuard&) { Invalidate(); return *this; }
+
+		inline void Invalidate() { IsValid.store(false, std::memory_order_release); }
+
+		template <typename BuildFunc>
+		void BuildIfInvalid(BuildFunc buildFunc)
+		{
+			if (IsValid.load(std::memory_order_acquire))
+				return;
+
+			const std::lock_guard<std::mutex> lock(BuildMutex);
+			if (IsValid.load(std::memory_order_relaxed))
+				return;
+
+			buildFunc();
+			IsValid.store(true, std::memory_order_release);
+		}
+	};
+
+	// NOTE: Lazily built name to layer and marker name to layer lookup backing the FindLayer functions of a Scene or Composition.
+	//		 Entries are keyed by name hash and compared against the current name on lookup so a stale lookup never returns a wrongly named layer,
+	//		 though it has to be invalidated after adding, removing or renaming layers or markers for them to be found
+	struct LayerNameLookup
+	{
+		struct Entry
+		{
+			// NOTE: Position in the search order of the owning FindLayer function, lowest wins for duplicate names
+			u32 Order;
+			std::shared_ptr<Layer> Layer;
+			const Marker* Marker;
+		};
+
+		LazyBuildGuard BuildGuard;
+		std::unordered_multimap<size_t, Entry> LayersByName;
+		std::unordered_multimap<size_t, Entry> LayersByMarkerName;
+
+		// NOTE: Calls addLayersFunc(LayerNameLookup&) to add all layers in search order unless the lookup is already valid
+		template <typename AddLayersFunc>
+		void BuildIfInvalid(AddLayersFunc addLayersFunc) { BuildGuard.BuildIfInvalid([&] { Clear(); addLayersFunc(*this); }); }
+
+		void Clear();
+		void Add(const std::shared_ptr<Layer>& layer);
+
+		std::shared_ptr<Layer> FindLayer(std::string_view name) const;
+		std::shared_ptr<Layer> FindLayerByMarker(std::string_view markerName) const;
+	};
+
+	// NOTE: Static centered interval tree over the [StartFrame, EndFrame) lifetimes of the layers of a composition, answering which layers are active
+	//		 at a frame or within a frame range in O(log n + k). Every node stores the layers containing its center frame sorted both by start and by end frame
+	//		 so that the matching ones can be reported without looking at any others. Layers with an empty frame range are never active
+	struct LayerTimeIndex
+	{
+		static constexpr u32 InvalidNode = 0xFFFFFFFF;
+
+		struct Node
+		{
+			frame_t Center;
+			u32 Left, Right;
+			// NOTE: Range within both the ByStartFrame and ByEndFrame entries
+			u32 EntriesBegin, EntriesCount;
+		};
+
+		struct Entry
+		{
+			frame_t Frame;
+			u32 LayerIndex;
+		};
+
+		LazyBuildGuard BuildGuard;
+		std::vector<Node> Nodes;
+		// NOTE: Sorted by ascending start and descending end frame within each node
+		std::vector<Entry> ByStartFrame;
+		std::vector<Entry> ByEndFrame;
+
+		void Build(const std::vector<std::shared_ptr<Layer>>& layers);
+		inline void BuildIfInvalid(const std::vector<std::shared_ptr<Layer>>& layers) { BuildGuard.BuildIfInvalid([&] { Build(layers); }); }
+
+		// NOTE: Both append the indices of all matching layers in no particular order.
+		//		 Layers are active at a frame if (StartFrame <= frame < EndFrame) and within a range if they overlap [startFrame, endFrame)
+		void FindActive(frame_t frame, std::vector<u32>& outLayerIndices) const;
+		void FindActive(frame_t startFrame, frame_t endFrame, std::vector<u32>& outLayerIndices) const;
+
+	private:
+		void FindActive(u32 nodeIndex, frame_t startFrame, frame_t endFrame, std::vector<u32>& outLayerIndices) const;
 	};
 
 	constexpr std::string_view RootCompositionName = "Root";
@@ -339,8 +493,37 @@ namespace Comfy::Aet
 		FileAddr InternalFilePosition;
 
 		inline Scene* GetParentScene() const { return InternalParentScene; }
-		inline std::shared_ptr<Layer> FindLayer(std::string_view name) { auto f = std::find_if(Layers.begin(), Layers.end(), [&](auto& it) { return it->GetName() == name; }); return (f != Layers.end()) ? *f : nullptr; }
+
+		// NOTE: Returns the first layer with a matching name. Backed by a lookup built on first use and safe to call from multiple threads at once.
+		//		 The lookup isn't updated automatically, so layers added or renamed (or markers changed) afterwards are only found once InvalidateLayerNameLookup() has been called
+		inline std::shared_ptr<Layer> FindLayer(std::string_view name) { return GetLayerNameLookup().FindLayer(name); }
 		inline std::shared_ptr<const Layer> FindLayer(std::string_view name) const { return const_cast<Composition*>(this)->FindLayer(name); }
+		// NOTE: Returns the first layer containing a marker with a matching name
+		inline std::shared_ptr<Layer> FindLayerByMarker(std::string_view markerName) { return GetLayerNameLookup().FindLayerByMarker(markerName); }
+		inline std::shared_ptr<const Layer> FindLayerByMarker(std::string_view markerName) const { return const_cast<Composition*>(this)->FindLayerByMarker(markerName); }
+
+		// NOTE: Has to be called after adding, removing or renaming any of the layers or their markers, not concurrently with any FindLayer call
+		inline void InvalidateLayerNameLookup() { layerNameLookup.BuildGuard.Invalidate(); }
+		// NOTE: Optionally builds the lookup upfront, for example before handing the composition to multiple threads
+		inline void BuildLayerNameLookup() const { GetLayerNameLookup(); }
+
+		// NOTE: Appends the indices of all layers active at the frame or within the range, in no particular order. Backed by a time index built on first use
+		//		 and safe to call from multiple threads at once. The index isn't updated automatically, so after adding, removing or reordering layers
+		//		 or changing their StartFrame or EndFrame the results are stale until InvalidateLayerTimeIndex() has been called
+		inline void FindActiveLayerIndices(frame_t frame, std::vector<u32>& outLayerIndices) const { GetLayerTimeIndex().FindActive(frame, outLayerIndices); }
+		inline void FindActiveLayerIndices(frame_t startFrame, frame_t endFrame, std::vector<u32>& outLayerIndices) const { GetLayerTimeIndex().FindActive(startFrame, endFrame, outLayerIndices); }
+
+		// NOTE: Has to be called after adding, removing or reordering any of the layers or changing their start or end frames, not concurrently with any query
+		inline void InvalidateLayerTimeIndex() { layerTimeIndex.BuildGuard.Invalidate(); }
+		// NOTE: Optionally builds the index upfront, for example before handing the composition to multiple threads
+		inline void BuildLayerTimeIndex() const { GetLayerTimeIndex(); }
+
+	private:
+		const LayerNameLookup& GetLayerNameLookup() const;
+		const LayerTimeIndex& GetLayerTimeIndex() const;
+
+		mutable LayerNameLookup layerNameLookup;
+		mutable LayerTimeIndex layerTimeIndex;
 	};
 
 	struct Camera
@@ -358,6 +541,19 @@ namespace Comfy::Aet
 		FileAddr InternalFilePosition;
 	};
 
+	struct ActiveLayerInstance
+	{
+		const Layer* Layer;
+		// NOTE: Index of the composition layer instance containing this layer within the same output or -1 for root composition layers
+		i32 ParentIndex;
+		// NOTE: Part of the queried scene frame range during which the layer is active, in the time of the composition containing the layer.
+		//		 Both set to the mapped frame for single frame queries
+		frame_t LocalStartFrame, LocalEndFrame;
+	};
+
+	// NOTE: Key data of all FCurves already written by a single AetSet::Write, used to store byte identical curves only once
+	struct FCurveWritePool;
+
 	struct Scene
 	{
 		// NOTE: Typically "MAIN", "TOUCH" or named after the screen mode
@@ -373,30 +569,111 @@ namespace Comfy::Aet
 		std::vector<std::shared_ptr<Video>> Videos;
 		std::vector<std::shared_ptr<Audio>> Audios;
 
+		// NOTE: Searches the root composition first followed by all other compositions in reverse order.
+		//		 Same as Composition::FindLayer the lookup is built on first use, thread safe and has to be invalidated for layers added or renamed afterwards to be found
 		std::shared_ptr<Layer> FindLayer(std::string_view name);
 		std::shared_ptr<const Layer> FindLayer(std::string_view name) const;
+		std::shared_ptr<Layer> FindLayerByMarker(std::string_view markerName);
+		std::shared_ptr<const Layer> FindLayerByMarker(std::string_view markerName) const;
 		i32 FindLayerIndex(Composition& comp, std::string_view name) const;
 
+		// NOTE: Has to be called after adding, removing or renaming any of the layers, their markers or compositions, not concurrently with any FindLayer call.
+		//		 Also invalidates the lookups of all compositions
+		void InvalidateLayerNameLookup();
+		// NOTE: Optionally builds the lookups of the scene and all of its compositions upfront
+		void BuildLayerNameLookups() const;
+
+		// NOTE: Appends all layer instances active at the scene frame or within the scene frame range, starting at the root composition.
+		//		 Active composition layers are followed by the active layers of their item, with the frames mapped as ((frame - StartFrame) * TimeScale + StartOffset).
+		//		 The layers of each composition instance are reported in composition order, visibility is not taken into account.
+		//		 Uses the time index of each composition, see Composition::FindActiveLayerIndices for its thread safety and invalidation
+		void FindActiveLayers(frame_t frame, std::vector<ActiveLayerInstance>& outLayers) const;
+		void FindActiveLayers(frame_t startFrame, frame_t endFrame, std::vector<ActiveLayerInstance>& outLayers) const;
+
+		// NOTE: Has to be called after changing the layers of any composition or their frame ranges
+		void InvalidateLayerTimeIndices();
+		// NOTE: Optionally builds the time indices of all compositions upfront
+		void BuildLayerTimeIndices() const;
+
 		template <typename Func> inline void ForEachComp(Func func) { for (auto& it : Compositions) { func(it); } func(RootComposition); }
 		template <typename Func> inline void ForEachComp(Func func) const { for (const auto& it : Compositions) { func(it); } func(RootComposition); }
 
-		void Read(StreamReader& reader);
-		void Write(StreamWriter& writer);
+		void Read(StreamReader& reader, const std::shared_ptr<NodeArena>& arena = nullptr);
+		// NOTE: Curves matching one already in the pool are written as pointers to the existing key data instead
+		void Write(StreamWriter& writer, FCurveWritePool* fcurvePool = nullptr);
 
+		// NOTE: File offset to object maps filled in while reading so that linking doesn't have to search, cleared again once linked.
+		//		 Same as the original lookup only non root compositions and their layers can be referenced
+		struct InternalFileLookupData
+		{
+			std::unordered_map<FileAddr, std::shared_ptr<Composition>> Compositions;
+			std::unordered_map<FileAddr, std::shared_ptr<Layer>> Layers;
+			std::unordered_map<FileAddr, std::shared_ptr<Video>> Videos;
+			std::unordered_map<FileAddr, std::shared_ptr<Audio>> Audios;
+		} InternalFileLookup;
+
+		// NOTE: Name, frame range, frame rate, background color and resolution
+		void InternalReadHeader(StreamReader& reader);
 		void InternalUpdateParentPointers();
 		void InternalUpdateCompNamesAfterLayerItems();
 		void InternalUpdateCompNamesAfterLayerItems(std::shared_ptr<Composition>& comp);
 		void InternalLinkPostRead();
 		void InternalLinkCompItems(Composition& comp);
 		void InternalFindSetLayerRefParentLayer(Layer& layer);
+
+	private:
+		const LayerNameLookup& GetLayerNameLookup() const;
+
+		mutable LayerNameLookup layerNameLookup;
 	};
 
 	struct AetSet final : IStreamReadable, IStreamWritable
 	{
 		std::string Name;
-		std::vector<std::shared_ptr<Scene>> Scenes;
+
+		struct SettingsData
+		{
+			// NOTE: Allocate all nodes created by Read() from a single NodeArena instead of individually (one per scene if read in parallel).
+			//		 The arena is monotonic, so the memory of nodes that are later removed or replaced is only released once the AetSet and every node still
+			//		 referencing the arena are destroyed. Best suited for read-only loads that aren't edited afterwards
+			b8 UseNodeArena = false;
+			// NOTE: Read each scene on its own thread using independent readers over the same data, producing the same result as reading them one after another.
+			//		 Only applies to readers over a MemoryStream, other streams are always read serially
+			b8 ParallelSceneRead = true;
+			// NOTE: Only read the scene headers upfront (see Scene::InternalReadHeader) leaving all compositions, layers and items to be read on first access through GetScene().
+			//		 Holds on to the file data until every scene has been loaded, sharing the buffer of an owning MemoryStream and copying that of any other stream
+			b8 LazySceneRead = false;
+			// NOTE: Write FCurves with the exact same key data (such as constant opacity or copied layers) only once and point all duplicates to it
+			b8 DeduplicateFCurves = true;
+			// NOTE: Compute the offset of every structure and string upfront and then fill a single preallocated buffer sequentially,
+			//		 instead of writing each scene through the seeking pointer pools of the StreamWriter. Both produce the exact same output
+			b8 PrecomputedLayoutWrite = true;
+			// NOTE: Lay out and fill the blocks of each scene on their own thread, with only the final offset assignment being serial. Requires PrecomputedLayoutWrite
+			b8 ParallelSceneWrite = true;
+		} Settings;
+
+		inline size_t GetSceneCount() const { return scenes.size(); }
+		// NOTE: Loads the scene first if it was lazily read and hasn't been accessed yet. Concurrent calls are safe, with each scene only being loaded once
+		Scene& GetScene(size_t index);
+		const Scene& GetScene(size_t index) const;
+		b8 IsSceneLoaded(size_t index) const;
+		void LoadAllScenes();
+
+		Scene& AddScene(std::shared_ptr<Scene> scene);
 
 		StreamResult Read(StreamReader& reader) override;
+		// NOTE: Loads all lazily read scenes before writing
 		StreamResult Write(StreamWriter& writer) override;
+
+	private:
+		void LoadSceneIfPending(size_t index) const;
+
+		std::vector<std::shared_ptr<Scene>> scenes;
+
+		struct LazySceneSource;
+		std::shared_ptr<LazySceneSource> lazySceneSource;
 	};
+
+	// NOTE: Scene background and video colors are stored as three RGB bytes followed by a padding byte, independent of the file endianness
+	u32 ReadU32ColorRGB(StreamReader& reader);
 }
@@ -0,0 +1,764 @@
+#include "file_format_aet_set_compact.h"
+#include <unordered_map>
+#include <algorithm>
+
+namespace Comfy::Aet
+{
+	f32 AetSetCompact::SampleFCurveAt(CompactFCurve curve, frame_t frame) const
+	{
+		if (curve.Count <= 0)
+			return 0.0f;
+
+		const frame_t* frames = &KeyFrames.Frames[curve.Offset];
+		const u32 back = (curve.Count - 1);
+		if (curve.Count == 1 || frame <= frames[0])
+			return KeyFrames.Values[curve.Offset];
+		else if (frame >= frames[back])
+			return KeyFrames.Values[curve.Offset + back];
+
+		// NOTE: Same as SampleFCurveAt(), interpolating towards the first key at or after the input frame
+		const u32 end = static_cast<u32>(std::lower_bound(frames + 1, frames + curve.Count, frame) - frames);
+		return InterpolateHermite(GetKeyFrame(curve.Offset + end - 1), GetKeyFrame(curve.Offset + end), frame);
+	}
+
+	CompactString AetSetCompact::InternalAddString(std::string_view value)
+	{
+		if (value.empty())
+			return CompactString {};
+
+		const CompactString string = { static_cast<u32>(StringData.size()), static_cast<u32>(value.size()) };
+		StringData.insert(StringData.end(), value.begin(), value.end());
+		return string;
+	}
+
+	CompactFCurve AetSetCompact::InternalAddFCurve(const FCurve& curve)
+	{
+		const CompactFCurve compactCurve = { static_cast<u32>(KeyFrames.Frames.size()), static_cast<u32>(curve->size()) };
+		for (const auto& key : curve.Keys)
+		{
+			KeyFrames.Frames.push_back(key.Frame);
+			KeyFrames.Values.push_back(key.Value);
+			KeyFrames.Tangents.push_back(key.Tangent);
+		}
+		return compactCurve;
+	}
+
+	static void CopyCompactFCurve(const AetSetCompact& set, CompactFCurve curve, FCurve& out)
+	{
+		out->reserve(curve.Count);
+		for (const u32 keyIndex : curve)
+			out->push_back(set.GetKeyFrame(keyIndex));
+	}
+
+	template <typename T>
+	static CompactIndex FindCompactIndex(const std::unordered_map<const T*, CompactIndex>& indices, const T* object)
+	{
+		const auto found = indices.find(object);
+		return (found != indices.end()) ? found->second : InvalidCompactIndex;
+	}
+
+	std::unique_ptr<AetSetCompact> AetSetCompact::CreateFromAetSet(const AetSet& set)
+	{
+		auto compact = std::make_unique<AetSetCompact>();
+		compact->Name = set.Name;
+
+		std::unordered_map<const Composition*, CompactIndex> compIndices;
+		std::unordered_map<const Layer*, CompactIndex> layerIndices;
+		std::unordered_map<const Video*, CompactIndex> videoIndices;
+		std::unordered_map<const Audio*, CompactIndex> audioIndices;
+
+		// NOTE: Assign all indices up front, in the same order they are stored in below, so that any item and parent layer reference can be resolved
+		CompactIndex compCount = 0, layerCount = 0, videoCount = 0, audioCount = 0;
+		for (size_t setSceneIndex = 0; setSceneIndex < set.GetSceneCount(); setSceneIndex++)
+		{
+			const Scene* scene = &set.GetScene(setSceneIndex);
+			for (const auto& video : scene->Videos)
+				videoIndices.emplace(video.get(), videoCount++);
+			for (const auto& audio : scene->Audios)
+				audioIndices.emplace(audio.get(), audioCount++);
+
+			assert(scene->RootComposition != nullptr);
+			scene->ForEachComp([&](const std::shared_ptr<Composition>& comp)
+			{
+				compIndices.emplace(comp.get(), compCount++);
+				for (const auto& layer : comp->Layers)
+					layerIndices.emplace(layer.get(), layerCount++);
+			});
+		}
+
+		compact->Scenes.reserve(set.GetSceneCount());
+		compact->Compositions.reserve(compCount);
+		compact->Layers.reserve(layerCount);
+		compact->Videos.reserve(videoCount);
+		compact->Audios.reserve(audioCount);
+
+		for (size_t setSceneIndex = 0; setSceneIndex < set.GetSceneCount(); setSceneIndex++)
+		{
+			const Scene* scene = &set.GetScene(setSceneIndex);
+			const CompactIndex sceneIndex = static_cast<CompactIndex>(compact->Scenes.size());
+			CompactScene& outScene = compact->Scenes.emplace_back();
+			outScene.Name = compact->InternalAddString(scene->Name);
+			outScene.StartFrame = scene->StartFrame;
+			outScene.EndFrame = scene->EndFrame;
+			outScene.FrameRate = scene->FrameRate;
+			outScene.BackgroundColor = scene->BackgroundColor;
+			outScene.Resolution = scene->Resolution;
+			outScene.Camera = InvalidCompactIndex;
+
+			if (const auto* camera = scene->Camera.get(); camera != nullptr)
+			{
+				outScene.Camera = static_cast<CompactIndex>(compact->Cameras.size());
+				const FCurve* cameraCurves[CompactCamera::CurveCount] =
+				{
+					&camera->Eye.X, &camera->Eye.Y, &camera->Eye.Z,
+					&camera->Position.X, &camera->Position.Y, &camera->Position.Z,
+					&camera->Direction.X, &camera->Direction.Y, &camera->Direction.Z,
+					&camera->Rotation.X, &camera->Rotation.Y, &camera->Rotation.Z,
+					&camera->Zoom,
+				};
+
+				CompactCamera& outCamera = compact->Cameras.emplace_back();
+				for (size_t i = 0; i < CompactCamera::CurveCount; i++)
+					outCamera.Curves[i] = compact->InternalAddFCurve(*cameraCurves[i]);
+			}
+
+			outScene.Videos = { static_cast<u32>(compact->Videos.size()), static_cast<u32>(scene->Videos.size()) };
+			for (const auto& video : scene->Videos)
+			{
+				CompactVideo& outVideo = compact->Videos.emplace_back();
+				outVideo.Color = video->Color;
+				outVideo.Size = video->Size;
+				outVideo.FilesPerFrame = video->FilesPerFrame;
+				outVideo.Sources = { static_cast<u32>(compact->VideoSources.size()), static_cast<u32>(video->Sources.size()) };
+				for (const auto& source : video->Sources)
+					compact->VideoSources.push_back({ compact->InternalAddString(source.Name), source.ID });
+			}
+
+			outScene.Audios = { static_cast<u32>(compact->Audios.size()), static_cast<u32>(scene->Audios.size()) };
+			for (const auto& audio : scene->Audios)
+				compact->Audios.push_back({ audio->SoundID });
+
+			outScene.Compositions = { static_cast<u32>(compact->Compositions.size()), static_cast<u32>(scene->Compositions.size()) };
+			outScene.RootComposition = (outScene.Compositions.Offset + outScene.Compositions.Count);
+
+			scene->ForEachComp([&](const std::shared_ptr<Composition>& comp)
+			{
+				const CompactIndex compIndex = static_cast<CompactIndex>(compact->Compositions.size());
+				CompactComposition& outComp = compact->Compositions.emplace_back();
+				outComp.Layers = { static_cast<u32>(compact->Layers.size()), static_cast<u32>(comp->Layers.size()) };
+				outComp.GivenName = compact->InternalAddString(comp->GivenName);
+				outComp.ParentScene = sceneIndex;
+
+				for (const auto& layer : comp->Layers)
+				{
+					CompactLayer& outLayer = compact->Layers.emplace_back();
+					outLayer.Name = compact->InternalAddString(layer->Name);
+					outLayer.StartFrame = layer->StartFrame;
+					outLayer.EndFrame = layer->EndFrame;
+					outLayer.StartOffset = layer->StartOffset;
+					outLayer.TimeScale = layer->TimeScale;
+					outLayer.Flags = layer->Flags;
+					outLayer.Quality = layer->Quality;
+					outLayer.ItemType = layer->ItemType;
+					outLayer.ParentComposition = compIndex;
+
+					const Layer& constLayer = *layer;
+					switch (layer->ItemType)
+					{
+					case ItemType::Video: outLayer.Item = FindCompactIndex(videoIndices, constLayer.GetVideoItem()); break;
+					case ItemType::Audio: outLayer.Item = FindCompactIndex(audioIndices, constLayer.GetAudioItem()); break;
+					case ItemType::Composition: outLayer.Item = FindCompactIndex(compIndices, constLayer.GetCompItem()); break;
+					default: outLayer.Item = InvalidCompactIndex; break;
+					}
+					outLayer.RefParentLayer = FindCompactIndex(layerIndices, constLayer.GetRefParentLayer());
+
+					outLayer.Markers = { static_cast<u32>(compact->Markers.size()), static_cast<u32>(layer->Markers.size()) };
+					for (const auto& marker : layer->Markers)
+						compact->Markers.push_back({ marker->Frame, compact->InternalAddString(marker->Name) });
+
+					outLayer.LayerVideo = InvalidCompactIndex;
+					if (const auto* layerVideo = layer->LayerVideo.get(); layerVideo != nullptr)
+					{
+						outLayer.LayerVideo = static_cast<CompactIndex>(compact->LayerVideos.size());
+						CompactLayerVideo& outLayerVideo = compact->LayerVideos.emplace_back();
+						outLayerVideo.TransferMode = layerVideo->TransferMode;
+						for (Transform2DField field = 0; field < Transform2DField_Count; field++)
+							outLayerVideo.Transform[field] = compact->InternalAddFCurve(layerVideo->Transform[field]);
+
+						outLayerVideo.Transform3D = InvalidCompactIndex;
+						if (const auto* transform3D = layerVideo->Transform3D.get(); transform3D != nullptr)
+						{
+							outLayerVideo.Transform3D = static_cast<CompactIndex>(compact->LayerVideos3D.size());
+							const FCurve* curves3D[CompactLayerVideo3D::CurveCount] =
+							{
+								&transform3D->OriginZ, &transform3D->PositionZ,
+								&transform3D->DirectionXYZ.X, &transform3D->DirectionXYZ.Y, &transform3D->DirectionXYZ.Z,
+								&transform3D->RotationXY.X, &transform3D->RotationXY.Y,
+								&transform3D->ScaleZ,
+							};
+
+							CompactLayerVideo3D& outTransform3D = compact->LayerVideos3D.emplace_back();
+							for (size_t i = 0; i < CompactLayerVideo3D::CurveCount; i++)
+								outTransform3D.Curves[i] = compact->InternalAddFCurve(*curves3D[i]);
+						}
+					}
+
+					outLayer.LayerAudio = InvalidCompactIndex;
+					if (const auto* layerAudio = layer->LayerAudio.get(); layerAudio != nullptr)
+					{
+						outLayer.LayerAudio = static_cast<CompactIndex>(compact->LayerAudios.size());
+						CompactLayerAudio& outLayerAudio = compact->LayerAudios.emplace_back();
+						outLayerAudio.Curves[0] = compact->InternalAddFCurve(layerAudio->VolumeL);
+						outLayerAudio.Curves[1] = compact->InternalAddFCurve(layerAudio->VolumeR);
+						outLayerAudio.Curves[2] = compact->InternalAddFCurve(layerAudio->PanL);
+						outLayerAudio.Curves[3] = compact->InternalAddFCurve(layerAudio->PanR);
+					}
+				}
+			});
+		}
+
+		return compact;
+	}
+
+	std::unique_ptr<AetSet> AetSetCompact::CreateAetSet() const
+	{
+		auto set = std::make_unique<AetSet>();
+		set->Name = Name;
+
+		// NOTE: Create all referencable objects up front so that item and parent layer references can be linked in a single pass
+		std::vector<std::shared_ptr<Composition>> outComps(Compositions.size());
+		std::vector<std::shared_ptr<Layer>> outLayers(Layers.size());
+		std::vector<std::shared_ptr<Video>> outVideos(Videos.size());
+		std::vector<std::shared_ptr<Audio>> outAudios(Audios.size());
+
+		for (auto& comp : outComps) comp = std::make_shared<Composition>();
+		for (auto& layer : outLayers) layer = std::make_shared<Layer>();
+		for (auto& video : outVideos) video = std::make_shared<Video>();
+		for (auto& audio : outAudios) audio = std::make_shared<Audio>();
+
+		for (size_t i = 0; i < Videos.size(); i++)
+		{
+			const CompactVideo& video = Videos[i];
+			Video& outVideo = *outVideos[i];
+			outVideo.Color = video.Color;
+			outVideo.Size = video.Size;
+			outVideo.FilesPerFrame = video.FilesPerFrame;
+			outVideo.Sources.reserve(video.Sources.Count);
+			for (const u32 sourceIndex : video.Sources)
+				outVideo.Sources.push_back({ std::string(GetString(VideoSources[sourceIndex].Name)), VideoSources[sourceIndex].ID });
+		}
+
+		for (size_t i = 0; i < Audios.size(); i++)
+			outAudios[i]->SoundID = Audios[i].SoundID;
+
+		for (size_t i = 0; i < Layers.size(); i++)
+		{
+			const CompactLayer& layer = Layers[i];
+			Layer& outLayer = *outLayers[i];
+			outLayer.Name = GetString(layer.Name);
+			outLayer.StartFrame = layer.StartFrame;
+			outLayer.EndFrame = layer.EndFrame;
+			outLayer.StartOffset = layer.StartOffset;
+			outLayer.TimeScale = layer.TimeScale;
+			outLayer.Flags = layer.Flags;
+			outLayer.Quality = layer.Quality;
+			outLayer.ItemType = layer.ItemType;
+
+			if (layer.ItemType == ItemType::Video && InBounds(layer.Item, outVideos))
+				outLayer.SetItem(outVideos[layer.Item]);
+			else if (layer.ItemType == ItemType::Audio && InBounds(layer.Item, outAudios))
+				outLayer.SetItem(outAudios[layer.Item]);
+			else if (layer.ItemType == ItemType::Composition && InBounds(layer.Item, outComps))
+				outLayer.SetItem(outComps[layer.Item]);
+
+			if (InBounds(layer.RefParentLayer, outLayers))
+				outLayer.SetRefParentLayer(outLayers[layer.RefParentLayer]);
+
+			outLayer.Markers.reserve(layer.Markers.Count);
+			for (const u32 markerIndex : layer.Markers)
+				outLayer.Markers.push_back(std::make_shared<Marker>(Marker { Markers[markerIndex].Frame, std::string(GetString(Markers[markerIndex].Name)) }));
+
+			if (InBounds(layer.LayerVideo, LayerVideos))
+			{
+				const CompactLayerVideo& layerVideo = LayerVideos[layer.LayerVideo];
+				outLayer.LayerVideo = std::make_shared<LayerVideo>();
+				outLayer.LayerVideo->TransferMode = layerVideo.TransferMode;
+				for (Transform2DField field = 0; field < Transform2DField_Count; field++)
+					CopyCompactFCurve(*this, layerVideo.Transform[field], outLayer.LayerVideo->Transform[field]);
+
+				if (InBounds(layerVideo.Transform3D, LayerVideos3D))
+				{
+					const CompactLayerVideo3D& transform3D = LayerVideos3D[layerVideo.Transform3D];
+					auto& outTransform3D = *(outLayer.LayerVideo->Transform3D = std::make_shared<LayerVideo3D>());
+					FCurve* curves3D[CompactLayerVideo3D::CurveCount] =
+					{
+						&outTransform3D.OriginZ, &outTransform3D.PositionZ,
+						&outTransform3D.DirectionXYZ.X, &outTransform3D.DirectionXYZ.Y, &outTransform3D.DirectionXYZ.Z,
+						&outTransform3D.RotationXY.X, &outTransform3D.RotationXY.Y,
+						&outTransform3D.ScaleZ,
+					};
+
+					for (size_t curveIndex = 0; curveIndex < CompactLayerVideo3D::CurveCount; curveIndex++)
+						CopyCompactFCurve(*this, transform3D.Curves[curveIndex], *curves3D[curveIndex]);
+				}
+			}
+
+			if (InBounds(layer.LayerAudio, LayerAudios))
+			{
+				const CompactLayerAudio& layerAudio = LayerAudios[layer.LayerAudio];
+				outLayer.LayerAudio = std::make_shared<LayerAudio>();
+				CopyCompactFCurve(*this, layerAudio.Curves[0], outLayer.LayerAudio->VolumeL);
+				CopyCompactFCurve(*this, layerAudio.Curves[1], outLayer.LayerAudio->VolumeR);
+				CopyCompactFCurve(*this, layerAudio.Curves[2], outLayer.LayerAudio->PanL);
+				CopyCompactFCurve(*this, layerAudio.Curves[3], outLayer.LayerAudio->PanR);
+			}
+		}
+
+		for (size_t i = 0; i < Compositions.size(); i++)
+		{
+			const CompactComposition& comp = Compositions[i];
+			Composition& outComp = *outComps[i];
+			outComp.GivenName = GetString(comp.GivenName);
+			outComp.Layers.reserve(comp.Layers.Count);
+			for (const u32 layerIndex : comp.Layers)
+				outComp.Layers.push_back(outLayers[layerIndex]);
+		}
+
+		for (const auto& scene : Scenes)
+		{
+			auto& outScene = set->AddScene(std::make_shared<Scene>());
+			outScene.Name = GetString(scene.Name);
+			outScene.StartFrame = scene.StartFrame;
+			outScene.EndFrame = scene.EndFrame;
+			outScene.FrameRate = scene.FrameRate;
+			outScene.BackgroundColor = scene.BackgroundColor;
+			outScene.Resolution = scene.Resolution;
+
+			if (InBounds(scene.Camera, Cameras))
+			{
+				const CompactCamera& camera = Cameras[scene.Camera];
+				auto& outCamera = *(outScene.Camera = std::make_shared<Camera>());
+				FCurve* cameraCurves[CompactCamera::CurveCount] =
+				{
+					&outCamera.Eye.X, &outCamera.Eye.Y, &outCamera.Eye.Z,
+					&outCamera.Position.X, &outCamera.Position.Y, &outCamera.Position.Z,
+					&outCamera.Direction.X, &outCamera.Direction.Y, &outCamera.Direction.Z,
+					&outCamera.Rotation.X, &outCamera.Rotation.Y, &outCamera.Rotation.Z,
+					&outCamera.Zoom,
+				};
+
+				for (size_t curveIndex = 0; curveIndex < CompactCamera::CurveCount; curveIndex++)
+					CopyCompactFCurve(*this, camera.Curves[curveIndex], *cameraCurves[curveIndex]);
+			}
+
+			for (const u32 compIndex : scene.Compositions)
+				outScene.Compositions.push_back(outComps[compIndex]);
+			outScene.RootComposition = InBounds(scene.RootComposition, outComps) ? outComps[scene.RootComposition] : std::make_shared<Composition>();
+
+			for (const u32 videoIndex : scene.Videos)
+				outScene.Videos.push_back(outVideos[videoIndex]);
+			for (const u32 audioIndex : scene.Audios)
+				outScene.Audios.push_back(outAudios[audioIndex]);
+
+			outScene.InternalUpdateParentPointers();
+		}
+
+		return set;
+	}
+
+	// NOTE: File offsets of all objects read so far, used to resolve layer item and parent references the same way Scene::InternalLinkPostRead does
+	struct CompactSceneReadContext
+	{
+		std::unordered_map<FileAddr, CompactIndex> VideoIndices;
+		std::unordered_map<FileAddr, CompactIndex> AudioIndices;
+		std::unordered_map<FileAddr, CompactIndex> CompIndices;
+		std::unordered_map<FileAddr, CompactIndex> LayerIndices;
+
+		struct LayerReferences { CompactIndex Layer; FileAddr ItemOffset, ParentOffset; };
+		std::vector<LayerReferences> UnresolvedReferences;
+	};
+
+	static StreamResult ReadCompactFCurvePtr(StreamReader& reader, AetSetCompact& out, frame_t singleKeyFrame, CompactFCurve& outCurve)
+	{
+		const auto keyFrameCount = reader.ReadSize();
+		const auto keyFramesOffset = reader.ReadPtr();
+
+		outCurve = {};
+		if (keyFrameCount < 1)
+			return StreamResult::Success;
+
+		if (!reader.IsValidPointer(keyFramesOffset))
+			return StreamResult::BadPointer;
+
+		auto& keyFrames = out.KeyFrames;
+		const CompactFCurve curve = { static_cast<u32>(keyFrames.Frames.size()), static_cast<u32>(keyFrameCount) };
+		keyFrames.Frames.resize(curve.EndIndex());
+		keyFrames.Values.resize(curve.EndIndex());
+		keyFrames.Tangents.resize(curve.EndIndex(), 0.0f);
+
+		reader.ReadAtOffsetAware(keyFramesOffset, [&](StreamReader& reader)
+		{
+			if (keyFrameCount == 1)
+			{
+				keyFrames.Frames[curve.Offset] = singleKeyFrame;
+				keyFrames.Values[curve.Offset] = reader.ReadF32();
+			}
+			else
+			{
+				for (const u32 i : curve)
+					keyFrames.Frames[i] = reader.ReadF32();
+
+				for (const u32 i : curve)
+				{
+					keyFrames.Values[i] = reader.ReadF32();
+					keyFrames.Tangents[i] = reader.ReadF32();
+				}
+			}
+		});
+
+		outCurve = curve;
+		return StreamResult::Success;
+	}
+
+	static StreamResult ReadCompactLayerVideo(StreamReader& reader, AetSetCompact& out, CompactLayerVideo& outLayerVideo, frame_t startFrame)
+	{
+		outLayerVideo.TransferMode.BlendMode = static_cast<BlendMode>(reader.ReadU8());
+		const u8 transferFlags = reader.ReadU8();
+		outLayerVideo.TransferMode.Flags = *reinterpret_cast<const TransferFlags*>(&transferFlags);
+		outLayerVideo.TransferMode.TrackMatte = static_cast<TrackMatte>(reader.ReadU8());
+		reader.Skip(static_cast<FileAddr>(sizeof(u8)));
+
+		if (reader.GetPtrSize() == PtrSize::Mode64Bit)
+			reader.ReadU32();
+
+		for (Transform2DField field = 0; field < Transform2DField_Count; field++)
+		{
+			if (auto result = ReadCompactFCurvePtr(reader, out, startFrame, outLayerVideo.Transform[field]); result != StreamResult::Success)
+				return result;
+		}
+
+		outLayerVideo.Transform3D = InvalidCompactIndex;
+		const auto transform3DOffset = reader.ReadPtr();
+		if (transform3DOffset == FileAddr::NullPtr)
+			return StreamResult::Success;
+
+		StreamResult result = StreamResult::Success;
+		outLayerVideo.Transform3D = static_cast<CompactIndex>(out.LayerVideos3D.size());
+		reader.ReadAtOffsetAware(transform3DOffset, [&](StreamReader& reader)
+		{
+			CompactLayerVideo3D transform3D;
+			for (auto& curve : transform3D.Curves)
+			{
+				if (result = ReadCompactFCurvePtr(reader, out, startFrame, curve); result != StreamResult::Success)
+					return;
+			}
+			out.LayerVideos3D.push_back(transform3D);
+		});
+
+		return result;
+	}
+
+	static StreamResult ReadCompactLayer(StreamReader& reader, AetSetCompact& out, CompactSceneReadContext& context, CompactIndex compIndex, b8 isRootComp)
+	{
+		const CompactIndex layerIndex = static_cast<CompactIndex>(out.Layers.size());
+		if (!isRootComp)
+			context.LayerIndices.emplace(reader.GetPositionOffsetAware(), layerIndex);
+
+		CompactLayer layer = {};
+		layer.Name = out.InternalAddString(reader.ReadStrPtrOffsetAware());
+		layer.StartFrame = reader.ReadF32();
+		layer.EndFrame = reader.ReadF32();
+		layer.StartOffset = reader.ReadF32();
+		layer.TimeScale = reader.ReadF32();
+
+		const u16 flags = reader.ReadU16();
+		layer.Flags = *reinterpret_cast<const LayerFlags*>(&flags);
+		layer.Quality = static_cast<LayerQuality>(reader.ReadU8());
+		layer.ItemType = static_cast<ItemType>(reader.ReadU8());
+
+		if (reader.GetPtrSize() == PtrSize::Mode64Bit)
+			reader.ReadU32();
+
+		layer.Item = InvalidCompactIndex;
+		layer.RefParentLayer = InvalidCompactIndex;
+		layer.ParentComposition = compIndex;
+
+		const auto itemOffset = reader.ReadPtr();
+		const auto parentOffset = reader.ReadPtr();
+		if (itemOffset != FileAddr::NullPtr || parentOffset != FileAddr::NullPtr)
+			context.UnresolvedReferences.push_back({ layerIndex, itemOffset, parentOffset });
+
+		const auto markerCount = reader.ReadSize();
+		const auto markersOffset = reader.ReadPtr();
+		layer.Markers = { static_cast<u32>(out.Markers.size()), 0 };
+
+		if (markerCount > 0 && markersOffset != FileAddr::NullPtr)
+		{
+			layer.Markers.Count = static_cast<u32>(markerCount);
+			reader.ReadAtOffsetAware(markersOffset, [&](StreamReader& reader)
+			{
+				for (size_t i = 0; i < markerCount; i++)
+				{
+					CompactMarker marker;
+					marker.Frame = reader.ReadF32();
+					if (reader.GetPtrSize() == PtrSize::Mode64Bit)
+						reader.ReadU32();
+					marker.Name = out.InternalAddString(reader.ReadStrPtrOffsetAware());
+					out.Markers.push_back(marker);
+				}
+			});
+		}
+
+		StreamResult result = StreamResult::Success;
+		layer.LayerVideo = InvalidCompactIndex;
+		const auto layerVideoOffset = reader.ReadPtr();
+		if (layerVideoOffset != FileAddr::NullPtr)
+		{
+			layer.LayerVideo = static_cast<CompactIndex>(out.LayerVideos.size());
+			reader.ReadAtOffsetAware(layerVideoOffset, [&](StreamReader& reader)
+			{
+				CompactLayerVideo layerVideo;
+				result = ReadCompactLayerVideo(reader, out, layerVideo, layer.StartFrame);
+				out.LayerVideos.push_back(layerVideo);
+			});
+		}
+
+		// NOTE: Audio layer data isn't supported by AetSet::Read either
+		layer.LayerAudio = InvalidCompactIndex;
+		reader.ReadPtr();
+
+		out.Layers.push_back(layer);
+		return result;
+	}
+
+	static StreamResult ReadCompactScene(StreamReader& reader, AetSetCompact& out, CompactIndex sceneIndex)
+	{
+		CompactSceneReadContext context;
+
+		CompactScene scene = {};
+		scene.Name = out.InternalAddString(reader.ReadStrPtrOffsetAware());
+		scene.StartFrame = reader.ReadF32();
+		scene.EndFrame = reader.ReadF32();
+		scene.FrameRate = reader.ReadF32();
+		scene.BackgroundColor = ReadU32ColorRGB(reader);
+		scene.Resolution = reader.ReadIVec2();
+		scene.Camera = InvalidCompactIndex;
+		scene.RootComposition = InvalidCompactIndex;
+
+		StreamResult result = StreamResult::Success;
+		const auto cameraOffset = reader.ReadPtr();
+		if (cameraOffset != FileAddr::NullPtr)
+		{
+			scene.Camera = static_cast<CompactIndex>(out.Cameras.size());
+			reader.ReadAtOffsetAware(cameraOffset, [&](StreamReader& reader)
+			{
+				CompactCamera camera;
+				for (auto& curve : camera.Curves)
+				{
+					if (result = ReadCompactFCurvePtr(reader, out, 0.0f, curve); result != StreamResult::Success)
+						return;
+				}
+				out.Cameras.push_back(camera);
+			});
+
+			if (result != StreamResult::Success)
+				return result;
+		}
+
+		const auto compCount = reader.ReadSize();
+		const auto compsOffset = reader.ReadPtr();
+		scene.Compositions = { static_cast<u32>(out.Compositions.size()), 0 };
+
+		if (compCount > 0 && compsOffset != FileAddr::NullPtr)
+		{
+			scene.Compositions.Count = static_cast<u32>(compCount - 1);
+			scene.RootComposition = scene.Compositions.EndIndex();
+
+			reader.ReadAtOffsetAware(compsOffset, [&](StreamReader& reader)
+			{
+				for (size_t i = 0; i < compCount; i++)
+				{
+					const CompactIndex compIndex = static_cast<CompactIndex>(out.Compositions.size());
+					const b8 isRootComp = (compIndex == scene.RootComposition);
+					if (!isRootComp)
+						context.CompIndices.emplace(reader.GetPositionOffsetAware(), compIndex);
+
+					const auto layerCount = reader.ReadSize();
+					const auto layersOffset = reader.ReadPtr();
+
+					CompactComposition comp = {};
+					comp.ParentScene = sceneIndex;
+					comp.Layers = { static_cast<u32>(out.Layers.size()), 0 };
+					out.Compositions.push_back(comp);
+
+					if (layerCount > 0 && layersOffset != FileAddr::NullPtr)
+					{
+						out.Compositions[compIndex].Layers.Count = static_cast<u32>(layerCount);
+						reader.ReadAtOffsetAware(layersOffset, [&](StreamReader& reader)
+						{
+							for (size_t layerIndex = 0; layerIndex < layerCount && result == StreamResult::Success; layerIndex++)
+								result = ReadCompactLayer(reader, out, context, compIndex, isRootComp);
+						});
+					}
+
+					if (result != StreamResult::Success)
+						return;
+				}
+			});
+
+			if (result != StreamResult::Success)
+				return result;
+		}
+
+		const auto videoCount = reader.ReadSize();
+		const auto videosOffset = reader.ReadPtr();
+		scene.Videos = { static_cast<u32>(out.Videos.size()), 0 };
+
+		if (videoCount > 0 && videosOffset != FileAddr::NullPtr)
+		{
+			scene.Videos.Count = static_cast<u32>(videoCount);
+			reader.ReadAtOffsetAware(videosOffset, [&](StreamReader& reader)
+			{
+				for (size_t i = 0; i < videoCount; i++)
+				{
+					context.VideoIndices.emplace(reader.GetPositionOffsetAware(), static_cast<CompactIndex>(out.Videos.size()));
+
+					CompactVideo video;
+					video.Color = ReadU32ColorRGB(reader);
+					video.Size.x = reader.ReadU16();
+					video.Size.y = reader.ReadU16();
+					video.FilesPerFrame = reader.ReadF32();
+					video.Sources = { static_cast<u32>(out.VideoSources.size()), 0 };
+
+					const auto sourceCount = reader.ReadU32();
+					const auto sourcesOffset = reader.ReadPtr();
+
+					if (sourceCount > 0 && sourcesOffset != FileAddr::NullPtr)
+					{
+						video.Sources.Count = sourceCount;
+						reader.ReadAtOffsetAware(sourcesOffset, [&](StreamReader& reader)
+						{
+							for (u32 sourceIndex = 0; sourceIndex < sourceCount; sourceIndex++)
+							{
+								const CompactString sourceName = out.InternalAddString(reader.ReadStrPtrOffsetAware());
+								out.VideoSources.push_back({ sourceName, SprID(reader.ReadU32()) });
+								if (reader.GetPtrSize() == PtrSize::Mode64Bit)
+									reader.ReadU32();
+							}
+						});
+					}
+
+					out.Videos.push_back(video);
+				}
+			});
+		}
+
+		const auto audioCount = reader.ReadSize();
+		const auto audiosOffset = reader.ReadPtr();
+		scene.Audios = { static_cast<u32>(out.Audios.size()), 0 };
+
+		if (audioCount > 0 && audiosOffset != FileAddr::NullPtr)
+		{
+			scene.Audios.Count = static_cast<u32>(audioCount);
+			reader.ReadAtOffsetAware(audiosOffset, [&](StreamReader& reader)
+			{
+				for (size_t i = 0; i < audioCount; i++)
+				{
+					context.AudioIndices.emplace(reader.GetPositionOffsetAware(), static_cast<CompactIndex>(out.Audios.size()));
+					out.Audios.push_back({ reader.ReadU32() });
+				}
+			});
+		}
+
+		for (const auto& references : context.UnresolvedReferences)
+		{
+			CompactLayer& layer = out.Layers[references.Layer];
+			const auto findIndex = [](const std::unordered_map<FileAddr, CompactIndex>& indices, FileAddr offset)
+			{
+				const auto found = indices.find(offset);
+				return (found != indices.end()) ? found->second : InvalidCompactIndex;
+			};
+
+			if (references.ItemOffset != FileAddr::NullPtr)
+			{
+				if (layer.ItemType == ItemType::Video)
+					layer.Item = findIndex(context.VideoIndices, references.ItemOffset);
+				else if (layer.ItemType == ItemType::Audio)
+					layer.Item = findIndex(context.AudioIndices, references.ItemOffset);
+				else if (layer.ItemType == ItemType::Composition)
+					layer.Item = findIndex(context.CompIndices, references.ItemOffset);
+			}
+
+			if (references.ParentOffset != FileAddr::NullPtr)
+				layer.RefParentLayer = findIndex(context.LayerIndices, references.ParentOffset);
+		}
+
+		// NOTE: Same naming as Scene::InternalUpdateCompNamesAfterLayerItems, root comp layers first followed by all other comps in order
+		if (scene.RootComposition != InvalidCompactIndex)
+		{
+			out.Compositions[scene.RootComposition].GivenName = out.InternalAddString(RootCompositionName);
+
+			const auto updateCompNamesAfterLayerItems = [&](const CompactComposition& comp)
+			{
+				for (const u32 layerIndex : comp.Layers)
+				{
+					const CompactLayer& layer = out.Layers[layerIndex];
+					if (layer.ItemType == ItemType::Composition && layer.Item != InvalidCompactIndex)
+						out.Compositions[layer.Item].GivenName = layer.Name;
+				}
+			};
+
+			updateCompNamesAfterLayerItems(out.Compositions[scene.RootComposition]);
+			for (const u32 compIndex : scene.Compositions)
+				updateCompNamesAfterLayerItems(out.Compositions[compIndex]);
+		}
+
+		out.Scenes.push_back(scene);
+		return StreamResult::Success;
+	}
+
+	StreamResult AetSetCompact::Read(StreamReader& reader)
+	{
+		auto baseHeader = SectionHeader::TryRead(reader, SectionSignature::AETC);
+		SectionHeader::ScanPOFSectionsForPtrSize(reader);
+		SectionByteSwapScope byteSwapScope { reader, baseHeader };
+
+		if (baseHeader.has_value())
+		{
+			reader.SetEndianness(baseHeader->Endianness);
+			reader.Seek(baseHeader->StartOfSubSectionAddress());
+
+			if (reader.GetPtrSize() == PtrSize::Mode64Bit)
+				reader.PushBaseOffset();
+		}
+
+		size_t sceneCount = 0;
+		reader.ReadAt(reader.GetPosition(), [&](StreamReader& reader)
+		{
+			while (reader.ReadPtr() != FileAddr::NullPtr)
+				sceneCount++;
+		});
+
+		Scenes.reserve(sceneCount);
+		for (size_t i = 0; i < sceneCount; i++)
+		{
+			const auto sceneOffset = reader.ReadPtr();
+			if (!reader.IsValidPointer(sceneOffset))
+				return StreamResult::BadPointer;
+
+			StreamResult result = StreamResult::Success;
+			reader.ReadAtOffsetAware(sceneOffset, [&](StreamReader& reader)
+			{
+				result = ReadCompactScene(reader, *this, static_cast<CompactIndex>(i));
+			});
+
+			if (result != StreamResult::Success)
+				return result;
+		}
+
+		if (baseHeader.has_value() && reader.GetPtrSize() == PtrSize::Mode64Bit)
+			reader.PopBaseOffset();
+
+		return StreamResult::Success;
+	}
+}
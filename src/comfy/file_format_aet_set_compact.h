@@ -0,0 +1,177 @@
+#pragma once
+#include "core_types.h"
+#include "file_format_common.h"
+#include "file_format_aet_set.h"
+
+namespace Comfy::Aet
+{
+	using CompactIndex = u32;
+	constexpr CompactIndex InvalidCompactIndex = 0xFFFFFFFF;
+
+	// NOTE: Contiguous range of elements within one of the typed arrays of the parent AetSetCompact
+	struct CompactRange
+	{
+		u32 Offset = 0;
+		u32 Count = 0;
+
+		// NOTE: Iterates over the array indices of the range
+		struct Iterator
+		{
+			u32 Index;
+
+			inline u32 operator*() const { return Index; }
+			inline Iterator& operator++() { Index++; return *this; }
+			inline b8 operator!=(const Iterator& other) const { return Index != other.Index; }
+		};
+
+		inline Iterator begin() const { return Iterator { Offset }; }
+		inline Iterator end() const { return Iterator { Offset + Count }; }
+		inline u32 EndIndex() const { return Offset + Count; }
+	};
+
+	struct CompactString
+	{
+		u32 Offset = 0;
+		u32 Length = 0;
+	};
+
+	// NOTE: Range of keys inside the KeyFrames arrays
+	using CompactFCurve = CompactRange;
+
+	struct CompactCamera
+	{
+		// NOTE: Eye.XYZ, Position.XYZ, Direction.XYZ, Rotation.XYZ, Zoom
+		static constexpr size_t CurveCount = 13;
+		CompactFCurve Curves[CurveCount];
+	};
+
+	struct CompactVideoSource
+	{
+		CompactString Name;
+		SprID ID;
+	};
+
+	struct CompactVideo
+	{
+		u32 Color;
+		ivec2 Size;
+		f32 FilesPerFrame;
+		CompactRange Sources;
+	};
+
+	struct CompactAudio
+	{
+		u32 SoundID;
+	};
+
+	struct CompactMarker
+	{
+		frame_t Frame;
+		CompactString Name;
+	};
+
+	struct CompactLayerVideo3D
+	{
+		// NOTE: OriginZ, PositionZ, DirectionXYZ.X/Y/Z, RotationXY.X/Y, ScaleZ
+		static constexpr size_t CurveCount = 8;
+		CompactFCurve Curves[CurveCount];
+	};
+
+	struct CompactLayerVideo
+	{
+		LayerTransferMode TransferMode;
+		CompactFCurve Transform[Transform2DField_Count];
+		CompactIndex Transform3D;
+	};
+
+	struct CompactLayerAudio
+	{
+		// NOTE: VolumeL, VolumeR, PanL, PanR
+		static constexpr size_t CurveCount = 4;
+		CompactFCurve Curves[CurveCount];
+	};
+
+	struct CompactLayer
+	{
+		CompactString Name;
+		frame_t StartFrame;
+		frame_t EndFrame;
+		frame_t StartOffset;
+		f32 TimeScale;
+		LayerFlags Flags;
+		LayerQuality Quality;
+		ItemType ItemType;
+		// NOTE: Index into the Videos, Audios or Compositions array depending on the ItemType
+		CompactIndex Item;
+		CompactIndex RefParentLayer;
+		CompactIndex ParentComposition;
+		CompactRange Markers;
+		CompactIndex LayerVideo;
+		CompactIndex LayerAudio;
+	};
+
+	struct CompactComposition
+	{
+		CompactRange Layers;
+		CompactString GivenName;
+		CompactIndex ParentScene;
+	};
+
+	struct CompactScene
+	{
+		CompactString Name;
+		frame_t StartFrame;
+		frame_t EndFrame;
+		frame_t FrameRate;
+		u32 BackgroundColor;
+		ivec2 Resolution;
+		CompactIndex Camera;
+		// NOTE: Excluding the root composition which is always stored directly after them
+		CompactRange Compositions;
+		CompactIndex RootComposition;
+		CompactRange Videos;
+		CompactRange Audios;
+	};
+
+	// NOTE: Alternative representation of an AetSet storing all objects of the same type inside a single contiguous array, referencing each other by 32-bit index
+	//		 instead of by shared_ptr. Key frames are further split into separate frame, value and tangent arrays so that sampling only touches the data it needs.
+	//		 Intended for tools that evaluate or analyze scenes without editing their structure. Can be losslessly converted to and from a regular AetSet
+	struct AetSetCompact final : IStreamReadable
+	{
+		std::string Name;
+
+		std::vector<CompactScene> Scenes;
+		std::vector<CompactCamera> Cameras;
+		std::vector<CompactComposition> Compositions;
+		std::vector<CompactLayer> Layers;
+		std::vector<CompactLayerVideo> LayerVideos;
+		std::vector<CompactLayerVideo3D> LayerVideos3D;
+		std::vector<CompactLayerAudio> LayerAudios;
+		std::vector<CompactMarker> Markers;
+		std::vector<CompactVideo> Videos;
+		std::vector<CompactVideoSource> VideoSources;
+		std::vector<CompactAudio> Audios;
+
+		struct KeyFrameArrays
+		{
+			std::vector<frame_t> Frames;
+			std::vector<f32> Values;
+			std::vector<f32> Tangents;
+		} KeyFrames;
+
+		std::vector<char> StringData;
+
+		// NOTE: Reads the same file layouts as AetSet::Read directly into the compact arrays without creating any intermediate AetSet objects
+		StreamResult Read(StreamReader& reader) override;
+
+		inline std::string_view GetString(CompactString string) const { return std::string_view(StringData.data() + string.Offset, string.Length); }
+		inline KeyFrame GetKeyFrame(u32 index) const { return KeyFrame(KeyFrames.Frames[index], KeyFrames.Values[index], KeyFrames.Tangents[index]); }
+		f32 SampleFCurveAt(CompactFCurve curve, frame_t frame) const;
+
+		static std::unique_ptr<AetSetCompact> CreateFromAetSet(const AetSet& set);
+		std::unique_ptr<AetSet> CreateAetSet() const;
+
+		CompactString InternalAddString(std::string_view value);
+		CompactFCurve InternalAddFCurve(const FCurve& curve);
+	};
+}
@@ -0,0 +1,410 @@
+#include "file_format_aet_set_view.h"
+
+namespace Comfy::Aet
+{
+	// NOTE: In-file structure layouts as read by AetSet::Read, as { 32-bit offset, 64-bit offset } pairs
+	struct FieldOffset { size_t Mode32, Mode64; };
+
+	namespace ViewLayout
+	{
+		namespace SceneLayout
+		{
+			constexpr FieldOffset Name = { 0, 0 }, StartFrame = { 4, 8 }, EndFrame = { 8, 12 }, FrameRate = { 12, 16 }, BackgroundColor = { 16, 20 }, Resolution = { 20, 24 };
+			constexpr FieldOffset CompCount = { 32, 40 }, Comps = { 36, 48 }, VideoCount = { 40, 56 }, Videos = { 44, 64 }, AudioCount = { 48, 72 }, Audios = { 52, 80 };
+		}
+
+		namespace CompLayout
+		{
+			constexpr FieldOffset Stride = { 8, 16 }, LayerCount = { 0, 0 }, Layers = { 4, 8 };
+		}
+
+		namespace LayerLayout
+		{
+			constexpr FieldOffset Stride = { 48, 80 }, Name = { 0, 0 }, StartFrame = { 4, 8 }, EndFrame = { 8, 12 }, StartOffset = { 12, 16 }, TimeScale = { 16, 20 };
+			constexpr FieldOffset Flags = { 20, 24 }, Quality = { 22, 26 }, ItemType = { 23, 27 }, Item = { 24, 32 }, Parent = { 28, 40 };
+			constexpr FieldOffset MarkerCount = { 32, 48 }, Markers = { 36, 56 }, LayerVideo = { 40, 64 };
+		}
+
+		namespace MarkerLayout
+		{
+			constexpr FieldOffset Stride = { 8, 16 }, Frame = { 0, 0 }, Name = { 4, 8 };
+		}
+
+		namespace LayerVideoLayout
+		{
+			constexpr FieldOffset Transform = { 4, 8 }, Transform3D = { 68, 136 };
+		}
+
+		namespace FCurveLayout
+		{
+			constexpr FieldOffset Stride = { 8, 16 }, KeyCount = { 0, 0 }, Keys = { 4, 8 };
+		}
+
+		namespace VideoLayout
+		{
+			constexpr FieldOffset Stride = { 20, 24 }, Color = { 0, 0 }, Size = { 4, 4 }, FilesPerFrame = { 8, 8 }, SourceCount = { 12, 12 }, Sources = { 16, 16 };
+		}
+
+		namespace VideoSourceLayout
+		{
+			constexpr FieldOffset Stride = { 8, 16 }, Name = { 0, 0 }, ID = { 4, 8 };
+		}
+
+		namespace AudioLayout
+		{
+			constexpr FieldOffset Stride = { 4, 4 }, SoundID = { 0, 0 };
+		}
+	}
+
+	static const u8* Field(const ViewBase& view, FieldOffset offset, size_t index = 0, FieldOffset stride = {})
+	{
+		if (!view.IsValid())
+			return nullptr;
+		return view.Data + view.Set->InternalSelectOffset(offset.Mode32, offset.Mode64) + (index * view.Set->InternalSelectOffset(stride.Mode32, stride.Mode64));
+	}
+
+	// NOTE: All field reads are checked against the bounds of the set data, with out of range fields of malformed files reading as zero and unresolvable pointers as null
+	template <typename T>
+	static T ReadField(const ViewBase& view, FieldOffset offset)
+	{
+		const u8* field = Field(view, offset);
+		return (field != nullptr && view.Set->InternalContains(field, sizeof(T))) ? AetSetView::InternalReadField<T>(field) : T {};
+	}
+
+	static size_t ReadSizeField(const ViewBase& view, FieldOffset offset) { return view.IsValid() ? view.Set->InternalReadSize(Field(view, offset)) : 0; }
+	static const u8* ResolvePtrField(const ViewBase& view, FieldOffset offset) { return view.IsValid() ? view.Set->InternalResolvePtr(Field(view, offset)) : nullptr; }
+	static std::string_view ResolveStrField(const ViewBase& view, FieldOffset offset) { return view.IsValid() ? view.Set->InternalResolveStr(Field(view, offset)) : ""; }
+
+	template <typename ViewType>
+	static ViewType MakeView(const ViewBase& parent, const u8* data) { ViewType view; view.Set = parent.Set; view.Data = data; return view; }
+
+	template <typename ViewType>
+	static ViewType ResolveView(const ViewBase& parent, FieldOffset ptrField) { return MakeView<ViewType>(parent, ResolvePtrField(parent, ptrField)); }
+
+	template <typename ViewType>
+	static ViewType ResolveArrayView(const ViewBase& parent, FieldOffset ptrField, size_t index, size_t count, FieldOffset stride)
+	{
+		if (index >= count)
+			return ViewType {};
+
+		const u8* arrayData = ResolvePtrField(parent, ptrField);
+		if (arrayData == nullptr)
+			return ViewType {};
+
+		const size_t strideSize = parent.Set->InternalSelectOffset(stride.Mode32, stride.Mode64);
+		if (!parent.Set->InternalContainsArray(arrayData, count, strideSize))
+			return ViewType {};
+
+		return MakeView<ViewType>(parent, arrayData + (index * strideSize));
+	}
+
+	size_t FCurveView::GetKeyCount() const
+	{
+		return ReadSizeField(*this, ViewLayout::FCurveLayout::KeyCount);
+	}
+
+	const u8* FCurveView::InternalGetKeyData(size_t keyCount) const
+	{
+		// NOTE: Single key curves only store their value, all others a frame array followed by an array of value tangent pairs
+		const u8* keyData = ResolvePtrField(*this, ViewLayout::FCurveLayout::Keys);
+		const size_t keySize = (keyCount == 1) ? sizeof(f32) : sizeof(f32[3]);
+		return (keyData != nullptr && Set->InternalContainsArray(keyData, keyCount, keySize)) ? keyData : nullptr;
+	}
+
+	KeyFrame FCurveView::GetKey(size_t index) const
+	{
+		const size_t keyCount = GetKeyCount();
+		const u8* keyData = InternalGetKeyData(keyCount);
+		if (index >= keyCount || keyData == nullptr)
+			return KeyFrame {};
+
+		if (keyCount == 1)
+			return KeyFrame(AetSetView::InternalReadField<f32>(keyData));
+
+		const u8* frameData = keyData + (index * sizeof(f32));
+		const u8* valueTangentData = keyData + (keyCount * sizeof(f32)) + (index * sizeof(f32[2]));
+
+		return KeyFrame(
+			AetSetView::InternalReadField<f32>(frameData),
+			AetSetView::InternalReadField<f32>(valueTangentData),
+			AetSetView::InternalReadField<f32>(valueTangentData + sizeof(f32)));
+	}
+
+	f32 FCurveView::SampleAt(frame_t frame) const
+	{
+		const size_t keyCount = GetKeyCount();
+		const u8* keyData = InternalGetKeyData(keyCount);
+		if (keyCount <= 0 || keyData == nullptr)
+			return 0.0f;
+
+		const auto readFrame = [keyData](size_t index) { return AetSetView::InternalReadField<f32>(keyData + (index * sizeof(f32))); };
+		const auto readKey = [keyData, keyCount, &readFrame](size_t index)
+		{
+			const u8* valueTangentData = keyData + (keyCount * sizeof(f32)) + (index * sizeof(f32[2]));
+			return KeyFrame(readFrame(index), AetSetView::InternalReadField<f32>(valueTangentData), AetSetView::InternalReadField<f32>(valueTangentData + sizeof(f32)));
+		};
+
+		if (keyCount == 1)
+			return AetSetView::InternalReadField<f32>(keyData);
+		else if (frame <= readFrame(0))
+			return readKey(0).Value;
+		else if (frame >= readFrame(keyCount - 1))
+			return readKey(keyCount - 1).Value;
+
+		// NOTE: Same as SampleFCurveAt(), binary searching the frame array for the first key at or after the input frame
+		size_t endIndex = 1, searchCount = (keyCount - 1);
+		while (searchCount > 0)
+		{
+			const size_t halfCount = (searchCount / 2);
+			if (readFrame(endIndex + halfCount) < frame)
+			{
+				endIndex += (halfCount + 1);
+				searchCount -= (halfCount + 1);
+			}
+			else
+			{
+				searchCount = halfCount;
+			}
+		}
+
+		return InterpolateHermite(readKey(endIndex - 1), readKey(endIndex), frame);
+	}
+
+	FCurveView LayerVideoView::GetTransform(Transform2DField field) const
+	{
+		assert(field < Transform2DField_Count);
+		return IsValid() ? MakeView<FCurveView>(*this, Field(*this, ViewLayout::LayerVideoLayout::Transform, field, ViewLayout::FCurveLayout::Stride)) : FCurveView {};
+	}
+
+	LayerTransferMode LayerVideoView::GetTransferMode() const
+	{
+		const u8* field = Field(*this, FieldOffset { 0, 0 });
+		if (field == nullptr || !Set->InternalContains(field, sizeof(u8[3])))
+			return LayerTransferMode {};
+
+		return LayerTransferMode { static_cast<BlendMode>(field[0]), AetSetView::InternalReadField<TransferFlags>(&field[1]), static_cast<TrackMatte>(field[2]) };
+	}
+
+	b8 LayerVideoView::HasTransform3D() const
+	{
+		return (ResolvePtrField(*this, ViewLayout::LayerVideoLayout::Transform3D) != nullptr);
+	}
+
+	FCurveView LayerVideoView::GetTransform3D(size_t curveIndex) const
+	{
+		return ResolveArrayView<FCurveView>(*this, ViewLayout::LayerVideoLayout::Transform3D, curveIndex, Transform3DCurveCount, ViewLayout::FCurveLayout::Stride);
+	}
+
+	frame_t MarkerView::GetFrame() const { return ReadField<f32>(*this, ViewLayout::MarkerLayout::Frame); }
+	std::string_view MarkerView::GetName() const { return ResolveStrField(*this, ViewLayout::MarkerLayout::Name); }
+
+	u32 VideoView::GetColor() const { return ReadField<u32>(*this, ViewLayout::VideoLayout::Color) & 0x00FFFFFF; }
+	ivec2 VideoView::GetSize() const
+	{
+		const u32 packedSize = ReadField<u32>(*this, ViewLayout::VideoLayout::Size);
+		u16 size[2]; std::memcpy(size, &packedSize, sizeof(size));
+		return ivec2(size[0], size[1]);
+	}
+	f32 VideoView::GetFilesPerFrame() const { return ReadField<f32>(*this, ViewLayout::VideoLayout::FilesPerFrame); }
+	size_t VideoView::GetSourceCount() const { return ReadField<u32>(*this, ViewLayout::VideoLayout::SourceCount); }
+	std::string_view VideoView::GetSourceName(size_t index) const
+	{
+		const auto source = ResolveArrayView<ViewBase>(*this, ViewLayout::VideoLayout::Sources, index, GetSourceCount(), ViewLayout::VideoSourceLayout::Stride);
+		return ResolveStrField(source, ViewLayout::VideoSourceLayout::Name);
+	}
+	SprID VideoView::GetSourceID(size_t index) const
+	{
+		const auto source = ResolveArrayView<ViewBase>(*this, ViewLayout::VideoLayout::Sources, index, GetSourceCount(), ViewLayout::VideoSourceLayout::Stride);
+		return static_cast<SprID>(ReadField<u32>(source, ViewLayout::VideoSourceLayout::ID));
+	}
+
+	u32 AudioView::GetSoundID() const { return ReadField<u32>(*this, ViewLayout::AudioLayout::SoundID); }
+
+	std::string_view LayerView::GetName() const { return ResolveStrField(*this, ViewLayout::LayerLayout::Name); }
+	frame_t LayerView::GetStartFrame() const { return ReadField<f32>(*this, ViewLayout::LayerLayout::StartFrame); }
+	frame_t LayerView::GetEndFrame() const { return ReadField<f32>(*this, ViewLayout::LayerLayout::EndFrame); }
+	frame_t LayerView::GetStartOffset() const { return ReadField<f32>(*this, ViewLayout::LayerLayout::StartOffset); }
+	f32 LayerView::GetTimeScale() const { return ReadField<f32>(*this, ViewLayout::LayerLayout::TimeScale); }
+	LayerFlags LayerView::GetFlags() const { return ReadField<LayerFlags>(*this, ViewLayout::LayerLayout::Flags); }
+	LayerQuality LayerView::GetQuality() const { return static_cast<LayerQuality>(ReadField<u8>(*this, ViewLayout::LayerLayout::Quality)); }
+	ItemType LayerView::GetItemType() const { return static_cast<ItemType>(ReadField<u8>(*this, ViewLayout::LayerLayout::ItemType)); }
+
+	VideoView LayerView::GetVideoItem() const { return (GetItemType() == ItemType::Video) ? ResolveView<VideoView>(*this, ViewLayout::LayerLayout::Item) : VideoView {}; }
+	AudioView LayerView::GetAudioItem() const { return (GetItemType() == ItemType::Audio) ? ResolveView<AudioView>(*this, ViewLayout::LayerLayout::Item) : AudioView {}; }
+	CompositionView LayerView::GetCompItem() const { return (GetItemType() == ItemType::Composition) ? ResolveView<CompositionView>(*this, ViewLayout::LayerLayout::Item) : CompositionView {}; }
+	LayerView LayerView::GetRefParentLayer() const { return ResolveView<LayerView>(*this, ViewLayout::LayerLayout::Parent); }
+
+	size_t LayerView::GetMarkerCount() const { return ReadSizeField(*this, ViewLayout::LayerLayout::MarkerCount); }
+	MarkerView LayerView::GetMarker(size_t index) const { return ResolveArrayView<MarkerView>(*this, ViewLayout::LayerLayout::Markers, index, GetMarkerCount(), ViewLayout::MarkerLayout::Stride); }
+	LayerVideoView LayerView::GetLayerVideo() const { return ResolveView<LayerVideoView>(*this, ViewLayout::LayerLayout::LayerVideo); }
+
+	size_t CompositionView::GetLayerCount() const { return ReadSizeField(*this, ViewLayout::CompLayout::LayerCount); }
+	LayerView CompositionView::GetLayer(size_t index) const { return ResolveArrayView<LayerView>(*this, ViewLayout::CompLayout::Layers, index, GetLayerCount(), ViewLayout::LayerLayout::Stride); }
+
+	std::string_view SceneView::GetName() const { return ResolveStrField(*this, ViewLayout::SceneLayout::Name); }
+	frame_t SceneView::GetStartFrame() const { return ReadField<f32>(*this, ViewLayout::SceneLayout::StartFrame); }
+	frame_t SceneView::GetEndFrame() const { return ReadField<f32>(*this, ViewLayout::SceneLayout::EndFrame); }
+	frame_t SceneView::GetFrameRate() const { return ReadField<f32>(*this, ViewLayout::SceneLayout::FrameRate); }
+	u32 SceneView::GetBackgroundColor() const { return ReadField<u32>(*this, ViewLayout::SceneLayout::BackgroundColor) & 0x00FFFFFF; }
+	ivec2 SceneView::GetResolution() const { return ReadField<ivec2>(*this, ViewLayout::SceneLayout::Resolution); }
+
+	size_t SceneView::GetCompositionCount() const
+	{
+		const size_t compCountIncludingRoot = ReadSizeField(*this, ViewLayout::SceneLayout::CompCount);
+		return (compCountIncludingRoot > 0) ? (compCountIncludingRoot - 1) : 0;
+	}
+
+	CompositionView SceneView::GetComposition(size_t index) const
+	{
+		return ResolveArrayView<CompositionView>(*this, ViewLayout::SceneLayout::Comps, index, ReadSizeField(*this, ViewLayout::SceneLayout::CompCount), ViewLayout::CompLayout::Stride);
+	}
+
+	CompositionView SceneView::GetRootComposition() const { return (ReadSizeField(*this, ViewLayout::SceneLayout::CompCount) > 0) ? GetComposition(GetCompositionCount()) : CompositionView {}; }
+
+	size_t SceneView::GetVideoCount() const { return ReadSizeField(*this, ViewLayout::SceneLayout::VideoCount); }
+	VideoView SceneView::GetVideo(size_t index) const { return ResolveArrayView<VideoView>(*this, ViewLayout::SceneLayout::Videos, index, GetVideoCount(), ViewLayout::VideoLayout::Stride); }
+
+	size_t SceneView::GetAudioCount() const { return ReadSizeField(*this, ViewLayout::SceneLayout::AudioCount); }
+	AudioView SceneView::GetAudio(size_t index) const { return ResolveArrayView<AudioView>(*this, ViewLayout::SceneLayout::Audios, index, GetAudioCount(), ViewLayout::AudioLayout::Stride); }
+
+	SceneView AetSetView::GetScene(size_t index) const
+	{
+		if (index >= sceneCount)
+			return SceneView {};
+
+		SceneView view;
+		view.Set = this;
+		view.Data = InternalResolvePtr(data.get() + (index * InternalPtrFieldSize()));
+		return view;
+	}
+
+	b8 AetSetView::InternalContains(const u8* address, size_t size) const
+	{
+		const uintptr_t begin = reinterpret_cast<uintptr_t>(data.get()), target = reinterpret_cast<uintptr_t>(address);
+		return (address != nullptr && target >= begin && size <= dataSize && (target - begin) <= (dataSize - size));
+	}
+
+	b8 AetSetView::InternalContainsArray(const u8* address, size_t count, size_t elementSize) const
+	{
+		return (elementSize == 0 || count <= (dataSize / elementSize)) && InternalContains(address, count * elementSize);
+	}
+
+	size_t AetSetView::InternalReadSize(const u8* field) const
+	{
+		if (!InternalContains(field, InternalPtrFieldSize()))
+			return 0;
+
+		return (ptrSize == PtrSize::Mode64Bit) ? static_cast<size_t>(InternalReadField<u64>(field)) : static_cast<size_t>(InternalReadField<u32>(field));
+	}
+
+	const u8* AetSetView::InternalResolvePtr(const u8* field) const
+	{
+		if (!InternalContains(field, InternalPtrFieldSize()))
+			return nullptr;
+
+		// NOTE: Fields missing from the relocation table still hold their unrelocated file offsets which could otherwise happen to point to unrelated data within bounds
+		if (!relocatedFields[static_cast<size_t>(field - data.get())])
+			return nullptr;
+
+		// NOTE: 64-bit pointer fields have been relocated to native pointers, 32-bit ones are too small for that and instead hold offsets from the start of the data buffer
+		const u8* resolved = nullptr;
+		if (ptrSize == PtrSize::Mode64Bit)
+			resolved = reinterpret_cast<const u8*>(static_cast<uintptr_t>(InternalReadField<u64>(field)));
+		else if (const u32 dataOffset = InternalReadField<u32>(field); dataOffset != 0)
+			resolved = (dataOffset < dataSize) ? (data.get() + dataOffset) : nullptr;
+
+		return InternalContains(resolved, 1) ? resolved : nullptr;
+	}
+
+	std::string_view AetSetView::InternalResolveStr(const u8* field) const
+	{
+		const u8* stringData = InternalResolvePtr(field);
+		if (stringData == nullptr)
+			return "";
+
+		return FixedBufferStringView(reinterpret_cast<cstr>(stringData), static_cast<size_t>((data.get() + dataSize) - stringData));
+	}
+
+	StreamResult AetSetView::Read(StreamReader& reader)
+	{
+		auto baseHeader = SectionHeader::TryRead(reader, SectionSignature::AETC);
+		if (!baseHeader.has_value())
+			return StreamResult::BadFormat;
+
+		// NOTE: Big endian sections can only be viewed in place once all of their fields have been swapped as described by their ENRS table
+		SectionByteSwapScope byteSwapScope { reader, baseHeader };
+		if (baseHeader->Endianness != Endianness::Little)
+			return StreamResult::BadFormat;
+
+		auto relocationHeader = SectionHeader::TryFindSubSection(reader, *baseHeader, SectionSignature::POF0);
+		if (!relocationHeader.has_value())
+			relocationHeader = SectionHeader::TryFindSubSection(reader, *baseHeader, SectionSignature::POF1);
+		if (!relocationHeader.has_value())
+			return StreamResult::BadFormat;
+
+		ptrSize = (relocationHeader->Signature == SectionSignature::POF1) ? PtrSize::Mode64Bit : PtrSize::Mode32Bit;
+		reader.SetPtrSize(ptrSize);
+
+		if (baseHeader->EndOfSubSectionAddress() > reader.GetLength() || relocationHeader->EndOfSubSectionAddress() > reader.GetLength())
+			return StreamResult::BadCount;
+
+		dataSize = baseHeader->DataSize;
+		data = std::make_unique<u8[]>(dataSize);
+		reader.Seek(baseHeader->StartOfSubSectionAddress());
+		reader.ReadBuffer(data.get(), dataSize);
+
+		if (relocationHeader->DataSize < sizeof(u32))
+			return StreamResult::BadCount;
+
+		reader.Seek(relocationHeader->StartOfSubSectionAddress());
+		const size_t relocationTableSize = Clamp(static_cast<size_t>(reader.ReadU32_LE()), sizeof(u32), relocationHeader->DataSize) - sizeof(u32);
+
+		auto relocationTable = std::make_unique<u8[]>(relocationTableSize);
+		reader.ReadBuffer(relocationTable.get(), relocationTableSize);
+
+		// NOTE: 64-bit pointers are relative to the start of the section data while 32-bit pointers are absolute file addresses
+		const i64 fileToDataOffset = (ptrSize == PtrSize::Mode64Bit) ? 0 : -static_cast<i64>(baseHeader->StartOfSubSectionAddress());
+		const size_t ptrFieldSize = InternalPtrFieldSize();
+
+		relocatedFields.assign(dataSize, false);
+
+		b8 allPointersValid = true;
+		ForEachPOFRelocationOffset(relocationTable.get(), relocationTableSize, ptrSize, [&](size_t fieldOffset)
+		{
+			if (fieldOffset + ptrFieldSize > dataSize || relocatedFields[fieldOffset]) { allPointersValid = false; return; }
+			u8* field = data.get() + fieldOffset;
+			relocatedFields[fieldOffset] = true;
+
+			const i64 filePointer = (ptrSize == PtrSize::Mode64Bit) ? static_cast<i64>(InternalReadField<u64>(field)) : static_cast<i64>(InternalReadField<u32>(field));
+			if (filePointer == 0)
+				return;
+
+			const i64 dataOffset = filePointer + fileToDataOffset;
+			if (dataOffset <= 0 || dataOffset >= static_cast<i64>(dataSize)) { allPointersValid = false; return; }
+
+			if (ptrSize == PtrSize::Mode64Bit)
+			{
+				const u64 nativePointer = static_cast<u64>(reinterpret_cast<uintptr_t>(data.get() + dataOffset));
+				std::memcpy(field, &nativePointer, sizeof(nativePointer));
+			}
+			else
+			{
+				const u32 relocatedOffset = static_cast<u32>(dataOffset);
+				std::memcpy(field, &relocatedOffset, sizeof(relocatedOffset));
+			}
+		});
+
+		if (!allPointersValid)
+			return StreamResult::BadPointer;
+
+		sceneCount = 0;
+		for (size_t offset = 0; (offset + ptrFieldSize) <= dataSize; offset += ptrFieldSize)
+		{
+			if (InternalResolvePtr(data.get() + offset) == nullptr)
+				break;
+			sceneCount++;
+		}
+
+		return StreamResult::Success;
+	}
+}
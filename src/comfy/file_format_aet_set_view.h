@@ -0,0 +1,152 @@
+#pragma once
+#include "core_types.h"
+#include "file_format_common.h"
+#include "file_format_aet_set.h"
+
+namespace Comfy::Aet
+{
+	struct AetSetView;
+
+	// NOTE: Non-owning accessors directly into the relocated in-file data of an AetSetView. Only valid for as long as the parent AetSetView is alive
+	//		 Each view is a simple pair of the parent set and the start address of the structure within the set data, which may be null for unset pointers.
+	//		 As the files may not be trusted every access is checked against the set data bounds and the stored counts. Out of range indices, fields
+	//		 and pointers yield invalid views, zero values and empty strings instead, so accessing a view of an invalid view is always safe
+	struct ViewBase
+	{
+		const AetSetView* Set = nullptr;
+		const u8* Data = nullptr;
+
+		inline b8 IsValid() const { return (Set != nullptr && Data != nullptr); }
+	};
+
+	struct FCurveView : ViewBase
+	{
+		size_t GetKeyCount() const;
+		// NOTE: The frame of single key curves is implicitly that of the parent layer start frame and reported as 0.0f here
+		KeyFrame GetKey(size_t index) const;
+		f32 SampleAt(frame_t frame) const;
+
+		const u8* InternalGetKeyData(size_t keyCount) const;
+	};
+
+	struct LayerVideoView : ViewBase
+	{
+		LayerTransferMode GetTransferMode() const;
+		FCurveView GetTransform(Transform2DField field) const;
+
+		// NOTE: Indexed in the same order as the LayerVideo3D members (OriginZ, PositionZ, DirectionXYZ.X/Y/Z, RotationXY.X/Y, ScaleZ)
+		static constexpr size_t Transform3DCurveCount = 8;
+		b8 HasTransform3D() const;
+		FCurveView GetTransform3D(size_t curveIndex) const;
+	};
+
+	struct MarkerView : ViewBase
+	{
+		frame_t GetFrame() const;
+		std::string_view GetName() const;
+	};
+
+	struct VideoView : ViewBase
+	{
+		u32 GetColor() const;
+		ivec2 GetSize() const;
+		f32 GetFilesPerFrame() const;
+		size_t GetSourceCount() const;
+		std::string_view GetSourceName(size_t index) const;
+		SprID GetSourceID(size_t index) const;
+	};
+
+	struct AudioView : ViewBase
+	{
+		u32 GetSoundID() const;
+	};
+
+	struct CompositionView;
+
+	struct LayerView : ViewBase
+	{
+		std::string_view GetName() const;
+		frame_t GetStartFrame() const;
+		frame_t GetEndFrame() const;
+		frame_t GetStartOffset() const;
+		f32 GetTimeScale() const;
+		LayerFlags GetFlags() const;
+		LayerQuality GetQuality() const;
+		ItemType GetItemType() const;
+
+		VideoView GetVideoItem() const;
+		AudioView GetAudioItem() const;
+		CompositionView GetCompItem() const;
+		LayerView GetRefParentLayer() const;
+
+		size_t GetMarkerCount() const;
+		MarkerView GetMarker(size_t index) const;
+		LayerVideoView GetLayerVideo() const;
+	};
+
+	struct CompositionView : ViewBase
+	{
+		size_t GetLayerCount() const;
+		LayerView GetLayer(size_t index) const;
+	};
+
+	struct SceneView : ViewBase
+	{
+		std::string_view GetName() const;
+		frame_t GetStartFrame() const;
+		frame_t GetEndFrame() const;
+		frame_t GetFrameRate() const;
+		u32 GetBackgroundColor() const;
+		ivec2 GetResolution() const;
+
+		// NOTE: Excluding the root composition which is always stored last
+		size_t GetCompositionCount() const;
+		CompositionView GetComposition(size_t index) const;
+		CompositionView GetRootComposition() const;
+
+		size_t GetVideoCount() const;
+		VideoView GetVideo(size_t index) const;
+
+		size_t GetAudioCount() const;
+		AudioView GetAudio(size_t index) const;
+	};
+
+	// NOTE: Read-only AetSet loaded straight from a section format (aet_*.aec) file. The AETC section data is read into a single buffer
+	//		 after which the POF relocation table is applied to it in one linear pass, turning all file offsets into pointers into that buffer.
+	//		 No further parsing or allocation takes place, all data is accessed in place through the returned views.
+	//		 Pointer fields which aren't listed in the relocation table resolve to null, even if their unrelocated value happens to lie within the data
+	struct AetSetView final : IStreamReadable, NonCopyable
+	{
+		AetSetView() = default;
+		~AetSetView() = default;
+
+		StreamResult Read(StreamReader& reader) override;
+
+		inline size_t GetSceneCount() const { return sceneCount; }
+		SceneView GetScene(size_t index) const;
+
+		inline PtrSize GetPtrSize() const { return ptrSize; }
+		inline const u8* GetData() const { return data.get(); }
+		inline size_t GetDataSize() const { return dataSize; }
+
+		template <typename T>
+		static inline T InternalReadField(const u8* field) { T value; std::memcpy(&value, field, sizeof(T)); return value; }
+
+		inline size_t InternalPtrFieldSize() const { return (ptrSize == PtrSize::Mode64Bit) ? sizeof(u64) : sizeof(u32); }
+		inline size_t InternalSelectOffset(size_t offset32, size_t offset64) const { return (ptrSize == PtrSize::Mode64Bit) ? offset64 : offset32; }
+
+		b8 InternalContains(const u8* address, size_t size) const;
+		b8 InternalContainsArray(const u8* address, size_t count, size_t elementSize) const;
+		size_t InternalReadSize(const u8* field) const;
+		const u8* InternalResolvePtr(const u8* field) const;
+		std::string_view InternalResolveStr(const u8* field) const;
+
+	private:
+		std::unique_ptr<u8[]> data = nullptr;
+		size_t dataSize = 0;
+		// NOTE: One entry per data byte marking the start of each pointer field listed in the relocation table
+		std::vector<bool> relocatedFields;
+		size_t sceneCount = 0;
+		PtrSize ptrSize = PtrSize::Mode32Bit;
+	};
+}
@@ -1,5 +1,6 @@
 #include "file_format_common.h"
 #include <Windows.h>
+#include <emmintrin.h>
 
 namespace Comfy
 {
@@ -138,7 +139,9 @@ namespace Comfy
 
 	MemoryStream::MemoryStream(MemoryStream&& other) : MemoryStream()
 	{
-		if (other.IsOwning())
+		if (other.sharedDataVector != nullptr && other.IsOwning())
+			dataVectorPtr = (sharedDataVector = std::move(other.sharedDataVector)).get();
+		else if (other.IsOwning())
 			owningDataVector = std::move(other.owningDataVector);
 		else
 			dataVectorPtr = other.dataVectorPtr;
@@ -175,6 +178,20 @@ namespace Comfy
 		return size;
 	}
 
+	std::shared_ptr<std::vector<u8>> MemoryStream::ShareDataVector()
+	{
+		if (!IsOpen() || !IsOwning())
+			return nullptr;
+
+		if (sharedDataVector == nullptr || dataVectorPtr != sharedDataVector.get())
+		{
+			sharedDataVector = std::make_shared<std::vector<u8>>(std::move(owningDataVector));
+			dataVectorPtr = sharedDataVector.get();
+		}
+
+		return sharedDataVector;
+	}
+
 	void MemoryStream::FromStreamSource(std::vector<u8>& source)
 	{
 		isOpen = true;
@@ -210,6 +227,7 @@ namespace Comfy
 		dataSize = {};
 		dataVectorPtr = nullptr;
 		owningDataVector.clear();
+		sharedDataVector = nullptr;
 	}
 
 	MemoryWriteStream::MemoryWriteStream(std::unique_ptr<u8[]>& dataBuffer) : dataBuffer(dataBuffer)
@@ -279,7 +297,7 @@ namespace Comfy
 	{
 		for (const auto& value : StringPointerPool)
 		{
-			const auto originalStringOffset = GetPosition();
+			const auto originalStringOffset = GetPositionOffsetAware();
 			auto stringOffset = originalStringOffset;
 
 			b8 pooledStringFound = false;
@@ -293,6 +311,7 @@ namespace Comfy
 			}
 
 			SeekOffsetAware(value.ReturnAddress);
+			WrittenPointerAddresses.push_back(GetPosition());
 			WritePtr(stringOffset);
 
 			if (!pooledStringFound)
@@ -322,9 +341,15 @@ namespace Comfy
 	{
 		for (const auto& value : PointerPool)
 		{
-			const auto offset = GetPosition();
+			// NOTE: Keep 64-bit pointer fields naturally aligned, as is required by the POF1 relocation table
+			if (Is64)
+				WriteAlignmentPadding(sizeof(u64));
+
+			const auto offset = GetPositionOffsetAware();
 
 			SeekOffsetAware(value.ReturnAddress);
+			if (value.BaseAddress == FileAddr::NullPtr)
+				WrittenPointerAddresses.push_back(GetPosition());
 			WritePtr(offset - value.BaseAddress);
 
 			SeekOffsetAware(offset);
@@ -338,9 +363,11 @@ namespace Comfy
 	{
 		for (const auto& value : DelayedWritePool)
 		{
-			const auto offset = GetPosition();
+			const auto offset = GetPositionOffsetAware();
 
 			SeekOffsetAware(value.ReturnAddress);
+			if (value.IsPointer)
+				WrittenPointerAddresses.push_back(GetPosition());
 			value.Func(*this);
 
 			SeekOffsetAware(offset);
@@ -385,31 +412,361 @@ namespace Comfy
 		return SectionHeader::Read(reader);
 	}
 
+	std::optional<SectionHeader> SectionHeader::TryFindSubSection(StreamReader& reader, const SectionHeader& parentSection, SectionSignature subSectionSignature)
+	{
+		const SectionHeader* foundHeader = SectionIndex::GetOrBuild(reader).FindSubSection(parentSection, subSectionSignature);
+		return (foundHeader != nullptr) ? std::optional<SectionHeader>(*foundHeader) : std::nullopt;
+	}
+
 	void SectionHeader::ScanPOFSectionsForPtrSize(StreamReader& reader)
 	{
 		if (!reader.HasSections || reader.HasBeenPtrSizeScanned)
 			return;
 
-		reader.ReadAt(FileAddr::NullPtr, [](StreamReader& reader)
+		const auto& sectionIndex = SectionIndex::GetOrBuild(reader);
+		const SectionHeader* pof0Header = sectionIndex.FindFirst(SectionSignature::POF0);
+		const SectionHeader* pof1Header = sectionIndex.FindFirst(SectionSignature::POF1);
+
+		// NOTE: The first relocation table in file order decides and in case none are found 32-bit should be the default
+		const b8 is64Bit = (pof1Header != nullptr && (pof0Header == nullptr || pof1Header->HeaderAddress < pof0Header->HeaderAddress));
+		reader.SetPtrSize(is64Bit ? PtrSize::Mode64Bit : PtrSize::Mode32Bit);
+
+		reader.HasBeenPtrSizeScanned = true;
+	}
+
+	const SectionHeader* SectionIndex::FindFirst(SectionSignature signature) const
+	{
+		const auto it = firstSectionLookup.find(signature);
+		return (it != firstSectionLookup.end()) ? &Entries[it->second].Header : nullptr;
+	}
+
+	const SectionHeader* SectionIndex::FindSubSection(const SectionHeader& parentSection, SectionSignature subSectionSignature) const
+	{
+		const auto parentIt = headerAddressLookup.find(parentSection.HeaderAddress);
+		if (parentIt == headerAddressLookup.end())
+			return nullptr;
+
+		const auto subSectionIt = firstSubSectionLookup.find(SubSectionKey(static_cast<i32>(parentIt->second), subSectionSignature));
+		return (subSectionIt != firstSubSectionLookup.end()) ? &Entries[subSectionIt->second].Header : nullptr;
+	}
+
+	SectionIndex SectionIndex::Build(StreamReader& reader)
+	{
+		static constexpr FileAddr headerSize = static_cast<FileAddr>(sizeof(u32[8]));
+
+		SectionIndex index;
+		reader.ReadAt(FileAddr::NullPtr, [&](StreamReader& reader)
 		{
-			const auto endOfSectionHeaders = reader.GetLength() - FileAddr(32);
-			while (reader.GetPosition() < endOfSectionHeaders)
+			// NOTE: Indices of all sections whose sub section range hasn't been left yet, innermost last
+			std::vector<i32> enclosingSections;
+
+			while (reader.GetPosition() + headerSize <= reader.GetLength())
 			{
-				const auto sectionHeader = SectionHeader::Read(reader);
-				if (sectionHeader.Signature == SectionSignature::POF0) { reader.SetPtrSize(PtrSize::Mode32Bit); return; }
-				if (sectionHeader.Signature == SectionSignature::POF1) { reader.SetPtrSize(PtrSize::Mode64Bit); return; }
+				const auto header = SectionHeader::Read(reader);
+
+				while (!enclosingSections.empty() && header.HeaderAddress >= index.Entries[enclosingSections.back()].Header.EndOfSectionAddress())
+					enclosingSections.pop_back();
 
-				const auto endOfSection = sectionHeader.EndOfSubSectionAddress();
+				const i32 entryIndex = static_cast<i32>(index.Entries.size());
+				const i32 parentIndex = enclosingSections.empty() ? -1 : enclosingSections.back();
+
+				index.Entries.push_back({ header, parentIndex });
+				index.firstSectionLookup.emplace(header.Signature, entryIndex);
+				index.headerAddressLookup.emplace(header.HeaderAddress, entryIndex);
+				index.firstSubSectionLookup.emplace(SubSectionKey(parentIndex, header.Signature), entryIndex);
+
+				if (header.EndOfSectionAddress() > header.EndOfSubSectionAddress())
+					enclosingSections.push_back(entryIndex);
+
+				const auto endOfSection = header.EndOfSubSectionAddress();
 				if (endOfSection < reader.GetPosition())
-					return;
+					break;
 
 				reader.Seek(endOfSection);
 			}
-
-			// NOTE: In case no relocation tables are found 32-bit should be the default
-			reader.SetPtrSize(PtrSize::Mode32Bit);
 		});
 
-		reader.HasBeenPtrSizeScanned = true;
+		return index;
+	}
+
+	const SectionIndex& SectionIndex::GetOrBuild(StreamReader& reader)
+	{
+		if (reader.CachedSectionIndex == nullptr)
+			reader.CachedSectionIndex = std::make_shared<SectionIndex>(SectionIndex::Build(reader));
+		return *reader.CachedSectionIndex;
+	}
+
+	static constexpr u32 WrittenSectionHeaderSize = sizeof(u32[8]);
+
+	static void WriteSectionHeaderData(StreamWriter& writer, SectionSignature signature, size_t sectionSize, u32 depth, size_t dataSize)
+	{
+		writer.WriteU32_LE(static_cast<u32>(signature));
+		writer.WriteU32_LE(static_cast<u32>(sectionSize));
+		writer.WriteU32_LE(WrittenSectionHeaderSize);
+		writer.WriteU32_LE(static_cast<u32>((writer.GetEndianness() == Endianness::Big) ? SectionEndianness::Big : SectionEndianness::Little));
+		writer.WriteU32_LE(depth);
+		writer.WriteU32_LE(static_cast<u32>(dataSize));
+		writer.WriteU32_LE(0x00000000);
+		writer.WriteU32_LE(0x00000000);
+	}
+
+	static void WritePOFSubSection(StreamWriter& writer, const std::vector<size_t>& sortedRelocationOffsets)
+	{
+		const size_t offsetShift = (writer.GetPtrSize() == PtrSize::Mode64Bit) ? 3 : 2;
+
+		std::vector<u8> packedTable;
+		packedTable.reserve(sortedRelocationOffsets.size() * 2);
+
+		size_t previousOffset = 0;
+		for (const size_t offset : sortedRelocationOffsets)
+		{
+			const size_t delta = ((offset - previousOffset) >> offsetShift);
+			assert(((offset - previousOffset) & ((1 << offsetShift) - 1)) == 0 && delta < 0x40000000);
+			previousOffset = offset;
+
+			if (delta < 0x40)
+			{
+				packedTable.push_back(static_cast<u8>(0x40 | delta));
+			}
+			else if (delta < 0x4000)
+			{
+				packedTable.push_back(static_cast<u8>(0x80 | (delta >> 8)));
+				packedTable.push_back(static_cast<u8>(delta));
+			}
+			else
+			{
+				packedTable.push_back(static_cast<u8>(0xC0 | ((delta >> 24) & 0x3F)));
+				packedTable.push_back(static_cast<u8>(delta >> 16));
+				packedTable.push_back(static_cast<u8>(delta >> 8));
+				packedTable.push_back(static_cast<u8>(delta));
+			}
+		}
+
+		// NOTE: Zero terminated with the leading table size including itself
+		packedTable.push_back(0x00);
+		const size_t tableSize = (sizeof(u32) + packedTable.size());
+		const size_t alignedTableSize = ((tableSize + 15) & ~static_cast<size_t>(15));
+
+		const auto signature = (writer.GetPtrSize() == PtrSize::Mode64Bit) ? SectionSignature::POF1 : SectionSignature::POF0;
+		WriteSectionHeaderData(writer, signature, alignedTableSize, 1, alignedTableSize);
+
+		writer.WriteU32_LE(static_cast<u32>(tableSize));
+		writer.WriteBuffer(packedTable.data(), packedTable.size());
+		writer.WriteAlignmentPadding(16, 0x00000000);
+	}
+
+	void SectionHeader::WriteSection(StreamWriter& writer, SectionSignature signature, const std::function<void(StreamWriter&)>& writeDataFunc)
+	{
+		const auto headerAddress = writer.GetPosition();
+		WriteSectionHeaderData(writer, signature, 0, 0, 0);
+
+		const auto dataStartAddress = writer.GetPosition();
+		const size_t firstPointerIndex = writer.WrittenPointerAddresses.size();
+
+		if (writer.GetPtrSize() == PtrSize::Mode64Bit)
+			writer.PushBaseOffset();
+
+		writeDataFunc(writer);
+		writer.WriteAlignmentPadding(16);
+
+		if (writer.GetPtrSize() == PtrSize::Mode64Bit)
+			writer.PopBaseOffset();
+
+		const size_t dataSize = static_cast<size_t>(writer.GetPosition() - dataStartAddress);
+
+		std::vector<size_t> relocationOffsets;
+		relocationOffsets.reserve(writer.WrittenPointerAddresses.size() - firstPointerIndex);
+		for (size_t i = firstPointerIndex; i < writer.WrittenPointerAddresses.size(); i++)
+			relocationOffsets.push_back(static_cast<size_t>(writer.WrittenPointerAddresses[i] - dataStartAddress));
+		writer.WrittenPointerAddresses.resize(firstPointerIndex);
+
+		std::sort(relocationOffsets.begin(), relocationOffsets.end());
+		relocationOffsets.erase(std::unique(relocationOffsets.begin(), relocationOffsets.end()), relocationOffsets.end());
+
+		if (!relocationOffsets.empty())
+			WritePOFSubSection(writer, relocationOffsets);
+
+		WriteSectionHeaderData(writer, SectionSignature::EOFC, 0, 1, 0);
+
+		const auto endAddress = writer.GetPosition();
+		writer.Seek(headerAddress);
+		WriteSectionHeaderData(writer, signature, static_cast<size_t>(endAddress - dataStartAddress), 0, dataSize);
+		writer.Seek(endAddress);
+	}
+
+	void SectionHeader::WriteEndOfFileSection(StreamWriter& writer)
+	{
+		WriteSectionHeaderData(writer, SectionSignature::EOFC, 0, 0, 0);
+	}
+
+	// NOTE: Reverse the byte order of count consecutive elementSize (2, 4 or 8) byte values. SSE2 only offers 16-bit word shuffles
+	//		 so 32-bit and 64-bit values first have the order of their words reversed before the two bytes within each word are swapped
+	static void ByteSwapArrayInPlace(u8* data, size_t elementSize, size_t count)
+	{
+		const size_t byteSize = (elementSize * count);
+
+		size_t i = 0;
+		for (; (i + sizeof(__m128i)) <= byteSize; i += sizeof(__m128i))
+		{
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			if (elementSize == sizeof(u32))
+				block = _mm_shufflehi_epi16(_mm_shufflelo_epi16(block, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+			else if (elementSize == sizeof(u64))
+				block = _mm_shufflehi_epi16(_mm_shufflelo_epi16(block, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+			block = _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), block);
+		}
+
+		for (; i < byteSize; i += elementSize)
+			std::reverse(data + i, data + i + elementSize);
+	}
+
+	// NOTE: Big endian packed ENRS value. The top two bits of the first byte select a total size of 1, 2 or 4 bytes,
+	//		 optionally followed by typeBitCount bits of type information with the remaining bits making up the value itself
+	static b8 ReadENRSPackedValue(const u8*& it, const u8* end, u32 typeBitCount, u32& outType, u32& outValue)
+	{
+		if (it >= end)
+			return false;
+
+		const u32 valueBitCount = (6 - typeBitCount);
+		const u32 sizeCode = (*it >> 6);
+		outType = (*it >> valueBitCount) & ((1u << typeBitCount) - 1);
+		outValue = (*it++ & ((1u << valueBitCount) - 1));
+
+		const size_t additionalBytes = (sizeCode == 0) ? 0 : (sizeCode == 1) ? 1 : (sizeCode == 2) ? 3 : 0;
+		if (sizeCode == 3 || (end - it) < static_cast<ptrdiff_t>(additionalBytes))
+			return false;
+
+		for (size_t i = 0; i < additionalBytes; i++)
+			outValue = (outValue << 8) | *it++;
+		return true;
+	}
+
+	b8 ApplyENRSByteSwapTable(u8* sectionData, size_t sectionDataSize, const u8* tableData, size_t tableSize)
+	{
+		// NOTE: { u32 Reserved; u32 ScopeCount; u32 Reserved[2]; } followed by the packed scope entries. Each scope consists of
+		//		 { Offset, FieldCount, Size, RepeatCount } followed by FieldCount { Type | Offset, RepeatCount } field entries.
+		//		 Scope offsets are relative to the start of the previous scope, each scope repetition starts Size bytes after the previous one
+		//		 and field offsets are relative to the end of the previous field run within the same repetition
+		static constexpr size_t tableHeaderSize = sizeof(u32[4]);
+		static constexpr size_t fieldTypeSizes[] = { sizeof(u16), sizeof(u32), sizeof(u64), 0 };
+
+		if (tableSize < tableHeaderSize)
+			return false;
+
+		u32 scopeCount;
+		std::memcpy(&scopeCount, tableData + sizeof(u32), sizeof(scopeCount));
+
+		const u8* it = tableData + tableHeaderSize;
+		const u8* end = tableData + tableSize;
+
+		struct ENRSField { size_t ElementSize, Offset, RepeatCount; };
+		std::vector<ENRSField> scopeFields;
+
+		size_t scopeStartOffset = 0;
+		for (u32 scopeIndex = 0; scopeIndex < scopeCount; scopeIndex++)
+		{
+			u32 unusedType, scopeOffset, fieldCount, scopeSize, scopeRepeatCount;
+			if (!ReadENRSPackedValue(it, end, 0, unusedType, scopeOffset) || !ReadENRSPackedValue(it, end, 0, unusedType, fieldCount) ||
+				!ReadENRSPackedValue(it, end, 0, unusedType, scopeSize) || !ReadENRSPackedValue(it, end, 0, unusedType, scopeRepeatCount))
+				return false;
+
+			scopeFields.clear();
+			for (u32 fieldIndex = 0; fieldIndex < fieldCount; fieldIndex++)
+			{
+				u32 fieldType, fieldOffset, fieldRepeatCount;
+				if (!ReadENRSPackedValue(it, end, 2, fieldType, fieldOffset) || !ReadENRSPackedValue(it, end, 0, unusedType, fieldRepeatCount))
+					return false;
+				if (fieldTypeSizes[fieldType] == 0)
+					return false;
+
+				scopeFields.push_back({ fieldTypeSizes[fieldType], fieldOffset, fieldRepeatCount });
+			}
+
+			scopeStartOffset += scopeOffset;
+			for (size_t repetition = 0; repetition < scopeRepeatCount; repetition++)
+			{
+				size_t fieldOffset = scopeStartOffset + (repetition * scopeSize);
+				for (const auto& field : scopeFields)
+				{
+					fieldOffset += field.Offset;
+					const size_t fieldRunSize = (field.ElementSize * field.RepeatCount);
+					if (fieldOffset + fieldRunSize > sectionDataSize)
+						return false;
+
+					ByteSwapArrayInPlace(sectionData + fieldOffset, field.ElementSize, field.RepeatCount);
+					fieldOffset += fieldRunSize;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	static b8 IsRelocationOrEndianSubSection(SectionSignature signature)
+	{
+		return (signature == SectionSignature::POF0 || signature == SectionSignature::POF1 || signature == SectionSignature::ENRS || signature == SectionSignature::EOFC);
+	}
+
+	SectionByteSwapScope::SectionByteSwapScope(StreamReader& reader, std::optional<SectionHeader>& baseHeader) : reader(reader), originalStream(reader.Stream)
+	{
+		if (!baseHeader.has_value() || baseHeader->Endianness != Endianness::Big)
+			return;
+
+		if (!SectionHeader::TryFindSubSection(reader, *baseHeader, SectionSignature::ENRS).has_value())
+			return;
+
+		swappedData.resize(static_cast<size_t>(reader.GetLength()));
+		reader.ReadAt(FileAddr::NullPtr, [&](StreamReader& reader) { reader.ReadBuffer(swappedData.data(), swappedData.size()); });
+		swappedStream.FromStreamSource(swappedData);
+
+		static constexpr size_t headerEndiannessOffset = sizeof(u32[3]);
+		const auto& sectionIndex = SectionIndex::GetOrBuild(reader);
+		const auto streamLength = reader.GetLength();
+
+		b8 anySectionSwapped = false;
+		for (const auto& entry : sectionIndex.Entries)
+		{
+			const auto& header = entry.Header;
+			if (header.HeaderAddress < baseHeader->HeaderAddress || header.Endianness != Endianness::Big || IsRelocationOrEndianSubSection(header.Signature))
+				continue;
+
+			const SectionHeader* enrsHeader = sectionIndex.FindSubSection(header, SectionSignature::ENRS);
+			if (enrsHeader == nullptr || header.EndOfSubSectionAddress() > streamLength || enrsHeader->EndOfSubSectionAddress() > streamLength)
+				continue;
+
+			u8* sectionData = &swappedData[static_cast<size_t>(header.StartOfSubSectionAddress())];
+			const u8* tableData = &swappedData[static_cast<size_t>(enrsHeader->StartOfSubSectionAddress())];
+
+			if (ApplyENRSByteSwapTable(sectionData, header.DataSize, tableData, enrsHeader->DataSize))
+			{
+				const u32 littleEndian = static_cast<u32>(SectionEndianness::Little);
+				std::memcpy(&swappedData[static_cast<size_t>(header.HeaderAddress) + headerEndiannessOffset], &littleEndian, sizeof(littleEndian));
+
+				if (header.HeaderAddress == baseHeader->HeaderAddress)
+					baseHeader->Endianness = Endianness::Little;
+				anySectionSwapped = true;
+			}
+			else
+			{
+				// NOTE: Restore the partially swapped data so that the section can still be parsed through the regular big endian path
+				reader.ReadAt(header.StartOfSubSectionAddress(), [&](StreamReader& reader) { reader.ReadBuffer(sectionData, header.DataSize); });
+			}
+		}
+
+		if (!anySectionSwapped)
+			return;
+
+		swappedStream.Seek(originalStream->GetPosition());
+		reader.Stream = &swappedStream;
+	}
+
+	SectionByteSwapScope::~SectionByteSwapScope()
+	{
+		if (reader.Stream != &swappedStream)
+			return;
+
+		originalStream->Seek(swappedStream.GetPosition());
+		reader.Stream = originalStream;
 	}
 }
@@ -72,7 +72,11 @@ namespace Comfy
 		inline b8 IsOpen() const override { return (isOpen && dataVectorPtr != nullptr); }
 		inline b8 CanRead() const override { return (isOpen && dataVectorPtr != nullptr); }
 		inline b8 CanWrite() const override { return false; }
-		inline b8 IsOwning() const { return (dataVectorPtr == &owningDataVector); }
+		inline b8 IsOwning() const { return (dataVectorPtr == &owningDataVector) || (sharedDataVector != nullptr && dataVectorPtr == sharedDataVector.get()); }
+		inline std::vector<u8>& GetDataVector() { return *dataVectorPtr; }
+		// NOTE: Moves the owned data into a buffer shared with the caller without copying it, the stream itself keeps reading from the shared buffer.
+		//		 Streams over a non owned source vector can't share their data and return null
+		std::shared_ptr<std::vector<u8>> ShareDataVector();
 
 		size_t ReadBuffer(void* buffer, size_t size) override;
 		size_t WriteBuffer(const void* buffer, size_t size) override;
@@ -98,6 +102,7 @@ namespace Comfy
 		FileAddr dataSize = {};
 		std::vector<u8>* dataVectorPtr = nullptr;
 		std::vector<u8> owningDataVector;
+		std::shared_ptr<std::vector<u8>> sharedDataVector;
 	};
 
 	struct MemoryWriteStream : IStream, NonCopyable
@@ -126,6 +131,12 @@ namespace Comfy
 
 	enum class PtrSize : u8 { Mode32Bit, Mode64Bit };
 
+	// NOTE: Layout of a whole file. The classic format is the plain data while the section formats wrap it in signature headers,
+	//		 each followed by the POF relocation table of all pointers written within and pointers of the given size
+	enum class StreamFormat : u8 { Classic, Section32Bit, Section64Bit };
+
+	struct SectionIndex;
+
 	struct StreamReadWriteBase
 	{
 		IStream* Stream = nullptr;
@@ -151,6 +162,8 @@ namespace Comfy
 		inline void SetPtrSize(PtrSize value) { Is64 = (value == PtrSize::Mode64Bit); }
 		inline Endianness GetEndianness() const { return IsBE ? Endianness::Big : Endianness::Little; }
 		inline void SetEndianness(Endianness value) { IsBE = (value == Endianness::Big); }
+		inline StreamFormat GetStreamFormat() const { return !HasSections ? StreamFormat::Classic : Is64 ? StreamFormat::Section64Bit : StreamFormat::Section32Bit; }
+		inline void SetStreamFormat(StreamFormat value) { HasSections = (value != StreamFormat::Classic); Is64 = (value == StreamFormat::Section64Bit); }
 	};
 
 	struct StreamReader final : StreamReadWriteBase
@@ -160,6 +173,9 @@ namespace Comfy
 			b8 EmptyNullStringPointers = false;
 		} Settings;
 
+		// NOTE: Built on first use by the section format parsing functions and shared between all of them, see SectionIndex::GetOrBuild
+		std::shared_ptr<SectionIndex> CachedSectionIndex;
+
 		explicit StreamReader(IStream& stream) : StreamReadWriteBase(stream) { assert(stream.CanRead()); }
 		inline void SeekAlign(i32 alignment) { i64 p = static_cast<i64>(GetPosition()); i64 d = ((p + (alignment - 1)) & ~(alignment - 1)) - p; if (d > 0) Skip(static_cast<FileAddr>(d)); }
 		template <typename T> inline T ReadT_Native() { T value; ReadBuffer(&value, sizeof(value)); return value; }
@@ -240,13 +256,16 @@ namespace Comfy
 
 		struct FunctionPointerEntry { FileAddr ReturnAddress, BaseAddress; std::function<void(StreamWriter&)> Func; };
 		struct StringPointerEntry { FileAddr ReturnAddress; std::string_view String; i32 Alignment; };
-		struct DelayedWriteEntry { FileAddr ReturnAddress; std::function<void(StreamWriter&)> Func; };
+		struct DelayedWriteEntry { FileAddr ReturnAddress; b8 IsPointer; std::function<void(StreamWriter&)> Func; };
 
 		// NOTE: Using std::list here to avoid invalidating previous entries while executing recursive pointer writes
 		std::list<FunctionPointerEntry> PointerPool;
 		std::vector<StringPointerEntry> StringPointerPool;
 		std::vector<DelayedWriteEntry> DelayedWritePool;
 		std::unordered_map<std::string, FileAddr> WrittenStringPool;
+		// NOTE: Absolute addresses of all pointer fields written through the pools, excluding those relative to a custom base address.
+		//		 Used to build the POF relocation table when writing section format files
+		std::vector<FileAddr> WrittenPointerAddresses;
 
 		explicit StreamWriter(IStream& stream) : StreamReadWriteBase(stream) { assert(stream.CanWrite()); }
 		template <typename T> inline void WriteT_Native(T value) { WriteBuffer(&value, sizeof(T)); }
@@ -291,12 +310,16 @@ namespace Comfy
 		inline void WriteStrPtr(std::string_view value, i32 alignment = 0)
 		{
 			if (Settings.EmptyNullStringPointers && value.empty()) { WritePtr(FileAddr::NullPtr); }
-			else { StringPointerPool.push_back({ GetPosition(), value, alignment }); WritePtr(FileAddr::NullPtr); }
+			else { StringPointerPool.push_back({ GetPositionOffsetAware(), value, alignment }); WritePtr(FileAddr::NullPtr); }
 		}
 		template <typename Func>
-		inline void WriteFuncPtr(Func func, FileAddr baseAddress = FileAddr::NullPtr) { PointerPool.push_back({ GetPosition(), baseAddress, std::function<void(StreamWriter&)> { func } }); WritePtr(FileAddr::NullPtr); }
+		inline void WriteFuncPtr(Func func, FileAddr baseAddress = FileAddr::NullPtr) { PointerPool.push_back({ GetPositionOffsetAware(), baseAddress, std::function<void(StreamWriter&)> { func } }); WritePtr(FileAddr::NullPtr); }
+		// NOTE: The func is expected to write a single pointer, the address of which is recorded for the POF relocation table
 		template <typename Func>
-		inline void WriteDelayedPtr(Func func) { DelayedWritePool.push_back({ GetPosition(), std::function<void(StreamWriter&)> { func } }); WritePtr(FileAddr::NullPtr); }
+		inline void WriteDelayedPtr(Func func) { DelayedWritePool.push_back({ GetPositionOffsetAware(), true, std::function<void(StreamWriter&)> { func } }); WritePtr(FileAddr::NullPtr); }
+		// NOTE: For any other pointer sized value only known later on, such as the size of a block, which must not be relocated
+		template <typename Func>
+		inline void WriteDelayedValue(Func func) { DelayedWritePool.push_back({ GetPositionOffsetAware(), false, std::function<void(StreamWriter&)> { func } }); WritePtr(FileAddr::NullPtr); }
 
 		void WritePadding(size_t size, u32 paddingValue = 0xCCCCCCCC);
 		void WriteAlignmentPadding(i32 alignment, u32 paddingValue = 0xCCCCCCCC);
@@ -350,7 +373,7 @@ namespace Comfy
 	}
 
 	template <typename Writable>
-	b8 SaveFile(std::string_view filePath, Writable& writable)
+	b8 SaveFile(std::string_view filePath, Writable& writable, StreamFormat format = StreamFormat::Classic)
 	{
 		static_assert(std::is_base_of_v<IStreamWritable, Writable>);
 		FileStream stream;
@@ -359,6 +382,7 @@ namespace Comfy
 			return false;
 
 		StreamWriter writer { stream };
+		writer.SetStreamFormat(format);
 		StreamResult streamResult = writable.Write(writer);
 		return (streamResult == StreamResult::Success);
 	}
@@ -371,9 +395,9 @@ namespace Comfy
 
 	// NOTE: The writable input parameter must outlive the duration of the returned future!
 	template <typename Writable>
-	std::future<b8> SaveFileAsync(std::string_view filePath, Writable* writable)
+	std::future<b8> SaveFileAsync(std::string_view filePath, Writable* writable, StreamFormat format = StreamFormat::Classic)
 	{
-		return std::async(std::launch::async, [pathCopy = std::string(filePath), writable] { return (writable != nullptr) ? SaveFile<Writable>(pathCopy, *writable) : false; });
+		return std::async(std::launch::async, [pathCopy = std::string(filePath), writable, format] { return (writable != nullptr) ? SaveFile<Writable>(pathCopy, *writable, format) : false; });
 	}
 
 	enum class SectionEndianness : u32
@@ -428,6 +452,95 @@ namespace Comfy
 
 		static SectionHeader Read(StreamReader& reader);
 		static std::optional<SectionHeader> TryRead(StreamReader& reader, SectionSignature expectedSignature);
+		static std::optional<SectionHeader> TryFindSubSection(StreamReader& reader, const SectionHeader& parentSection, SectionSignature subSectionSignature);
 		static void ScanPOFSectionsForPtrSize(StreamReader& reader);
+
+		// NOTE: Write a top level section header followed by the data of writeDataFunc, its POF relocation table and the closing EOFC sub section.
+		//		 Pointers are absolute file addresses in 32-bit mode and relative to the start of the section data in 64-bit mode
+		static void WriteSection(StreamWriter& writer, SectionSignature signature, const std::function<void(StreamWriter&)>& writeDataFunc);
+		static void WriteEndOfFileSection(StreamWriter& writer);
+	};
+
+	// NOTE: Flat array of all section headers of a file in file order, built by walking the section tree once.
+	//		 Sub sections are identified by their header being located within the sub section range of a parent section,
+	//		 so that lookups don't depend on the depth values written by each exporter
+	struct SectionIndex
+	{
+		struct Entry
+		{
+			SectionHeader Header;
+			// NOTE: Index of the enclosing section or -1 for top level sections
+			i32 ParentIndex;
+		};
+
+		std::vector<Entry> Entries;
+
+		const SectionHeader* FindFirst(SectionSignature signature) const;
+		const SectionHeader* FindSubSection(const SectionHeader& parentSection, SectionSignature subSectionSignature) const;
+
+		static SectionIndex Build(StreamReader& reader);
+		static const SectionIndex& GetOrBuild(StreamReader& reader);
+
+	private:
+		static inline u64 SubSectionKey(i32 parentIndex, SectionSignature signature) { return (static_cast<u64>(static_cast<u32>(parentIndex)) << 32) | static_cast<u32>(signature); }
+
+		std::unordered_map<SectionSignature, size_t> firstSectionLookup;
+		std::unordered_map<u64, size_t> firstSubSectionLookup;
+		std::unordered_map<FileAddr, size_t> headerAddressLookup;
+	};
+
+	// NOTE: Decode a packed POF0 / POF1 relocation table (excluding the leading u32 table size) and call perOffsetFunc(size_t)
+	//		 with the offset of every pointer sized field, relative to the start of the parent section data, in ascending order
+	template <typename Func>
+	void ForEachPOFRelocationOffset(const u8* tableData, size_t tableSize, PtrSize ptrSize, Func perOffsetFunc)
+	{
+		const size_t offsetShift = (ptrSize == PtrSize::Mode64Bit) ? 3 : 2;
+		const u8* tableEnd = tableData + tableSize;
+
+		size_t offset = 0;
+		for (const u8* it = tableData; it < tableEnd;)
+		{
+			size_t value = (*it & 0x3F);
+			switch (*it++ & 0xC0)
+			{
+			case 0x40:
+				break;
+			case 0x80:
+				if ((tableEnd - it) < 1) return;
+				value = (value << 8) | it[0];
+				it += 1;
+				break;
+			case 0xC0:
+				if ((tableEnd - it) < 3) return;
+				value = (value << 24) | (static_cast<size_t>(it[0]) << 16) | (static_cast<size_t>(it[1]) << 8) | it[2];
+				it += 3;
+				break;
+			default:
+				// NOTE: Zero terminated and padded to the next alignment boundary
+				return;
+			}
+
+			offset += (value << offsetShift);
+			perOffsetFunc(offset);
+		}
+	}
+
+	// NOTE: Byte swap every multi byte field of a section data buffer in place as described by its ENRS table (including the leading 16 byte table header).
+	//		 Returns false if the table is malformed or describes fields outside of the data buffer, in which case the buffer may have been partially swapped
+	b8 ApplyENRSByteSwapTable(u8* sectionData, size_t sectionDataSize, const u8* tableData, size_t tableSize);
+
+	// NOTE: Redirects the reader to an in-memory copy of its stream for the lifetime of this object, in which all big endian sections starting at the base header
+	//		 that come with an ENRS table have been byte swapped in a single pass up front. Their headers are marked as little endian accordingly, so that all parsing
+	//		 (including that of nested sections) can take the little endian path. Big endian sections without an ENRS table are left untouched
+	struct SectionByteSwapScope : NonCopyable
+	{
+		SectionByteSwapScope(StreamReader& reader, std::optional<SectionHeader>& baseHeader);
+		~SectionByteSwapScope();
+
+	private:
+		StreamReader& reader;
+		IStream* originalStream = nullptr;
+		std::vector<u8> swappedData;
+		MemoryStream swappedStream;
 	};
 }
@@ -4,8 +4,9 @@ namespace Comfy
 {
 	StreamResult AetDB::Read(StreamReader& reader)
 	{
-		const auto baseHeader = SectionHeader::TryRead(reader, SectionSignature::AEDB);
+		auto baseHeader = SectionHeader::TryRead(reader, SectionSignature::AEDB);
 		SectionHeader::ScanPOFSectionsForPtrSize(reader);
+		SectionByteSwapScope byteSwapScope { reader, baseHeader };
 
 		if (baseHeader.has_value())
 		{
@@ -86,58 +87,72 @@ namespace Comfy
 
 	StreamResult AetDB::Write(StreamWriter& writer)
 	{
-		writer.WriteU32(static_cast<u32>(Entries.size()));
-		writer.WriteFuncPtr([&](StreamWriter& writer)
+		const auto writeDBData = [this](StreamWriter& writer)
 		{
-			u32 setIndex = 0;
-			for (const auto& setEntry : Entries)
+			writer.WriteU32(static_cast<u32>(Entries.size()));
+			writer.WriteFuncPtr([&](StreamWriter& writer)
 			{
-				writer.WriteU32(static_cast<u32>(setEntry.ID));
-				writer.WriteStrPtr(setEntry.Name);
-				writer.WriteStrPtr(setEntry.FileName);
-				writer.WriteU32(setIndex++);
-				writer.WriteU32(static_cast<u32>(setEntry.SprSetID));
-			}
-		});
-
-		size_t sceneCount = 0;
-		for (const auto& setEntry : Entries)
-			sceneCount += setEntry.SceneEntries.size();
-
-		writer.WriteU32(static_cast<u32>(sceneCount));
-		writer.WriteFuncPtr([&](StreamWriter& writer)
-		{
-			u16 setIndex = 0;
+				u32 setIndex = 0;
+				for (const auto& setEntry : Entries)
+				{
+					writer.WriteU32(static_cast<u32>(setEntry.ID));
+					writer.WriteStrPtr(setEntry.Name);
+					writer.WriteStrPtr(setEntry.FileName);
+					writer.WriteU32(setIndex++);
+					writer.WriteU32(static_cast<u32>(setEntry.SprSetID));
+				}
+			});
+
+			size_t sceneCount = 0;
 			for (const auto& setEntry : Entries)
+				sceneCount += setEntry.SceneEntries.size();
+
+			writer.WriteU32(static_cast<u32>(sceneCount));
+			writer.WriteFuncPtr([&](StreamWriter& writer)
 			{
-				u16 sceneIndex = 0;
-				for (const auto& sceneEntry : setEntry.SceneEntries)
+				u16 setIndex = 0;
+				for (const auto& setEntry : Entries)
 				{
-					writer.WriteU32(static_cast<u32>(sceneEntry.ID));
-					writer.WriteStrPtr(sceneEntry.Name);
-					writer.WriteU32(static_cast<u32>(setIndex << 16) | static_cast<u32>(sceneEntry.Index));
-					sceneIndex++;
+					u16 sceneIndex = 0;
+					for (const auto& sceneEntry : setEntry.SceneEntries)
+					{
+						writer.WriteU32(static_cast<u32>(sceneEntry.ID));
+						writer.WriteStrPtr(sceneEntry.Name);
+						writer.WriteU32(static_cast<u32>(setIndex << 16) | static_cast<u32>(sceneEntry.Index));
+						sceneIndex++;
+					}
+					setIndex++;
 				}
-				setIndex++;
-			}
-		});
+			});
 
-		writer.WritePadding(16);
-		writer.WriteAlignmentPadding(16);
+			writer.WritePadding(16);
+			writer.WriteAlignmentPadding(16);
+
+			writer.FlushPointerPool();
+			writer.WriteAlignmentPadding(16);
 
-		writer.FlushPointerPool();
-		writer.WriteAlignmentPadding(16);
+			writer.FlushStringPointerPool();
+			writer.WriteAlignmentPadding(16);
+		};
 
-		writer.FlushStringPointerPool();
-		writer.WriteAlignmentPadding(16);
+		if (writer.HasSections)
+		{
+			SectionHeader::WriteSection(writer, SectionSignature::AEDB, writeDBData);
+			SectionHeader::WriteEndOfFileSection(writer);
+		}
+		else
+		{
+			writeDBData(writer);
+		}
 
 		return StreamResult::Success;
 	}
 
 	StreamResult SprDB::Read(StreamReader& reader)
 	{
-		const auto baseHeader = SectionHeader::TryRead(reader, SectionSignature::SPDB);
+		auto baseHeader = SectionHeader::TryRead(reader, SectionSignature::SPDB);
 		SectionHeader::ScanPOFSectionsForPtrSize(reader);
+		SectionByteSwapScope byteSwapScope { reader, baseHeader };
 
 		if (baseHeader.has_value())
 		{
@@ -222,63 +237,76 @@ namespace Comfy
 
 	StreamResult SprDB::Write(StreamWriter& writer)
 	{
-		const auto startPosition = writer.GetPosition();
+		const auto writeDBData = [this](StreamWriter& writer)
+		{
+			const auto startPosition = writer.GetPosition();
 
-		writer.WriteU32(GetSprSetEntryCount());
-		writer.WritePtr(FileAddr::NullPtr);
-		writer.WriteU32(GetSprEntryCount());
-		writer.WritePtr(FileAddr::NullPtr);
+			writer.WriteU32(GetSprSetEntryCount());
+			writer.WritePtr(FileAddr::NullPtr);
+			writer.WriteU32(GetSprEntryCount());
+			writer.WritePtr(FileAddr::NullPtr);
 
-		writer.Seek(startPosition + FileAddr(0xC));
-		writer.WriteFuncPtr([this](StreamWriter& writer)
-		{
-			i16 sprSetIndex = 0;
-			for (auto& sprSetEntry : Entries)
+			writer.Seek(startPosition + FileAddr(0xC));
+			writer.WriteFuncPtr([this](StreamWriter& writer)
 			{
-				for (auto& sprTexEntry : sprSetEntry.SprTexEntries)
+				i16 sprSetIndex = 0;
+				for (auto& sprSetEntry : Entries)
 				{
-					writer.WriteU32(static_cast<u32>(sprTexEntry.ID));
-					writer.WriteStrPtr(sprTexEntry.Name);
-					writer.WriteU32(static_cast<u32>(sprTexEntry.Index) | ((static_cast<u32>(sprSetIndex) | 0x1000) << 16));
+					for (auto& sprTexEntry : sprSetEntry.SprTexEntries)
+					{
+						writer.WriteU32(static_cast<u32>(sprTexEntry.ID));
+						writer.WriteStrPtr(sprTexEntry.Name);
+						writer.WriteU32(static_cast<u32>(sprTexEntry.Index) | ((static_cast<u32>(sprSetIndex) | 0x1000) << 16));
+					}
+
+					i16 sprIndex = 0;
+					for (auto& sprEntry : sprSetEntry.SprEntries)
+					{
+						writer.WriteU32(static_cast<u32>(sprEntry.ID));
+						writer.WriteStrPtr(sprEntry.Name);
+						writer.WriteU32(static_cast<u32>(sprEntry.Index) | static_cast<u32>(sprSetIndex << 16));
+					}
+
+					sprSetIndex++;
 				}
+				writer.WriteAlignmentPadding(16);
+				writer.WritePadding(16);
+			});
 
-				i16 sprIndex = 0;
-				for (auto& sprEntry : sprSetEntry.SprEntries)
+			writer.Seek(startPosition + FileAddr(0x4));
+			writer.WriteFuncPtr([this](StreamWriter& writer)
+			{
+				i32 index = 0;
+				for (auto& sprSetEntry : Entries)
 				{
-					writer.WriteU32(static_cast<u32>(sprEntry.ID));
-					writer.WriteStrPtr(sprEntry.Name);
-					writer.WriteU32(static_cast<u32>(sprEntry.Index) | static_cast<u32>(sprSetIndex << 16));
+					writer.WriteU32(static_cast<u32>(sprSetEntry.ID));
+					writer.WriteStrPtr(sprSetEntry.Name);
+					writer.WriteStrPtr(sprSetEntry.FileName);
+					writer.WriteI32(index++);
 				}
+				writer.WriteAlignmentPadding(16);
+				writer.WritePadding(16);
+			});
 
-				sprSetIndex++;
-			}
-			writer.WriteAlignmentPadding(16);
+			writer.Seek(startPosition + FileAddr(0x10));
 			writer.WritePadding(16);
-		});
 
-		writer.Seek(startPosition + FileAddr(0x4));
-		writer.WriteFuncPtr([this](StreamWriter& writer)
-		{
-			i32 index = 0;
-			for (auto& sprSetEntry : Entries)
-			{
-				writer.WriteU32(static_cast<u32>(sprSetEntry.ID));
-				writer.WriteStrPtr(sprSetEntry.Name);
-				writer.WriteStrPtr(sprSetEntry.FileName);
-				writer.WriteI32(index++);
-			}
+			writer.FlushPointerPool();
 			writer.WriteAlignmentPadding(16);
-			writer.WritePadding(16);
-		});
 
-		writer.Seek(startPosition + FileAddr(0x10));
-		writer.WritePadding(16);
-
-		writer.FlushPointerPool();
-		writer.WriteAlignmentPadding(16);
+			writer.FlushStringPointerPool();
+			writer.WriteAlignmentPadding(16);
+		};
 
-		writer.FlushStringPointerPool();
-		writer.WriteAlignmentPadding(16);
+		if (writer.HasSections)
+		{
+			SectionHeader::WriteSection(writer, SectionSignature::SPDB, writeDBData);
+			SectionHeader::WriteEndOfFileSection(writer);
+		}
+		else
+		{
+			writeDBData(writer);
+		}
 
 		return StreamResult::Success;
 	}
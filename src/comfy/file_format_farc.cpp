@@ -1,4 +1,6 @@
 #include "file_format_farc.h"
+#include "file_format_db.h"
+#include <unordered_map>
 #include <zlib.h>
 
 #include <Windows.h>
@@ -472,9 +474,9 @@ namespace Comfy
 		return compressedSize;
 	}
 
-	void FArcPacker::AddFile(std::string fileName, IStreamWritable& writable)
+	void FArcPacker::AddFile(std::string fileName, IStreamWritable& writable, StreamFormat format)
 	{
-		WritableEntries.push_back(StreamWritableEntry { std::move(fileName), writable });
+		WritableEntries.push_back(StreamWritableEntry { std::move(fileName), writable, format });
 	}
 
 	void FArcPacker::AddFile(std::string fileName, const void* fileContent, size_t fileSize)
@@ -483,6 +485,47 @@ namespace Comfy
 			DataPointerEntries.push_back(DataPointerEntry { std::move(fileName), fileContent, fileSize });
 	}
 
+	struct FArcPackerFlushEntry
+	{
+		std::string_view FileName;
+		// NOTE: Either a writable serialized on demand or a data pointer which stays valid until the end of the flush
+		IStreamWritable* Writable;
+		StreamFormat Format;
+		const void* Data;
+		size_t DataSize;
+		u32 ContentHash;
+		FileAddr DataOffsetOnceWritten;
+		size_t CompressedFileSizeOnceWritten;
+	};
+
+	static std::unique_ptr<u8[]> WriteFlushEntryIntoBuffer(FArcPackerFlushEntry& entry)
+	{
+		std::unique_ptr<u8[]> fileDataBuffer;
+		MemoryWriteStream fileWriteMemoryStream { fileDataBuffer };
+		StreamWriter fileWriter { fileWriteMemoryStream };
+		fileWriter.SetStreamFormat(entry.Format);
+
+		entry.Writable->Write(fileWriter);
+		entry.Data = fileDataBuffer.get();
+		entry.DataSize = static_cast<size_t>(fileWriteMemoryStream.GetLength());
+		return fileDataBuffer;
+	}
+
+	static b8 IsFlushEntryContentEqual(FArcPackerFlushEntry& writtenEntry, const void* data, size_t dataSize)
+	{
+		if (writtenEntry.DataSize != dataSize)
+			return false;
+
+		// NOTE: The buffers of written writables are released right after so on a hash match the writable has to be serialized a second time
+		if (writtenEntry.Writable == nullptr)
+			return (std::memcmp(writtenEntry.Data, data, dataSize) == 0);
+
+		const auto writtenDataBuffer = WriteFlushEntryIntoBuffer(writtenEntry);
+		const b8 isEqual = (writtenEntry.DataSize == dataSize && std::memcmp(writtenDataBuffer.get(), data, dataSize) == 0);
+		writtenEntry.Data = nullptr;
+		return isEqual;
+	}
+
 	b8 FArcPacker::CreateFlushFArc(std::string_view filePath, b8 compressed, u32 alignment)
 	{
 		defer { WritableEntries.clear(); DataPointerEntries.clear(); };
@@ -493,67 +536,90 @@ namespace Comfy
 		if (!outputFileStream.IsOpen())
 			return false;
 
+		std::vector<FArcPackerFlushEntry> flushEntries;
+		flushEntries.reserve(WritableEntries.size() + DataPointerEntries.size());
+
+		for (auto& entry : WritableEntries)
+			flushEntries.push_back(FArcPackerFlushEntry { entry.FileName, &entry.Writable, entry.Format });
+
+		for (auto& entry : DataPointerEntries)
+			flushEntries.push_back(FArcPackerFlushEntry { entry.FileName, nullptr, StreamFormat::Classic, entry.Data, entry.DataSize });
+
 		StreamWriter farcWriter { outputFileStream };
 		farcWriter.SetEndianness(Endianness::Big);
 		farcWriter.SetPtrSize(PtrSize::Mode32Bit);
 
 		farcWriter.WriteU32(static_cast<u32>(compressed ? FArcSignature::Compressed : FArcSignature::UnCompressed));
 		u32 delayedHeaderSize = 0;
-		farcWriter.WriteDelayedPtr([&delayedHeaderSize](StreamWriter& writer) {writer.WriteU32(delayedHeaderSize); });
+		farcWriter.WriteDelayedValue([&delayedHeaderSize](StreamWriter& writer) {writer.WriteU32(delayedHeaderSize); });
 		farcWriter.WriteU32(alignment);
 
-		for (auto& entry : WritableEntries)
+		// NOTE: The header size only depends on the file names so all offsets and sizes can be patched in once the data of every entry has been written
+		for (auto& entry : flushEntries)
 		{
 			farcWriter.WriteStr(entry.FileName);
-			farcWriter.WriteFuncPtr([&](StreamWriter& writer)
-			{
-				std::unique_ptr<u8[]> fileDataBuffer;
-				MemoryWriteStream fileWriteMemoryStream { fileDataBuffer };
-				StreamWriter fileWriter { fileWriteMemoryStream };
-
-				entry.Writable.Write(fileWriter);
-				entry.FileSizeOnceWritten = static_cast<size_t>(fileWriteMemoryStream.GetLength());
-				entry.CompressedFileSizeOnceWritten = entry.FileSizeOnceWritten;
-
-				if (compressed)
-					entry.CompressedFileSizeOnceWritten = CompressBufferIntoStream(fileDataBuffer.get(), entry.FileSizeOnceWritten, writer);
-				else
-					farcWriter.WriteBuffer(fileDataBuffer.get(), entry.FileSizeOnceWritten);
-
-				farcWriter.WriteAlignmentPadding(alignment);
-			});
+			farcWriter.WriteDelayedPtr([&entry](StreamWriter& writer) { writer.WritePtr(entry.DataOffsetOnceWritten); });
 
 			if (compressed)
-				farcWriter.WriteDelayedPtr([&](StreamWriter& writer) { writer.WriteSize(entry.CompressedFileSizeOnceWritten); });
+				farcWriter.WriteDelayedValue([&entry](StreamWriter& writer) { writer.WriteSize(entry.CompressedFileSizeOnceWritten); });
 
-			farcWriter.WriteDelayedPtr([&](StreamWriter& writer) { writer.WriteSize(entry.FileSizeOnceWritten); });
+			farcWriter.WriteDelayedValue([&entry](StreamWriter& writer) { writer.WriteSize(entry.DataSize); });
 		}
 
-		for (auto& entry : DataPointerEntries)
+		delayedHeaderSize = static_cast<u32>(farcWriter.GetPosition()) - (sizeof(u32) * 2);
+		farcWriter.WriteAlignmentPadding(alignment);
+
+		// NOTE: Key = MurmurHash of the entry content, values are only considered duplicates after a full size and memcmp check to rule out hash collisions
+		std::unordered_multimap<u32, FArcPackerFlushEntry*> writtenEntriesByContentHash;
+		writtenEntriesByContentHash.reserve(flushEntries.size());
+
+		// NOTE: Write the data of each entry straight to the file one after another, so that at most a single serialized writable is held in memory at a time
+		for (auto& entry : flushEntries)
 		{
-			farcWriter.WriteStr(entry.FileName);
-			farcWriter.WriteFuncPtr([&](StreamWriter& writer)
+			std::unique_ptr<u8[]> fileDataBuffer;
+			if (entry.Writable != nullptr)
+				fileDataBuffer = WriteFlushEntryIntoBuffer(entry);
+
+			if (Settings.DeduplicateIdenticalEntries)
 			{
-				if (compressed)
-					entry.CompressedFileSizeOnceWritten = CompressBufferIntoStream(entry.Data, entry.DataSize, writer);
-				else
-					farcWriter.WriteBuffer(entry.Data, entry.DataSize);
+				entry.ContentHash = MurmurHashU32(std::string_view(static_cast<cstr>(entry.Data), entry.DataSize));
+
+				const FArcPackerFlushEntry* duplicateOf = nullptr;
+				const auto[hashMatchBegin, hashMatchEnd] = writtenEntriesByContentHash.equal_range(entry.ContentHash);
+				for (auto it = hashMatchBegin; it != hashMatchEnd && duplicateOf == nullptr; it++)
+				{
+					if (IsFlushEntryContentEqual(*it->second, entry.Data, entry.DataSize))
+						duplicateOf = it->second;
+				}
 
-				farcWriter.WriteAlignmentPadding(alignment);
-			});
+				if (duplicateOf != nullptr)
+				{
+					entry.DataOffsetOnceWritten = duplicateOf->DataOffsetOnceWritten;
+					entry.CompressedFileSizeOnceWritten = duplicateOf->CompressedFileSizeOnceWritten;
+					entry.Data = nullptr;
+					continue;
+				}
+
+				writtenEntriesByContentHash.emplace(entry.ContentHash, &entry);
+			}
+
+			entry.DataOffsetOnceWritten = farcWriter.GetPosition();
+			entry.CompressedFileSizeOnceWritten = entry.DataSize;
 
 			if (compressed)
-				farcWriter.WriteDelayedPtr([&](StreamWriter& writer) { writer.WriteSize(entry.CompressedFileSizeOnceWritten); });
+				entry.CompressedFileSizeOnceWritten = CompressBufferIntoStream(entry.Data, entry.DataSize, farcWriter);
+			else
+				farcWriter.WriteBuffer(entry.Data, entry.DataSize);
 
-			farcWriter.WriteSize(entry.DataSize);
-		}
+			farcWriter.WriteAlignmentPadding(alignment);
 
-		delayedHeaderSize = static_cast<u32>(farcWriter.GetPosition()) - (sizeof(u32) * 2);
-		farcWriter.WriteAlignmentPadding(alignment);
+			if (entry.Writable != nullptr)
+				entry.Data = nullptr;
+		}
 
-		farcWriter.FlushPointerPool();
 		farcWriter.FlushDelayedWritePool();
 		farcWriter.WriteAlignmentPadding(alignment);
+
 		return true;
 	}
 }
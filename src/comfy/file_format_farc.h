@@ -81,12 +81,18 @@ namespace Comfy
 	struct FArcPacker
 	{
 		// NOTE: All input file references are expected to stay valid at least until CreateFlushFArc() has been called
-		void AddFile(std::string fileName, IStreamWritable& writable);
+		void AddFile(std::string fileName, IStreamWritable& writable, StreamFormat format = StreamFormat::Classic);
 		void AddFile(std::string fileName, const void* fileContent, size_t fileSize);
 		b8 CreateFlushFArc(std::string_view filePath, b8 compressed, u32 alignment = 16);
 
-		struct StreamWritableEntry { std::string FileName; IStreamWritable& Writable; size_t FileSizeOnceWritten, CompressedFileSizeOnceWritten; };
-		struct DataPointerEntry { std::string FileName; const void* Data; size_t DataSize, CompressedFileSizeOnceWritten; };
+		struct SettingsData
+		{
+			// NOTE: Hash the content of each entry and store byte-identical entries only once, with all of their headers pointing to the same data
+			b8 DeduplicateIdenticalEntries = true;
+		} Settings;
+
+		struct StreamWritableEntry { std::string FileName; IStreamWritable& Writable; StreamFormat Format; };
+		struct DataPointerEntry { std::string FileName; const void* Data; size_t DataSize; };
 		std::vector<StreamWritableEntry> WritableEntries;
 		std::vector<DataPointerEntry> DataPointerEntries;
 	};
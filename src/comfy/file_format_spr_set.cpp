@@ -75,6 +75,7 @@ namespace Comfy
 			baseHeader = SectionHeader::TryRead(reader, SectionSignature::TXPC);
 
 		SectionHeader::ScanPOFSectionsForPtrSize(reader);
+		SectionByteSwapScope byteSwapScope { reader, baseHeader };
 
 		if (baseHeader.has_value())
 		{
@@ -124,7 +125,7 @@ namespace Comfy
 		const u32 textureCount = static_cast<u32>(Textures.size());
 		constexpr u32 packedMask = 0x01010100;
 
-		const FileAddr setBaseAddress = writer.GetPosition();
+		const FileAddr setBaseAddress = writer.GetPositionOffsetAware();
 		writer.WriteU32(static_cast<u32>(TxpSig::TexSet));
 		writer.WriteU32(textureCount);
 		writer.WriteU32(textureCount | packedMask);
@@ -133,7 +134,7 @@ namespace Comfy
 		{
 			writer.WriteFuncPtr([&](StreamWriter& writer)
 			{
-				const FileAddr texBaseAddress = writer.GetPosition();
+				const FileAddr texBaseAddress = writer.GetPositionOffsetAware();
 				const u8 arraySize = static_cast<u8>(texture->MipMapsArray.size());
 				const u8 mipLevels = (arraySize > 0) ? static_cast<u8>(texture->MipMapsArray.front().size()) : 0;
 
@@ -196,8 +197,9 @@ namespace Comfy
 
 	StreamResult SprSet::Read(StreamReader& reader)
 	{
-		const auto baseHeader = SectionHeader::TryRead(reader, SectionSignature::SPRC);
+		auto baseHeader = SectionHeader::TryRead(reader, SectionSignature::SPRC);
 		SectionHeader::ScanPOFSectionsForPtrSize(reader);
+		SectionByteSwapScope byteSwapScope { reader, baseHeader };
 
 		if (baseHeader.has_value())
 		{
@@ -293,61 +295,76 @@ namespace Comfy
 
 	StreamResult SprSet::Write(StreamWriter& writer)
 	{
-		writer.WriteU32(Flags);
+		FileAddr texSetPtrAddress = FileAddr::NullPtr;
+		const auto writeSprSetData = [this, &texSetPtrAddress](StreamWriter& writer)
+		{
+			writer.WriteU32(Flags);
 
-		const auto texSetPtrAddress = writer.GetPosition();
-		writer.WriteU32(0x00000000);
-		writer.WriteU32(static_cast<u32>(TexSet.Textures.size()));
+			texSetPtrAddress = writer.GetPosition();
+			writer.WriteU32(0x00000000);
+			writer.WriteU32(static_cast<u32>(TexSet.Textures.size()));
 
-		writer.WriteU32(static_cast<u32>(Sprites.size()));
-		writer.WriteFuncPtr([&](StreamWriter& writer)
-		{
-			for (const auto& sprite : Sprites)
+			writer.WriteU32(static_cast<u32>(Sprites.size()));
+			writer.WriteFuncPtr([&](StreamWriter& writer)
 			{
-				writer.WriteI32(sprite.TextureIndex);
-				writer.WriteI32(sprite.Rotate);
-				writer.WriteF32(sprite.TexelRegion.x);
-				writer.WriteF32(sprite.TexelRegion.y);
-				writer.WriteF32(sprite.TexelRegion.z);
-				writer.WriteF32(sprite.TexelRegion.w);
-				writer.WriteF32(sprite.PixelRegion.x);
-				writer.WriteF32(sprite.PixelRegion.y);
-				writer.WriteF32(sprite.PixelRegion.z);
-				writer.WriteF32(sprite.PixelRegion.w);
-			}
-		});
+				for (const auto& sprite : Sprites)
+				{
+					writer.WriteI32(sprite.TextureIndex);
+					writer.WriteI32(sprite.Rotate);
+					writer.WriteF32(sprite.TexelRegion.x);
+					writer.WriteF32(sprite.TexelRegion.y);
+					writer.WriteF32(sprite.TexelRegion.z);
+					writer.WriteF32(sprite.TexelRegion.w);
+					writer.WriteF32(sprite.PixelRegion.x);
+					writer.WriteF32(sprite.PixelRegion.y);
+					writer.WriteF32(sprite.PixelRegion.z);
+					writer.WriteF32(sprite.PixelRegion.w);
+				}
+			});
 
-		writer.WriteFuncPtr([&](StreamWriter& writer)
-		{
-			for (const auto& texture : this->TexSet.Textures)
+			writer.WriteFuncPtr([&](StreamWriter& writer)
 			{
-				if (texture->Name.has_value())
-					writer.WriteStrPtr(texture->Name.value());
-				else
-					writer.WritePtr(FileAddr::NullPtr);
-			}
-		});
+				for (const auto& texture : this->TexSet.Textures)
+				{
+					if (texture->Name.has_value())
+						writer.WriteStrPtr(texture->Name.value());
+					else
+						writer.WritePtr(FileAddr::NullPtr);
+				}
+			});
 
-		writer.WriteFuncPtr([&](StreamWriter& writer)
-		{
-			for (const auto& sprite : Sprites)
-				writer.WriteStrPtr(sprite.Name);
-		});
+			writer.WriteFuncPtr([&](StreamWriter& writer)
+			{
+				for (const auto& sprite : Sprites)
+					writer.WriteStrPtr(sprite.Name);
+			});
 
-		writer.WriteFuncPtr([&](StreamWriter& writer)
-		{
-			for (const auto& sprite : Sprites)
+			writer.WriteFuncPtr([&](StreamWriter& writer)
 			{
-				writer.WriteU32(sprite.Extra.Flags);
-				writer.WriteU32(static_cast<u32>(sprite.Extra.ScreenMode));
-			}
-		});
+				for (const auto& sprite : Sprites)
+				{
+					writer.WriteU32(sprite.Extra.Flags);
+					writer.WriteU32(static_cast<u32>(sprite.Extra.ScreenMode));
+				}
+			});
 
-		writer.FlushPointerPool();
-		writer.WriteAlignmentPadding(16);
+			writer.FlushPointerPool();
+			writer.WriteAlignmentPadding(16);
 
-		writer.FlushStringPointerPool();
-		writer.WriteAlignmentPadding(16);
+			writer.FlushStringPointerPool();
+			writer.WriteAlignmentPadding(16);
+		};
+
+		if (writer.HasSections)
+		{
+			// NOTE: Instead of being pointed to the TexSet follows as its own section, the same way SprSet::Read expects it
+			SectionHeader::WriteSection(writer, SectionSignature::SPRC, writeSprSetData);
+			SectionHeader::WriteSection(writer, SectionSignature::TXPC, [this](StreamWriter& writer) { TexSet.Write(writer); });
+			SectionHeader::WriteEndOfFileSection(writer);
+			return StreamResult::Success;
+		}
+
+		writeSprSetData(writer);
 
 		const auto texSetPtr = writer.GetPosition();
 		TexSet.Write(writer);
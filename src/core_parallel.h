@@ -0,0 +1,35 @@
+#pragma once
+#include "core_types.h"
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+// NOTE: Calls indexFunc(index) once for every index in [0, itemCount), handing the items out one at a time to a fixed number of workers
+//		 through a shared atomic index so that items of very different cost still balance out. The calling thread is always one of the workers.
+//		 Besides the hardware concurrency and the item count the worker count is limited to one per minWorkPerThread units of totalWork
+//		 (such as the item count itself or the sum of all sample counts), so workloads below minWorkPerThread run on the calling thread alone
+template <typename IndexFunc>
+void ParallelFor(size_t itemCount, size_t totalWork, size_t minWorkPerThread, IndexFunc indexFunc)
+{
+	const size_t workThreadLimit = (minWorkPerThread > 0) ? (totalWork / minWorkPerThread) : itemCount;
+	const size_t threadCount = Clamp<size_t>(Min<size_t>(std::thread::hardware_concurrency(), workThreadLimit), 1, Max<size_t>(itemCount, 1));
+
+	std::atomic<size_t> nextIndex = 0;
+	const auto processRemainingItems = [&]()
+	{
+		for (size_t index = nextIndex++; index < itemCount; index = nextIndex++)
+			indexFunc(index);
+	};
+
+	std::vector<std::future<void>> futures;
+	futures.reserve(threadCount - 1);
+
+	for (size_t i = 1; i < threadCount; i++)
+		futures.push_back(std::async(std::launch::async, processRemainingItems));
+
+	processRemainingItems();
+
+	for (auto& future : futures)
+		future.wait();
+}
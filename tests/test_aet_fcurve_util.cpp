@@ -0,0 +1,154 @@
+#include "test_common.h"
+#include "comfy/aet_fcurve_util.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Comfy::Test
+{
+	using namespace Aet;
+
+	static f32 GetMaxKeyFrameError(const FCurve& reduced, const FCurve& original)
+	{
+		f32 maxError = 0.0f;
+		for (size_t i = 0; i < original->size(); i++)
+		{
+			const frame_t frame = original.Keys[i].Frame;
+			maxError = Max(maxError, std::abs(reduced.SampleAt(frame) - original.SampleAt(frame)));
+
+			if (i + 1 < original->size())
+			{
+				const frame_t midFrame = (frame + original.Keys[i + 1].Frame) * 0.5f;
+				maxError = Max(maxError, std::abs(reduced.SampleAt(midFrame) - original.SampleAt(midFrame)));
+			}
+		}
+		return maxError;
+	}
+
+	COMFY_TEST(ReduceFCurveKeyFramesStaysWithinTolerance)
+	{
+		constexpr f32 tolerance = 0.05f;
+
+		FCurve original;
+		for (i32 i = 0; i <= 60; i++)
+		{
+			const frame_t frame = static_cast<frame_t>(i);
+			original.Keys.push_back(KeyFrame(frame, 100.0f * std::sin(frame * 0.1f), 10.0f * std::cos(frame * 0.1f)));
+		}
+
+		FCurve reduced = original;
+		const size_t removedCount = ReduceFCurveKeyFrames(reduced, tolerance);
+
+		COMFY_CHECK(removedCount > 0);
+		COMFY_CHECK(reduced->size() + removedCount == original->size());
+		COMFY_CHECK(reduced.Keys.front().Frame == original.Keys.front().Frame && reduced.Keys.back().Frame == original.Keys.back().Frame);
+		COMFY_CHECK(GetMaxKeyFrameError(reduced, original) <= tolerance);
+	}
+
+	COMFY_TEST(ReduceFCurveKeyFramesKeepsHoldSteps)
+	{
+		constexpr f32 tolerance = 0.01f;
+
+		// NOTE: A linear ramp up to frame 10 where the value jumps and then continues as another linear ramp
+		FCurve original;
+		for (i32 i = 0; i <= 10; i++)
+			original.Keys.push_back(KeyFrame(static_cast<frame_t>(i), i * 1.0f, 1.0f));
+		for (i32 i = 10; i <= 20; i++)
+			original.Keys.push_back(KeyFrame(static_cast<frame_t>(i), 50.0f - i * 1.0f, -1.0f));
+
+		FCurve reduced = original;
+		ReduceFCurveKeyFrames(reduced, tolerance);
+
+		const auto holdStart = std::find_if(reduced.Keys.begin(), reduced.Keys.end(), [](const KeyFrame& key) { return key.Frame == 10.0f; });
+		COMFY_CHECK(holdStart != reduced.Keys.end() && (holdStart + 1) != reduced.Keys.end());
+		if (holdStart == reduced.Keys.end() || (holdStart + 1) == reduced.Keys.end())
+			return;
+
+		COMFY_CHECK(holdStart->Value == 10.0f);
+		COMFY_CHECK((holdStart + 1)->Frame == 10.0f && (holdStart + 1)->Value == 40.0f);
+		COMFY_CHECK(reduced->size() == 4);
+		COMFY_CHECK(GetMaxKeyFrameError(reduced, original) <= tolerance);
+	}
+
+	COMFY_TEST(ReduceFCurveKeyFramesLinearRamp)
+	{
+		FCurve original;
+		for (i32 i = 0; i <= 30; i++)
+			original.Keys.push_back(KeyFrame(static_cast<frame_t>(i), 5.0f + i * 2.0f, 2.0f));
+
+		FCurve reduced = original;
+		COMFY_CHECK(ReduceFCurveKeyFrames(reduced, 0.001f) == original->size() - 2);
+		COMFY_CHECK(reduced->size() == 2);
+		if (reduced->size() != 2)
+			return;
+
+		COMFY_CHECK(reduced.Keys[0].Frame == 0.0f && reduced.Keys[0].Value == 5.0f);
+		COMFY_CHECK(reduced.Keys[1].Frame == 30.0f && reduced.Keys[1].Value == 65.0f);
+		COMFY_CHECK(GetMaxKeyFrameError(reduced, original) <= 0.001f);
+	}
+
+	static f32 GetMaxSampleError(const FCurve& fcurve, const std::vector<f32>& samples, frame_t startFrame, frame_t step)
+	{
+		f32 maxError = 0.0f;
+		for (size_t i = 0; i < samples.size(); i++)
+			maxError = Max(maxError, std::abs(fcurve.SampleAt(startFrame + (static_cast<frame_t>(i) * step)) - samples[i]));
+		return maxError;
+	}
+
+	COMFY_TEST(FitFCurveToSineSamples)
+	{
+		constexpr f32 maxError = 0.01f;
+
+		std::vector<f32> samples;
+		for (i32 i = 0; i < 600; i++)
+			samples.push_back(100.0f * std::sin(i * 0.02f));
+
+		const FCurve fitted = FitFCurveToSamples(samples.data(), samples.size(), 10.0f, 1.0f, maxError);
+		COMFY_CHECK(fitted->size() >= 2 && fitted->size() < samples.size() / 4);
+		COMFY_CHECK(GetMaxSampleError(fitted, samples, 10.0f, 1.0f) <= maxError);
+	}
+
+	COMFY_TEST(FitFCurveToExpressionSamples)
+	{
+		constexpr f32 maxError = 0.05f;
+
+		// NOTE: Similar to a decaying bounce expression sampled at half frames, including its sharp corners at each bounce
+		std::vector<f32> samples;
+		for (i32 i = 0; i < 400; i++)
+			samples.push_back(200.0f * std::abs(std::sin(i * 0.015f)) * std::exp(i * -0.002f));
+
+		const FCurve fitted = FitFCurveToSamples(samples.data(), samples.size(), 0.0f, 0.5f, maxError);
+		COMFY_CHECK(fitted->size() >= 2 && fitted->size() < samples.size());
+		COMFY_CHECK(GetMaxSampleError(fitted, samples, 0.0f, 0.5f) <= maxError);
+	}
+
+	COMFY_TEST(FitFCurvesToSamplesMatchesSingleFits)
+	{
+		std::vector<FCurveFitJob> jobs;
+		for (i32 jobIndex = 0; jobIndex < 16; jobIndex++)
+		{
+			auto& job = jobs.emplace_back();
+			for (i32 i = 0; i < 200 + jobIndex * 50; i++)
+				job.Samples.push_back((jobIndex * 10.0f) * std::sin(i * (0.01f + jobIndex * 0.002f)) + (i * 0.1f));
+			job.StartFrame = static_cast<frame_t>(jobIndex);
+			job.Step = 1.0f;
+			job.MaxError = 0.01f;
+		}
+
+		std::vector<FCurve> batchFCurves(jobs.size());
+		for (size_t i = 0; i < jobs.size(); i++)
+			jobs[i].OutFCurve = &batchFCurves[i];
+		FitFCurvesToSamples(jobs);
+
+		const auto keysMatch = [](const std::vector<KeyFrame>& keys, const std::vector<KeyFrame>& expectedKeys)
+		{
+			return std::equal(keys.begin(), keys.end(), expectedKeys.begin(), expectedKeys.end(), [](const KeyFrame& a, const KeyFrame& b) { return (a.Frame == b.Frame && a.Value == b.Value && a.Tangent == b.Tangent); });
+		};
+
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			const auto& job = jobs[i];
+			const FCurve singleFCurve = FitFCurveToSamples(job.Samples.data(), job.Samples.size(), job.StartFrame, job.Step, job.MaxError);
+			COMFY_CHECK(keysMatch(batchFCurves[i].Keys, singleFCurve.Keys));
+		}
+	}
+}
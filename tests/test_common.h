@@ -0,0 +1,31 @@
+#pragma once
+#include "core_types.h"
+#include <vector>
+
+namespace Comfy::Test
+{
+	using TestFunc = void(*)();
+
+	struct TestCase
+	{
+		cstr Name;
+		TestFunc Func;
+	};
+
+	std::vector<TestCase>& GetRegisteredTests();
+	void ReportFailure(cstr file, int line, cstr expression);
+
+	struct TestRegistration
+	{
+		TestRegistration(cstr name, TestFunc func) { GetRegisteredTests().push_back(TestCase { name, func }); }
+	};
+}
+
+// NOTE: Registers a test function run by test_main.cpp, all tests of a translation unit are run in order of definition
+#define COMFY_TEST(testName) \
+	static void testName(); \
+	static const ::Comfy::Test::TestRegistration testName##Registration { #testName, testName }; \
+	static void testName()
+
+// NOTE: Reports a failure but keeps running the rest of the test so that all mismatches are listed at once
+#define COMFY_CHECK(expression) do { if (!(expression)) ::Comfy::Test::ReportFailure(__FILE__, __LINE__, #expression); } while (false)
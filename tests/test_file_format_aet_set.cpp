@@ -0,0 +1,399 @@
+#include "test_common.h"
+#include "comfy/file_format_aet_set.h"
+#include "comfy/file_format_aet_set_view.h"
+#include "comfy/file_format_db.h"
+#include <algorithm>
+
+namespace Comfy::Test
+{
+	using namespace Aet;
+
+	static std::shared_ptr<Layer> CreateTestLayer(std::string name, frame_t startFrame, frame_t endFrame)
+	{
+		auto layer = std::make_shared<Layer>();
+		layer->Name = std::move(name);
+		layer->StartFrame = startFrame;
+		layer->EndFrame = endFrame;
+		layer->StartOffset = 0.0f;
+		layer->TimeScale = 1.0f;
+		layer->Flags = {};
+		layer->Flags.VideoActive = true;
+		layer->Quality = LayerQuality::Best;
+		return layer;
+	}
+
+	static std::shared_ptr<Scene> CreateTestScene(std::string name)
+	{
+		auto scene = std::make_shared<Scene>();
+		scene->Name = std::move(name);
+		scene->StartFrame = 0.0f;
+		scene->EndFrame = 120.0f;
+		scene->FrameRate = 60.0f;
+		scene->BackgroundColor = 0x00112233;
+		scene->Resolution = ivec2(1280, 720);
+		scene->Camera = std::make_shared<Camera>();
+		scene->Camera->Eye.X.Keys = { KeyFrame(0.0f, 1.0f, 0.0f), KeyFrame(5.0f, 2.0f, 0.0f) };
+		scene->Audios.push_back(std::make_shared<Audio>(Audio { 7 }));
+
+		auto video = std::make_shared<Video>();
+		video->Color = 0x00FFFFFF;
+		video->Size = ivec2(64, 32);
+		video->FilesPerFrame = 1.0f;
+		video->Sources.push_back({ "SPR_TEST_A", SprID(5) });
+		video->Sources.push_back({ "SPR_TEST_B", SprID(9) });
+		scene->Videos.push_back(video);
+
+		auto comp = std::make_shared<Composition>();
+		scene->Compositions.push_back(comp);
+		scene->RootComposition = std::make_shared<Composition>();
+
+		for (i32 i = 0; i < 3; i++)
+		{
+			auto layer = CreateTestLayer("layer_" + std::to_string(i), static_cast<frame_t>(i), 100.0f);
+			layer->ItemType = ItemType::Video;
+			layer->SetItem(video);
+			layer->LayerVideo = std::make_shared<LayerVideo>();
+			layer->LayerVideo->TransferMode.BlendMode = BlendMode::Normal;
+			for (u32 field = 0; field < Transform2DField_Count; field++)
+				layer->LayerVideo->Transform[field].Keys = { KeyFrame(0.0f, field * 1.0f, 0.0f), KeyFrame(10.0f, field * 2.0f + i, 0.5f), KeyFrame(20.0f, field * 3.0f, 0.0f) };
+
+			if (i == 1)
+			{
+				layer->Markers.push_back(std::make_shared<Marker>(Marker { 5.0f, "ST_SP" }));
+				layer->LayerVideo->Transform3D = std::make_shared<LayerVideo3D>();
+				layer->LayerVideo->Transform3D->PositionZ.Keys = { KeyFrame(0.0f, 4.0f, 0.0f), KeyFrame(9.0f, 1.0f, 0.25f) };
+			}
+
+			((i == 2) ? comp : scene->RootComposition)->Layers.push_back(layer);
+		}
+
+		auto compLayer = CreateTestLayer("comp_layer", 0.0f, 120.0f);
+		compLayer->ItemType = ItemType::Composition;
+		compLayer->SetItem(comp);
+		compLayer->LayerVideo = std::make_shared<LayerVideo>();
+		for (u32 field = 0; field < Transform2DField_Count; field++)
+			compLayer->LayerVideo->Transform[field].Keys = { KeyFrame(1.0f) };
+		scene->RootComposition->Layers.push_back(compLayer);
+
+		// NOTE: Parent layers are only ever looked up within the non root compositions
+		auto childLayer = CreateTestLayer("child_layer", 0.0f, 60.0f);
+		childLayer->ItemType = ItemType::Video;
+		childLayer->SetItem(video);
+		childLayer->SetRefParentLayer(comp->Layers[0]);
+		comp->Layers.push_back(childLayer);
+
+		return scene;
+	}
+
+	static std::shared_ptr<AetSet> CreateTestAetSet(size_t sceneCount = 1)
+	{
+		auto set = std::make_shared<AetSet>();
+		set->Name = "test";
+
+		for (size_t i = 0; i < sceneCount; i++)
+			set->AddScene(CreateTestScene((i == 0) ? "MAIN" : ("SUB_" + std::to_string(i))));
+		return set;
+	}
+
+	static std::vector<u8> WriteToBuffer(IStreamWritable& writable, StreamFormat format)
+	{
+		std::unique_ptr<u8[]> dataBuffer;
+		MemoryWriteStream writeStream { dataBuffer };
+		StreamWriter writer { writeStream };
+		writer.SetStreamFormat(format);
+		writable.Write(writer);
+		return std::vector<u8>(dataBuffer.get(), dataBuffer.get() + static_cast<size_t>(writeStream.GetLength()));
+	}
+
+	static StreamResult ReadFromBuffer(IStreamReadable& readable, std::vector<u8> data, StreamFormat* outFormat = nullptr)
+	{
+		MemoryStream readStream;
+		readStream.FromStreamSource(data);
+		StreamReader reader { readStream };
+
+		const StreamResult result = readable.Read(reader);
+		if (outFormat != nullptr)
+			*outFormat = reader.GetStreamFormat();
+		return result;
+	}
+
+	static void CheckAetSetContentSurvived(AetSet& set)
+	{
+		COMFY_CHECK(set.GetSceneCount() == 1);
+		if (set.GetSceneCount() != 1)
+			return;
+
+		const Scene& scene = set.GetScene(0);
+		COMFY_CHECK(scene.Name == "MAIN");
+		COMFY_CHECK(scene.Resolution == ivec2(1280, 720));
+		COMFY_CHECK(scene.Camera != nullptr && scene.Camera->Eye.X.Keys.size() == 2);
+		COMFY_CHECK(scene.Audios.size() == 1 && scene.Audios[0]->SoundID == 7);
+
+		COMFY_CHECK(scene.Videos.size() == 1);
+		if (scene.Videos.size() == 1)
+		{
+			const Video& video = *scene.Videos[0];
+			COMFY_CHECK(video.Size == ivec2(64, 32));
+			COMFY_CHECK(video.Sources.size() == 2);
+			COMFY_CHECK(video.Sources.size() == 2 && video.Sources[1].Name == "SPR_TEST_B" && video.Sources[1].ID == SprID(9));
+		}
+
+		COMFY_CHECK(scene.RootComposition != nullptr && scene.RootComposition->Layers.size() == 3);
+		if (scene.RootComposition == nullptr || scene.RootComposition->Layers.size() != 3)
+			return;
+
+		const Layer& markerLayer = *scene.RootComposition->Layers[1];
+		COMFY_CHECK(markerLayer.Name == "layer_1");
+		COMFY_CHECK(markerLayer.ItemType == ItemType::Video);
+		COMFY_CHECK(markerLayer.GetVideoItem() == scene.Videos[0].get());
+		COMFY_CHECK(markerLayer.Markers.size() == 1 && markerLayer.Markers[0]->Frame == 5.0f && markerLayer.Markers[0]->Name == "ST_SP");
+		COMFY_CHECK(markerLayer.LayerVideo != nullptr && markerLayer.LayerVideo->Transform.Position.Y.Keys.size() == 3);
+		COMFY_CHECK(markerLayer.LayerVideo != nullptr && markerLayer.LayerVideo->Transform3D != nullptr && markerLayer.LayerVideo->Transform3D->PositionZ.Keys.size() == 2);
+
+		const Layer& compLayer = *scene.RootComposition->Layers[2];
+		COMFY_CHECK(compLayer.ItemType == ItemType::Composition);
+		COMFY_CHECK(compLayer.GetCompItem() != nullptr && compLayer.GetCompItem()->Layers.size() == 2);
+		if (compLayer.GetCompItem() == nullptr || compLayer.GetCompItem()->Layers.size() != 2)
+			return;
+
+		const Composition& comp = *compLayer.GetCompItem();
+		const Layer& childLayer = *comp.Layers[1];
+		COMFY_CHECK(childLayer.GetRefParentLayer() == comp.Layers[0].get());
+	}
+
+	static void CheckAetSetSectionRoundTrip(StreamFormat format)
+	{
+		auto set = CreateTestAetSet();
+		const auto writtenData = WriteToBuffer(*set, format);
+
+		AetSet readSet;
+		StreamFormat readFormat = StreamFormat::Classic;
+		COMFY_CHECK(ReadFromBuffer(readSet, writtenData, &readFormat) == StreamResult::Success);
+		COMFY_CHECK(readFormat == format);
+		CheckAetSetContentSurvived(readSet);
+
+		// NOTE: Writing the read set again has to reproduce the exact same file, including its POF relocation table
+		COMFY_CHECK(WriteToBuffer(readSet, format) == writtenData);
+	}
+
+	COMFY_TEST(AetSetSection32BitRoundTrip)
+	{
+		CheckAetSetSectionRoundTrip(StreamFormat::Section32Bit);
+	}
+
+	COMFY_TEST(AetSetSection64BitRoundTrip)
+	{
+		CheckAetSetSectionRoundTrip(StreamFormat::Section64Bit);
+	}
+
+	COMFY_TEST(AetSetStreamFormatSelectsSections)
+	{
+		auto set = CreateTestAetSet();
+		const auto classicData = WriteToBuffer(*set, StreamFormat::Classic);
+		const auto sectionData = WriteToBuffer(*set, StreamFormat::Section64Bit);
+
+		const auto readSignature = [](const std::vector<u8>& data) { u32 signature = 0; if (data.size() >= sizeof(signature)) memcpy(&signature, data.data(), sizeof(signature)); return signature; };
+		COMFY_CHECK(readSignature(classicData) != static_cast<u32>(SectionSignature::AETC));
+		COMFY_CHECK(readSignature(sectionData) == static_cast<u32>(SectionSignature::AETC));
+
+		AetSet classicSet;
+		StreamFormat readFormat = StreamFormat::Section64Bit;
+		COMFY_CHECK(ReadFromBuffer(classicSet, classicData, &readFormat) == StreamResult::Success);
+		COMFY_CHECK(readFormat == StreamFormat::Classic);
+		CheckAetSetContentSurvived(classicSet);
+	}
+
+	COMFY_TEST(AetSetLazySceneRead)
+	{
+		auto set = CreateTestAetSet();
+		const auto writtenData = WriteToBuffer(*set, StreamFormat::Section64Bit);
+
+		AetSet readSet;
+		readSet.Settings.LazySceneRead = true;
+		{
+			// NOTE: The owning stream shares its data with the set, so the scenes still have to be readable after it has been closed
+			MemoryStream readStream;
+			readStream.FromBuffer(writtenData.size(), [&](void* buffer, size_t size) { memcpy(buffer, writtenData.data(), size); });
+			StreamReader reader { readStream };
+			COMFY_CHECK(readSet.Read(reader) == StreamResult::Success);
+		}
+
+		COMFY_CHECK(readSet.GetSceneCount() == 1);
+		COMFY_CHECK(!readSet.IsSceneLoaded(0));
+		CheckAetSetContentSurvived(readSet);
+		COMFY_CHECK(readSet.IsSceneLoaded(0));
+		COMFY_CHECK(WriteToBuffer(readSet, StreamFormat::Section64Bit) == writtenData);
+	}
+
+	static std::vector<u8> ReadAndWriteAgain(const std::vector<u8>& data, StreamFormat format, b8 parallelSceneRead)
+	{
+		AetSet readSet;
+		readSet.Settings.ParallelSceneRead = parallelSceneRead;
+		COMFY_CHECK(ReadFromBuffer(readSet, data) == StreamResult::Success);
+		return WriteToBuffer(readSet, format);
+	}
+
+	COMFY_TEST(AetSetParallelSceneReadMatchesSerial)
+	{
+		auto set = CreateTestAetSet(4);
+
+		for (const auto format : { StreamFormat::Classic, StreamFormat::Section32Bit, StreamFormat::Section64Bit })
+		{
+			const auto writtenData = WriteToBuffer(*set, format);
+			const auto serialData = ReadAndWriteAgain(writtenData, format, false);
+			const auto parallelData = ReadAndWriteAgain(writtenData, format, true);
+
+			COMFY_CHECK(!serialData.empty() && serialData == writtenData);
+			COMFY_CHECK(parallelData == serialData);
+		}
+	}
+
+	COMFY_TEST(AetSetLazySceneReadLoadAllScenes)
+	{
+		auto set = CreateTestAetSet(4);
+		const auto writtenData = WriteToBuffer(*set, StreamFormat::Section32Bit);
+		const auto serialData = ReadAndWriteAgain(writtenData, StreamFormat::Section32Bit, false);
+
+		AetSet readSet;
+		readSet.Settings.LazySceneRead = true;
+		COMFY_CHECK(ReadFromBuffer(readSet, writtenData) == StreamResult::Success);
+		COMFY_CHECK(readSet.GetSceneCount() == 4);
+		for (size_t i = 0; i < readSet.GetSceneCount(); i++)
+			COMFY_CHECK(!readSet.IsSceneLoaded(i));
+
+		readSet.LoadAllScenes();
+		for (size_t i = 0; i < readSet.GetSceneCount(); i++)
+			COMFY_CHECK(readSet.IsSceneLoaded(i));
+
+		COMFY_CHECK(WriteToBuffer(readSet, StreamFormat::Section32Bit) == serialData);
+	}
+
+	COMFY_TEST(AetSetPrecomputedLayoutWriteMatchesStreamWrite)
+	{
+		auto set = CreateTestAetSet(4);
+
+		for (const auto format : { StreamFormat::Classic, StreamFormat::Section32Bit, StreamFormat::Section64Bit })
+		{
+			set->Settings.PrecomputedLayoutWrite = false;
+			const auto streamData = WriteToBuffer(*set, format);
+			set->Settings.PrecomputedLayoutWrite = true;
+			const auto layoutData = WriteToBuffer(*set, format);
+
+			COMFY_CHECK(!streamData.empty());
+			COMFY_CHECK(layoutData == streamData);
+		}
+	}
+
+	COMFY_TEST(AetSetParallelSceneWriteMatchesSerial)
+	{
+		auto set = CreateTestAetSet(4);
+		set->Settings.PrecomputedLayoutWrite = true;
+
+		for (const auto format : { StreamFormat::Classic, StreamFormat::Section32Bit, StreamFormat::Section64Bit })
+		{
+			set->Settings.ParallelSceneWrite = false;
+			const auto serialData = WriteToBuffer(*set, format);
+			set->Settings.ParallelSceneWrite = true;
+			const auto parallelData = WriteToBuffer(*set, format);
+
+			COMFY_CHECK(!serialData.empty());
+			COMFY_CHECK(parallelData == serialData);
+		}
+	}
+
+	static void CheckFCurveWritePoolRoundTrip(b8 precomputedLayoutWrite)
+	{
+		const std::vector<KeyFrame> sharedKeys = { KeyFrame(0.0f, 10.0f, 0.0f), KeyFrame(15.0f, 20.0f, 0.25f), KeyFrame(30.0f, 10.0f, 0.0f) };
+		const std::vector<KeyFrame> uniqueKeys = { KeyFrame(0.0f, 10.0f, 0.0f), KeyFrame(15.0f, 21.0f, 0.25f), KeyFrame(30.0f, 10.0f, 0.0f) };
+
+		auto set = CreateTestAetSet();
+		set->Settings.DeduplicateFCurves = true;
+		set->Settings.PrecomputedLayoutWrite = precomputedLayoutWrite;
+
+		// NOTE: The first two layers share the exact same position curve while the third one only differs by a single value
+		const auto& rootLayers = set->GetScene(0).RootComposition->Layers;
+		rootLayers[0]->LayerVideo->Transform.Position.X.Keys = sharedKeys;
+		rootLayers[1]->LayerVideo->Transform.Position.X.Keys = sharedKeys;
+		rootLayers[2]->LayerVideo->Transform.Position.X.Keys = uniqueKeys;
+
+		const auto writtenData = WriteToBuffer(*set, StreamFormat::Section32Bit);
+
+		AetSetView view;
+		COMFY_CHECK(ReadFromBuffer(view, writtenData) == StreamResult::Success);
+		COMFY_CHECK(view.GetSceneCount() == 1);
+		if (view.GetSceneCount() != 1)
+			return;
+
+		const CompositionView rootView = view.GetScene(0).GetRootComposition();
+		COMFY_CHECK(rootView.GetLayerCount() == 3);
+		if (rootView.GetLayerCount() != 3)
+			return;
+
+		const auto getPositionXKeyData = [&](size_t layerIndex) { return rootView.GetLayer(layerIndex).GetLayerVideo().GetTransform(Transform2DField_PositionX).InternalGetKeyData(sharedKeys.size()); };
+		COMFY_CHECK(getPositionXKeyData(0) != nullptr && getPositionXKeyData(2) != nullptr);
+		COMFY_CHECK(getPositionXKeyData(0) == getPositionXKeyData(1));
+		COMFY_CHECK(getPositionXKeyData(0) != getPositionXKeyData(2));
+
+		AetSet readSet;
+		COMFY_CHECK(ReadFromBuffer(readSet, writtenData) == StreamResult::Success);
+		COMFY_CHECK(readSet.GetSceneCount() == 1);
+		if (readSet.GetSceneCount() != 1)
+			return;
+
+		const auto& readLayers = readSet.GetScene(0).RootComposition->Layers;
+		COMFY_CHECK(readLayers.size() == 3);
+		if (readLayers.size() != 3)
+			return;
+
+		const auto keysMatch = [](const std::vector<KeyFrame>& keys, const std::vector<KeyFrame>& expectedKeys)
+		{
+			return std::equal(keys.begin(), keys.end(), expectedKeys.begin(), expectedKeys.end(), [](const KeyFrame& a, const KeyFrame& b) { return (a.Frame == b.Frame && a.Value == b.Value && a.Tangent == b.Tangent); });
+		};
+
+		COMFY_CHECK(keysMatch(readLayers[0]->LayerVideo->Transform.Position.X.Keys, sharedKeys));
+		COMFY_CHECK(keysMatch(readLayers[1]->LayerVideo->Transform.Position.X.Keys, sharedKeys));
+		COMFY_CHECK(keysMatch(readLayers[2]->LayerVideo->Transform.Position.X.Keys, uniqueKeys));
+
+		// NOTE: Including all other curves, some of which are deduplicated as well
+		for (size_t i = 0; i < readLayers.size(); i++)
+		{
+			for (u32 field = 0; field < Transform2DField_Count; field++)
+				COMFY_CHECK(keysMatch(readLayers[i]->LayerVideo->Transform[field].Keys, rootLayers[i]->LayerVideo->Transform[field].Keys));
+		}
+	}
+
+	COMFY_TEST(FCurveWritePoolRoundTrip)
+	{
+		CheckFCurveWritePoolRoundTrip(false);
+	}
+
+	COMFY_TEST(FCurveWritePoolPrecomputedLayoutRoundTrip)
+	{
+		CheckFCurveWritePoolRoundTrip(true);
+	}
+
+	COMFY_TEST(AetDBSectionRoundTrip)
+	{
+		AetDB db;
+		auto& setEntry = db.Entries.emplace_back();
+		setEntry.ID = AetSetID(1);
+		setEntry.Name = "AET_TEST";
+		setEntry.FileName = "aet_test.bin";
+		setEntry.SprSetID = SprSetID(2);
+		setEntry.SceneEntries.push_back(AetSceneEntry { AetSceneID(3), "AET_TEST_MAIN", 0 });
+
+		const auto writtenData = WriteToBuffer(db, StreamFormat::Section32Bit);
+
+		AetDB readDB;
+		StreamFormat readFormat = StreamFormat::Classic;
+		COMFY_CHECK(ReadFromBuffer(readDB, writtenData, &readFormat) == StreamResult::Success);
+		COMFY_CHECK(readFormat == StreamFormat::Section32Bit);
+		COMFY_CHECK(readDB.Entries.size() == 1);
+		if (readDB.Entries.size() == 1)
+		{
+			COMFY_CHECK(readDB.Entries[0].Name == "AET_TEST" && readDB.Entries[0].FileName == "aet_test.bin");
+			COMFY_CHECK(readDB.Entries[0].SprSetID == SprSetID(2));
+			COMFY_CHECK(readDB.Entries[0].SceneEntries.size() == 1 && readDB.Entries[0].SceneEntries[0].Name == "AET_TEST_MAIN");
+		}
+	}
+}
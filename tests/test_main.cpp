@@ -0,0 +1,38 @@
+#include "test_common.h"
+#include <stdio.h>
+
+namespace Comfy::Test
+{
+	static u32 CurrentTestFailureCount = 0;
+
+	std::vector<TestCase>& GetRegisteredTests()
+	{
+		static std::vector<TestCase> registeredTests;
+		return registeredTests;
+	}
+
+	void ReportFailure(cstr file, int line, cstr expression)
+	{
+		fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+		CurrentTestFailureCount++;
+	}
+}
+
+int main(int argc, const char* argv[])
+{
+	using namespace Comfy::Test;
+
+	u32 failedTestCount = 0;
+	for (const TestCase& test : GetRegisteredTests())
+	{
+		CurrentTestFailureCount = 0;
+		test.Func();
+
+		printf("[%s] %s\n", (CurrentTestFailureCount == 0) ? "PASS" : "FAIL", test.Name);
+		if (CurrentTestFailureCount != 0)
+			failedTestCount++;
+	}
+
+	printf("%zu tests, %u failed\n", GetRegisteredTests().size(), failedTestCount);
+	return (failedTestCount == 0) ? 0 : 1;
+}